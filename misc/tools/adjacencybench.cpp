@@ -0,0 +1,112 @@
+// times primCalcNormal on an n x n grid of quads and of tris against the
+// atomic scatter it replaced, with and without the adjacency cached on the prim,
+// and checks that faces flipped in place are seen; build against a zeno build with
+//   g++ -std=c++17 -O2 -fopenmp misc/tools/adjacencybench.cpp -Izeno/include -Lbuild/bin -lzeno -o adjacencybench
+// optional argument: n (default 1000)
+#include <zeno/zeno.h>
+#include <zeno/funcs/PrimitiveUtils.h>
+#include <zeno/funcs/PrimitiveAdjacency.h>
+#include <zeno/types/PrimitiveObject.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+using namespace zeno;
+
+// the scatter primCalcNormal did before the adjacency, CAS loops on every component
+static void scatterNormals(PrimitiveObject *prim) {
+    auto &nrm = prim->add_attr<vec3f>("nrm_old");
+    auto &pos = prim->verts.values;
+    std::fill(nrm.begin(), nrm.end(), vec3f(0));
+    auto atomicFloatAdd = [] (float *dst, float val) {
+        int oldVal, newVal;
+        std::memcpy(&oldVal, dst, sizeof(int));
+        do {
+            float f;
+            std::memcpy(&f, &oldVal, sizeof(int));
+            f += val;
+            std::memcpy(&newVal, &f, sizeof(int));
+        } while (!__atomic_compare_exchange_n((int *)dst, &oldVal, newVal, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+    };
+#pragma omp parallel for
+    for (int i = 0; i < (int)prim->tris.size(); i++) {
+        auto ind = prim->tris[i];
+        auto n = cross(pos[ind[1]] - pos[ind[0]], pos[ind[2]] - pos[ind[0]]);
+        for (int j = 0; j < 3; j++)
+            for (int d = 0; d < 3; d++)
+                atomicFloatAdd(&nrm[ind[j]][d], n[d]);
+    }
+#pragma omp parallel for
+    for (int i = 0; i < (int)prim->quads.size(); i++) {
+        auto ind = prim->quads[i];
+        for (int j = 0; j < 4; j++) {
+            auto p0 = pos[ind[j]], p1 = pos[ind[(j + 1) % 4]], p2 = pos[ind[(j + 2) % 4]];
+            auto n = cross(p1 - p0, p2 - p0);
+            for (int d = 0; d < 3; d++)
+                atomicFloatAdd(&nrm[ind[j]][d], n[d]);
+        }
+    }
+#pragma omp parallel for
+    for (int i = 0; i < (int)nrm.size(); i++)
+        nrm[i] = normalizeSafe(nrm[i]);
+}
+
+static std::shared_ptr<PrimitiveObject> makeGrid(int n, bool tris) {
+    auto prim = std::make_shared<PrimitiveObject>();
+    prim->verts.resize((size_t)(n + 1) * (n + 1));
+    for (int y = 0; y <= n; y++)
+        for (int x = 0; x <= n; x++)
+            prim->verts[y * (n + 1) + x] = vec3f(x, y, 0.1f * std::sin(0.05f * x) * std::cos(0.07f * y));
+    for (int y = 0; y < n; y++) {
+        for (int x = 0; x < n; x++) {
+            int a = y * (n + 1) + x, b = a + 1, c = a + n + 2, d = a + n + 1;
+            if (tris) {
+                prim->tris.push_back(vec3i(a, b, c));
+                prim->tris.push_back(vec3i(a, c, d));
+            } else {
+                prim->quads.push_back(vec4i(a, b, c, d));
+            }
+        }
+    }
+    return prim;
+}
+
+template <class F>
+static double timeMs(F &&f) {
+    auto t0 = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+int main(int argc, char **argv) {
+    int n = argc > 1 ? atoi(argv[1]) : 1000;
+    for (int tris = 0; tris < 2; tris++) {
+        auto prim = makeGrid(n, tris);
+        double tOld = timeMs([&] { scatterNormals(prim.get()); });
+        double tFirst = timeMs([&] { primCalcNormal(prim.get()); });
+        double tCached = timeMs([&] { primCalcNormal(prim.get()); });
+        double tHash = timeMs([&] { primTopologyHash(prim.get()); });
+        double tEdges = timeMs([&] { primAdjacency(prim.get(), true); });
+
+        float maxDiff = 0;
+        auto const &nOld = prim->attr<vec3f>("nrm_old");
+        auto const &nNew = prim->attr<vec3f>("nrm");
+        for (size_t i = 0; i < nNew.size(); i++)
+            maxDiff = std::max(maxDiff, length(nNew[i] - nOld[i]));
+
+        // reverse the winding in place, the arrays keep their storage and size
+        if (tris) {
+            for (auto &t: prim->tris) std::swap(t[1], t[2]);
+        } else {
+            for (auto &q: prim->quads) std::swap(q[1], q[3]);
+        }
+        primCalcNormal(prim.get());
+        bool flipped = dot(prim->attr<vec3f>("nrm")[n / 2], nOld[n / 2]) < 0;
+
+        printf("%s: %zu verts, scatter %.1f ms, gather %.1f ms first / %.1f ms cached "
+               "(hash %.1f ms), edges %.1f ms, max diff %g, flip seen: %s\n",
+               tris ? "tris " : "quads", prim->verts.size(), tOld, tFirst, tCached, tHash, tEdges,
+               maxDiff, flipped ? "yes" : "NO");
+    }
+}
@@ -0,0 +1,80 @@
+// times (a*2+b)*c-1 over float vertex attributes as four separate passes, the
+// way chained PrimitiveAttrOp nodes run it, against one fused AttrExprObject
+// eval and an a+b+c stream as the memory bandwidth bound; build against a zeno
+// build with
+//   g++ -std=c++17 -O2 -fopenmp misc/tools/attrexprbench.cpp -Izeno/include -Lbuild/bin -lzeno -o attrexprbench
+// optional argument: vertex count (default 50000000)
+#include <zeno/types/AttrExprObject.h>
+#include <zeno/types/PrimitiveObject.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+using namespace zeno;
+
+template <class F>
+static double timeMs(F &&f) {
+    auto t0 = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+static void report(char const *name, double ms, double bytes) {
+    printf("%-24s %8.1f ms %8.2f GB/s\n", name, ms, bytes / ms * 1e-6);
+}
+
+int main(int argc, char **argv) {
+    std::size_t n = argc > 1 ? atoll(argv[1]) : 50000000;
+    auto prim = std::make_shared<PrimitiveObject>();
+    prim->verts.resize(n);
+    auto &a = prim->add_attr<float>("a");
+    auto &b = prim->add_attr<float>("b");
+    auto &c = prim->add_attr<float>("c");
+#pragma omp parallel for
+    for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)n; i++) {
+        a[i] = (i % 1000) * 0.001f;
+        b[i] = (i % 777) * 0.01f;
+        c[i] = 1 + (i % 333) * 0.002f;
+    }
+    double bytes = 4.0 * sizeof(float) * n;  // three reads and a write for the fused forms
+
+    // four passes through a temporary, each reading and writing whole arrays
+    auto &tmp = prim->add_attr<float>("tmp");
+    auto &sep = prim->add_attr<float>("sep");
+    auto pass = [&] (auto const &f) {
+#pragma omp parallel for
+        for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)n; i++)
+            f(i);
+    };
+    double tSep = timeMs([&] {
+        pass([&] (std::ptrdiff_t i) { tmp[i] = a[i] * 2; });
+        pass([&] (std::ptrdiff_t i) { tmp[i] = tmp[i] + b[i]; });
+        pass([&] (std::ptrdiff_t i) { tmp[i] = tmp[i] * c[i]; });
+        pass([&] (std::ptrdiff_t i) { sep[i] = tmp[i] - 1; });
+    });
+
+    using E = AttrExprObject;
+    auto expr = E::binary(E::Sub,
+                          *E::binary(E::Mul,
+                                     *E::binary(E::Add,
+                                                *E::binary(E::Mul, *E::attr(prim, "a"), *E::constant(vec3f(2), 1)),
+                                                *E::attr(prim, "b")),
+                                     *E::attr(prim, "c")),
+                          *E::constant(vec3f(1), 1));
+    expr->eval(prim.get(), "fused");  // adds the attribute, so the timed run only evaluates
+    double tFused = timeMs([&] { expr->eval(prim.get(), "fused"); });
+
+    auto &sum = prim->add_attr<float>("sum");
+    double tStream = timeMs([&] { pass([&] (std::ptrdiff_t i) { sum[i] = a[i] + b[i] + c[i]; }); });
+
+    auto const &fused = prim->attr<float>("fused");
+    std::size_t bad = 0;
+    for (std::size_t i = 0; i < n; i++)
+        bad += std::memcmp(&fused[i], &sep[i], sizeof(float)) != 0;
+
+    printf("%zu verts\n", n);
+    report("four separate passes", tSep, 10.0 * sizeof(float) * n);
+    report("fused eval", tFused, bytes);
+    report("a+b+c stream", tStream, bytes);
+    printf("fused differs from the separate passes on %zu of %zu\n", bad, n);
+}
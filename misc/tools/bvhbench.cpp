@@ -0,0 +1,151 @@
+// times BvhObject build, ray casts and closest point queries on a bumpy sphere
+// against brute force and the ZenoFX LBvh that QueryNearestPrimitive used, then
+// checks the traversal on the deepest tree the build makes; build against a zeno build with
+//   g++ -std=c++17 -O2 -fopenmp misc/tools/bvhbench.cpp projects/ZenoFX/LinearBvh.cpp -Iprojects/ZenoFX -Izeno/include -Lbuild/bin -lzeno -o bvhbench
+// optional arguments: sphere subdivisions (default 300, 360k tris), queries (default 200000)
+#include <zeno/types/BvhObject.h>
+#include "LinearBvh.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+using namespace zeno;
+
+template <class F>
+static double timeMs(F &&f) {
+    auto t0 = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+static std::shared_ptr<PrimitiveObject> bumpySphere(int n) {
+    auto prim = std::make_shared<PrimitiveObject>();
+    for (int i = 0; i <= n; i++) {
+        for (int j = 0; j < 2 * n; j++) {
+            float th = M_PI * i / n, ph = M_PI * j / n;
+            float r = 1 + 0.05f * std::sin(7 * th) * std::cos(9 * ph);
+            prim->verts.push_back(r * vec3f(std::sin(th) * std::cos(ph), std::sin(th) * std::sin(ph), std::cos(th)));
+        }
+    }
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < 2 * n; j++) {
+            int a = i * 2 * n + j, b = i * 2 * n + (j + 1) % (2 * n);
+            prim->tris.push_back(vec3i(a, a + 2 * n, b + 2 * n));
+            prim->tris.push_back(vec3i(a, b + 2 * n, b));
+        }
+    }
+    return prim;
+}
+
+static BvhObject::NearestHit bruteNearest(PrimitiveObject const *prim, vec3f const &p) {
+    BvhObject::NearestHit best;
+    for (int t = 0; t < (int)prim->tris.size(); t++) {
+        auto ind = prim->tris[t];
+        auto a = prim->verts[ind[0]], b = prim->verts[ind[1]], c = prim->verts[ind[2]];
+        // sample the triangle densely enough to bound the distance from above
+        for (int u = 0; u <= 8; u++) {
+            for (int v = 0; u + v <= 8; v++) {
+                auto q = a + (b - a) * (u / 8.f) + (c - a) * (v / 8.f);
+                float d = length(q - p);
+                if (d < best.dist) {
+                    best.dist = d;
+                    best.primId = t;
+                }
+            }
+        }
+    }
+    return best;
+}
+
+static BvhObject::RayHit bruteRay(PrimitiveObject const *prim, vec3f const &ro, vec3f const &rd) {
+    BvhObject::RayHit best;
+    for (int t = 0; t < (int)prim->tris.size(); t++) {
+        auto ind = prim->tris[t];
+        auto v0 = prim->verts[ind[0]], e1 = prim->verts[ind[1]] - v0, e2 = prim->verts[ind[2]] - v0;
+        auto p = cross(rd, e2);
+        float det = dot(e1, p);
+        if (det == 0) continue;
+        auto s = ro - v0, q = cross(s, e1);
+        float u = dot(s, p) / det, v = dot(rd, q) / det, tt = dot(e2, q) / det;
+        if (u >= 0 && v >= 0 && u + v <= 1 && tt >= 0 && tt < best.t) {
+            best.t = tt;
+            best.primId = t;
+        }
+    }
+    return best;
+}
+
+int main(int argc, char **argv) {
+    int n = argc > 1 ? atoi(argv[1]) : 300;
+    int nq = argc > 2 ? atoi(argv[2]) : 200000;
+    auto prim = bumpySphere(n);
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> uni(-1.5f, 1.5f);
+    std::vector<vec3f> ro(nq), rd(nq);
+    for (int i = 0; i < nq; i++) {
+        ro[i] = vec3f(uni(rng), uni(rng), uni(rng));
+        rd[i] = normalize(vec3f(uni(rng), uni(rng), uni(rng)));
+    }
+
+    BvhObject bvh;
+    std::vector<BvhObject::RayHit> rays(nq);
+    std::vector<BvhObject::NearestHit> near(nq);
+    double tBuild = timeMs([&] { bvh.build(prim.get()); });
+    double tRays = timeMs([&] { bvh.intersectBatch(ro.data(), rd.data(), rays.data(), nq); });
+    double tNear = timeMs([&] { near = std::vector<BvhObject::NearestHit>(nq); bvh.nearestBatch(ro.data(), near.data(), nq); });
+    printf("%zu tris, %d queries, depth %d\n", prim->tris.size(), nq, bvh.depth);
+    printf("BvhObject  build %8.1f ms, rays %8.1f ms, nearest %8.1f ms\n", tBuild, tRays, tNear);
+
+    // LBvh takes much longer per query, time a slice and scale it
+    int nl = std::min(nq, 20000);
+    LBvh lbvh;
+    std::vector<float> ldist(nl);
+    double tLBuild = timeMs([&] { lbvh = LBvh(prim, 0.f, LBvh::element_c<LBvh::element_e::tri>); });
+    double tLNear = timeMs([&] {
+#pragma omp parallel for
+        for (int i = 0; i < nl; i++) {
+            int id = -1;
+            ldist[i] = std::numeric_limits<float>::max();
+            lbvh.find_nearest(ro[i], id, ldist[i]);
+        }
+    });
+    printf("LBvh       build %8.1f ms,                    nearest %8.1f ms (scaled from %d)\n",
+           tLBuild, tLNear * nq / nl, nl);
+    int lbad = 0;
+    for (int i = 0; i < nl; i++)
+        lbad += std::abs(ldist[i] - near[i].dist) > 1e-4f;
+    printf("nearest distances differing from LBvh: %d of %d\n", lbad, nl);
+
+    int rbad = 0, nbad = 0;
+    for (int i = 0; i < nq; i += nq / 200) {
+        auto r = bruteRay(prim.get(), ro[i], rd[i]);
+        rbad += r.primId != rays[i].primId && std::abs(r.t - rays[i].t) > 1e-4f;
+        auto b = bruteNearest(prim.get(), ro[i]);
+        nbad += near[i].dist > b.dist + 1e-5f;
+    }
+    printf("brute force mismatches on 200 samples: rays %d, nearest %d\n", rbad, nbad);
+
+    // triangles at exponentially growing distances, the SAH bins then peel one
+    // off per level and the tree comes out deep and lopsided
+    auto chain = std::make_shared<PrimitiveObject>();
+    for (int i = 0; i < 200; i++) {
+        float x = std::pow(1.5f, (float)i);
+        int b = chain->verts.size();
+        chain->verts.push_back(vec3f(x, -1, 0));
+        chain->verts.push_back(vec3f(x + 1, -1, 0));
+        chain->verts.push_back(vec3f(x, 1, 0));
+        chain->tris.push_back(vec3i(b, b + 1, b + 2));
+    }
+    BvhObject deep;
+    deep.build(chain.get());
+    int dbad = 0;
+    for (int i = 0; i < 200; i++) {
+        vec3f o(std::pow(1.5f, (float)i) + 0.2f, 0, 1), d(0, 0, -1);
+        auto h = deep.intersect(o, d);
+        auto r = bruteRay(chain.get(), o, d);
+        dbad += h.primId != r.primId && std::abs(h.t - r.t) > 1e-4f;
+    }
+    printf("chain of %zu tris: depth %d (inline stack fits %d), ray mismatches %d of 200\n",
+           chain->tris.size(), deep.depth, (512 - 1) / 3, dbad);
+}
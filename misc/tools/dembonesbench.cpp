@@ -0,0 +1,85 @@
+// times the DemBones skinning decomposition on a synthetic sequence: a tube of
+// rings bent by a chain of rigid bones with smooth weights, compare thread counts with
+//   g++ -std=c++17 -O2 -fopenmp misc/tools/dembonesbench.cpp -Iprojects/DemBones/include -I/usr/include/eigen3 -o dembonesbench
+//   OMP_NUM_THREADS=1 ./dembonesbench && ./dembonesbench
+// optional arguments: rings, ring segments, frames, bones
+#include "DemBonesExt.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+using namespace Eigen;
+
+int main(int argc, char **argv) {
+    int nrings = argc > 1 ? atoi(argv[1]) : 200;
+    int nsegs = argc > 2 ? atoi(argv[2]) : 64;
+    int nframes = argc > 3 ? atoi(argv[3]) : 100;
+    int nbones = argc > 4 ? atoi(argv[4]) : 10;
+    double length = 10;
+
+    Dem::DemBonesExt<double, float> model;
+    model.nS = 1;
+    model.nV = nrings * nsegs;
+    model.nF = nframes;
+    model.nB = nbones;
+    model.nIters = 10;
+    model.fStart.resize(2);
+    model.fStart << 0, nframes;
+    model.subjectID = VectorXi::Zero(nframes);
+    model.fTime = VectorXd::LinSpaced(nframes, 0, 1);
+
+    model.u.resize(3, model.nV);
+    for (int r = 0; r < nrings; r++) {
+        for (int s = 0; s < nsegs; s++) {
+            double a = 2 * M_PI * s / nsegs;
+            model.u.col(r * nsegs + s) << length * r / (nrings - 1), std::cos(a), std::sin(a);
+        }
+    }
+    for (int r = 0; r + 1 < nrings; r++) {
+        for (int s = 0; s < nsegs; s++) {
+            int a = r * nsegs + s, b = r * nsegs + (s + 1) % nsegs;
+            model.fv.push_back({a, b, b + nsegs});
+            model.fv.push_back({a, b + nsegs, a + nsegs});
+        }
+    }
+
+    // each joint bends about z by an angle that oscillates over the frames,
+    // vertices blend the two nearest joint frames linearly along the tube
+    model.v.resize(3 * nframes, model.nV);
+    double seg = length / nbones;
+    for (int k = 0; k < nframes; k++) {
+        std::vector<Affine3d> joint(nbones + 1);
+        joint[0].setIdentity();
+        for (int j = 1; j <= nbones; j++) {
+            double ang = 0.3 * std::sin(2 * M_PI * k / nframes + j);
+            joint[j] = joint[j - 1] * Translation3d(seg, 0, 0) * AngleAxisd(ang, Vector3d::UnitZ());
+        }
+        for (int i = 0; i < model.nV; i++) {
+            Vector3d p = model.u.col(i);
+            double t = std::min(p.x() / seg, nbones - 1e-9);
+            int j = (int)t;
+            double w = t - j;
+            Vector3d lp(p.x() - j * seg, p.y(), p.z());
+            Vector3d q = (1 - w) * (joint[j] * lp) + w * (joint[j + 1] * (lp - Vector3d(seg, 0, 0)));
+            model.v.col(i).segment<3>(3 * k) = q.cast<float>();
+        }
+    }
+
+#ifdef _OPENMP
+    Eigen::setNbThreads(omp_get_max_threads());
+#endif
+    printf("%d verts, %d frames, %d bones, %d threads\n", model.nV, nframes, nbones, Eigen::nbThreads());
+    auto t0 = std::chrono::steady_clock::now();
+    model.init();
+    auto t1 = std::chrono::steady_clock::now();
+    model.compute();
+    auto t2 = std::chrono::steady_clock::now();
+    printf("init    %.3f s\n", std::chrono::duration<double>(t1 - t0).count());
+    printf("compute %.3f s (%d iters, rmse %g)\n", std::chrono::duration<double>(t2 - t1).count(),
+           model.nIters, model.rmse());
+    return 0;
+}
@@ -0,0 +1,61 @@
+// times applyNodesToExec on a 5-level-deep chain of subnets (4 Route nodes per
+// level) before and after Graph::flattenSubnets, build against a zeno build with
+//   g++ -std=c++17 -O2 misc/tools/flattenbench.cpp -Izeno/include -Lbuild/bin -lzeno -o flattenbench
+#include <zeno/zeno.h>
+#include <zeno/core/Graph.h>
+#include <zeno/types/NumericObject.h>
+#include <chrono>
+#include <cstdio>
+#include <string>
+using namespace zeno;
+static std::string level(int d, int width) {
+    std::string s;
+    auto add = [&](std::string x) { s += x + ","; };
+    std::string id = "L" + std::to_string(d);
+    add("[\"addSubnetNode\",\"Sub\",\"" + id + "\"]");
+    add("[\"pushSubnetScope\",\"" + id + "\"]");
+    add("[\"addNode\",\"SubInput\",\"in\"]");
+    add("[\"setNodeParam\",\"in\",\"name\",\"in\"]");
+    add("[\"completeNode\",\"in\"]");
+    std::string prev = "in", prevs = "port";
+    for (int i = 0; i < width; i++) {
+        std::string r = "r" + std::to_string(i);
+        add("[\"addNode\",\"Route\",\"" + r + "\"]");
+        add("[\"bindNodeInput\",\"" + r + "\",\"input\",\"" + prev + "\",\"" + prevs + "\"]");
+        add("[\"completeNode\",\"" + r + "\"]");
+        prev = r; prevs = "output";
+    }
+    if (d < 5) {
+        s += level(d + 1, width);
+        std::string cid = "L" + std::to_string(d + 1);
+        add("[\"bindNodeInput\",\"" + cid + "\",\"in\",\"" + prev + "\",\"" + prevs + "\"]");
+        prev = cid; prevs = "out";
+    }
+    add("[\"addNode\",\"SubOutput\",\"out\"]");
+    add("[\"setNodeParam\",\"out\",\"name\",\"out\"]");
+    add("[\"bindNodeInput\",\"out\",\"port\",\"" + prev + "\",\"" + prevs + "\"]");
+    add("[\"completeNode\",\"out\"]");
+    add("[\"popSubnetScope\",\"" + id + "\"]");
+    add("[\"completeNode\",\"" + id + "\"]");
+    return s;
+}
+int main(int argc, char **argv) {
+    int width = 4, iters = 20000;
+    std::string j = "[[\"addNode\",\"NumericInt\",\"src\"],[\"setNodeParam\",\"src\",\"value\",42],[\"completeNode\",\"src\"],";
+    j += level(1, width);
+    j += "[\"bindNodeInput\",\"L1\",\"in\",\"src\",\"value\"],";
+    j += "[\"addNode\",\"Route\",\"sink\"],[\"bindNodeInput\",\"sink\",\"input\",\"L1\",\"out\"],[\"completeNode\",\"sink\"]]";
+    for (int flat = 0; flat < 2; flat++) {
+        auto g = getSession().createGraph();
+        g->loadGraph(j.c_str());
+        if (flat) g->flattenSubnets();
+        g->nodesToExec = {"sink"};
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < iters; i++) g->applyNodesToExec();
+        auto t1 = std::chrono::steady_clock::now();
+        auto v = std::get<int>(safe_dynamic_cast<NumericObject>(g->getNodeOutput("sink", "output"))->value);
+        printf("flat=%d nodes=%zu value=%d %.2f us/exec, L1/L2/r0 reported as %s\n", flat, g->nodes.size(), v,
+               std::chrono::duration<double, std::micro>(t1 - t0).count() / iters,
+               g->originalNodeId("L1/L2/r0").c_str());
+    }
+}
@@ -0,0 +1,81 @@
+// times the batch noise kernels of libzeno against the scalar PerlinNoise1::perlin
+// and PerlinNoise::perlin from the header, and checks that both give the same
+// bits on every point; the scalar path is compiled here, so build with the flags
+// perlin.cpp gets against a zeno build with
+//   g++ -std=c++17 -O2 -fopenmp -ffp-contract=off -fno-trapping-math misc/tools/perlinbench.cpp -Izeno/include -Lbuild/bin -lzeno -o perlinbench
+// optional argument: points (default 4000000)
+#include <zeno/utils/perlin.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+using namespace zeno;
+
+template <class F>
+static double timeMs(F &&f) {
+    auto t0 = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+static std::size_t countDiffs(std::vector<float> const &a, std::vector<float> const &b) {
+    std::size_t bad = 0;
+    for (std::size_t i = 0; i < a.size(); i++)
+        bad += std::memcmp(&a[i], &b[i], sizeof(float)) != 0;
+    return bad;
+}
+
+template <class Scalar, class Batch>
+static void compare(char const *name, std::vector<float> const &x, std::vector<float> const &y,
+                    std::vector<float> const &z, Scalar const &scalar, Batch const &batch) {
+    std::size_t n = x.size();
+    std::vector<float> ref(n), out(n);
+    double tScalar = timeMs([&] {
+#pragma omp parallel for
+        for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)n; i++)
+            ref[i] = scalar(vec3f(x[i], y[i], z[i]));
+    });
+    double tBatch = timeMs([&] {
+#pragma omp parallel for
+        for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)n; i += 16) {
+            int m = (int)std::min<std::ptrdiff_t>(16, n - i);
+            batch(m, &x[i], &y[i], &z[i], &out[i]);
+        }
+    });
+    printf("%-34s scalar %8.1f ms, batch %8.1f ms, %zu of %zu differ\n", name, tScalar, tBatch,
+           countDiffs(ref, out), n);
+}
+
+int main(int argc, char **argv) {
+    std::size_t n = argc > 1 ? atoll(argv[1]) : 4000000;
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> uni(-100, 100);
+    std::vector<float> x(n), y(n), z(n), gx(n), gy(n), gz(n);
+    for (std::size_t i = 0; i < n; i++) {
+        x[i] = uni(rng);
+        y[i] = uni(rng);
+        z[i] = uni(rng);
+    }
+    // points of a regular grid in scanline order, runs of them share a noise cell
+    std::size_t side = (std::size_t)std::ceil(std::cbrt((double)n));
+    for (std::size_t i = 0; i < n; i++) {
+        gx[i] = (i % side) * 0.05f;
+        gy[i] = (i / side % side) * 0.05f;
+        gz[i] = (i / side / side) * 0.05f;
+    }
+
+    auto grad = [] (vec3f const &p) { return PerlinNoise1::perlin(p[0], p[1], p[2]); };
+    auto gradBatch = [] (int m, float const *x, float const *y, float const *z, float *out) {
+        PerlinNoise1::perlin_batch(m, x, y, z, out);
+    };
+    auto hash = [] (vec3f const &p) { return PerlinNoise::perlin(p, 0.5f, 3); };
+    auto hashBatch = [] (int m, float const *x, float const *y, float const *z, float *out) {
+        PerlinNoise::perlin_batch(m, x, y, z, 0.5f, 3, out);
+    };
+    compare("gradient noise, random points", x, y, z, grad, gradBatch);
+    compare("hash noise depth 3, random points", x, y, z, hash, hashBatch);
+    compare("hash noise depth 3, grid points", gx, gy, gz, hash, hashBatch);
+}
@@ -0,0 +1,151 @@
+// times the neighbour loops that PrimReorder is meant to speed up on uniformly
+// random points, once in generation order and once after primMortonOrder and
+// primReorderVerts: a pass over the hash grid of ParticlesNeighborWrangle
+// (pnw.cpp) and LBvh point queries, both doing the same small amount of work per
+// neighbour, then checks that every vertex finds the same neighbours either way;
+// build against a zeno build with
+//   g++ -std=c++17 -O2 -fopenmp misc/tools/reorderbench.cpp projects/ZenoFX/LinearBvh.cpp -Iprojects/ZenoFX -Izeno/include -Lbuild/bin -lzeno -o reorderbench
+// optional arguments: points (default 1000000), mean neighbours (default 30)
+#include <zeno/funcs/PrimitiveUtils.h>
+#include <zeno/types/PrimitiveObject.h>
+#include "LinearBvh.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+using namespace zeno;
+
+template <class F>
+static double timeMs(F &&f) {
+    auto t0 = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// the dense grid of pnw.cpp's HashGrid, one bucket per radius sized cell
+struct HashGrid {
+    float inv_dx;
+    vec3f pMin;
+    vec3i gridRes;
+    std::vector<std::vector<int>> table;
+
+    HashGrid(std::vector<vec3f> const &refpos, float radius) {
+        inv_dx = 1.0f / radius;
+        pMin = refpos[0];
+        vec3f pMax = refpos[0];
+        for (auto const &p: refpos) {
+            pMin = zeno::min(pMin, p);
+            pMax = zeno::max(pMax, p);
+        }
+        pMin -= radius;
+        pMax += radius;
+        gridRes = zeno::toint(zeno::floor((pMax - pMin) * inv_dx)) + 1;
+        table.resize(gridRes[0] * gridRes[1] * gridRes[2]);
+        for (int i = 0; i < (int)refpos.size(); i++) {
+            auto coor = zeno::toint(zeno::floor((refpos[i] - pMin) * inv_dx));
+            table[hash(coor[0], coor[1], coor[2])].push_back(i);
+        }
+    }
+
+    int hash(int x, int y, int z) const {
+        return (x % gridRes[0] + gridRes[0]) % gridRes[0] + ((y % gridRes[1] + gridRes[1]) % gridRes[1]) * gridRes[0] +
+               ((z % gridRes[2] + gridRes[2]) % gridRes[2]) * gridRes[0] * gridRes[1];
+    }
+
+    template <class F>
+    void iter_neighbors(vec3f const &pos, F const &f) const {
+        auto coor = zeno::toint(zeno::floor((pos - pMin) * inv_dx));
+        for (int dz = -1; dz < 2; dz++)
+            for (int dy = -1; dy < 2; dy++)
+                for (int dx = -1; dx < 2; dx++)
+                    for (int pid: table[hash(coor[0] + dx, coor[1] + dy, coor[2] + dz)])
+                        f(pid);
+    }
+};
+
+struct Sums {
+    std::vector<int> count;
+    std::vector<long long> ids;
+};
+
+// for every vertex, how many neighbours lie within the radius and the sum of
+// their original indices, stored at the vertex's original index
+template <class Iter>
+static Sums neighbourSums(PrimitiveObject *prim, float radius, Iter const &iter) {
+    auto const &pos = prim->verts.values;
+    auto const &orig = prim->verts.attr<int>("orig");
+    Sums s{std::vector<int>(pos.size()), std::vector<long long>(pos.size())};
+    float r2 = radius * radius;
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (int i = 0; i < (int)pos.size(); i++) {
+        int cnt = 0;
+        long long sum = 0;
+        iter(pos[i], [&] (int j) {
+            auto d = pos[j] - pos[i];
+            if (dot(d, d) <= r2) {
+                cnt++;
+                sum += orig[j];
+            }
+        });
+        s.count[orig[i]] = cnt;
+        s.ids[orig[i]] = sum;
+    }
+    return s;
+}
+
+static void run(char const *name, std::shared_ptr<PrimitiveObject> const &prim, float radius, Sums &grid, Sums &bvh) {
+    double tGrid = timeMs([&] {
+        HashGrid hg(prim->verts.values, radius);
+        grid = neighbourSums(prim.get(), radius, [&] (vec3f const &p, auto const &f) { hg.iter_neighbors(p, f); });
+    });
+    LBvh lbvh;
+    double tBuild = timeMs([&] { lbvh = LBvh(prim, radius, LBvh::element_c<LBvh::element_e::point>); });
+    // a point LBvh reports indices into prim->points, which its first build fills
+    // and primReorderVerts remaps
+    auto const &points = prim->points.values;
+    double tQuery = timeMs([&] {
+        bvh = neighbourSums(prim.get(), radius, [&] (vec3f const &p, auto const &f) {
+            lbvh.iter_neighbors(p, [&] (int e) { f(points[e]); });
+        });
+    });
+    printf("%-16s hash grid pass %8.1f ms, LBvh build %8.1f ms, LBvh neighbour query %8.1f ms\n", name, tGrid,
+           tBuild, tQuery);
+}
+
+static std::size_t countDiffs(Sums const &a, Sums const &b) {
+    std::size_t bad = 0;
+    for (std::size_t i = 0; i < a.count.size(); i++)
+        bad += a.count[i] != b.count[i] || a.ids[i] != b.ids[i];
+    return bad;
+}
+
+int main(int argc, char **argv) {
+    int n = argc > 1 ? atoi(argv[1]) : 1000000;
+    float neighbours = argc > 2 ? atof(argv[2]) : 30;
+    // points in the unit cube, the radius holding the given number on average
+    float radius = std::cbrt(neighbours / (4.f / 3.f * (float)M_PI * n));
+
+    auto prim = std::make_shared<PrimitiveObject>();
+    prim->verts.resize(n);
+    auto &orig = prim->verts.add_attr<int>("orig");
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> uni(0, 1);
+    for (int i = 0; i < n; i++) {
+        prim->verts[i] = vec3f(uni(rng), uni(rng), uni(rng));
+        orig[i] = i;
+    }
+    printf("%d points, radius %g\n", n, radius);
+
+    Sums grid0, bvh0, grid1, bvh1;
+    run("generation order", prim, radius, grid0, bvh0);
+
+    std::vector<int> order;
+    double tOrder = timeMs([&] { order = primMortonOrder(prim.get()); });
+    double tReorder = timeMs([&] { primReorderVerts(prim.get(), order); });
+    printf("primMortonOrder %8.1f ms, primReorderVerts %8.1f ms\n", tOrder, tReorder);
+    run("Morton order", prim, radius, grid1, bvh1);
+
+    printf("vertices whose neighbours differ: hash grid %zu, LBvh %zu, hash grid against LBvh %zu\n",
+           countDiffs(grid0, grid1), countDiffs(bvh0, bvh1), countDiffs(grid0, bvh0));
+}
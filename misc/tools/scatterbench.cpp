@@ -0,0 +1,123 @@
+// times the minRadius filter of primScatter on a unit plane against the filter
+// it replaced, and checks the kept points: no pair closer than the radius, every
+// rejected candidate near a kept point, and how many serial dart throwing in
+// index order keeps; the old filter rejected a candidate for any not yet rejected
+// neighbour, later ones included, so it kept far fewer points; build against a
+// zeno build with
+//   g++ -std=c++17 -O2 -fopenmp misc/tools/scatterbench.cpp -Izeno/include -Lbuild/bin -lzeno -o scatterbench
+// optional arguments: candidates (default 2000000), minRadius (default 0.002)
+#include <zeno/funcs/PrimitiveUtils.h>
+#include <zeno/types/PrimitiveObject.h>
+#include <zeno/utils/tuple_hash.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <unordered_map>
+using namespace zeno;
+
+template <class F>
+static double timeMs(F &&f) {
+    auto t0 = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+using Grid = std::unordered_map<vec3i, std::vector<int>, tuple_hash, tuple_equal>;
+
+static Grid bucket(std::vector<vec3f> const &pos, float cell) {
+    Grid lut;
+    for (int i = 0; i < (int)pos.size(); i++)
+        lut[vec3i(zeno::floor(pos[i] / cell))].push_back(i);
+    return lut;
+}
+
+// the filter primScatter had before, kept for the comparison
+static std::vector<int> oldFilter(std::vector<vec3f> const &pos, float minRadius) {
+    float invRadius = 1.f / minRadius;
+    Grid lut;
+    for (int i = 0; i < (int)pos.size(); i++)
+        lut[vec3i(pos[i] * invRadius)].push_back(i);
+    std::vector<uint8_t> erased(pos.size());
+    for (int i = 0; i < (int)pos.size(); i++) {
+        vec3i ipos(pos[i] * invRadius);
+        for (int dz = -1; dz <= 1 && !erased[i]; dz++)
+            for (int dy = -1; dy <= 1 && !erased[i]; dy++)
+                for (int dx = -1; dx <= 1 && !erased[i]; dx++) {
+                    auto it = lut.find(ipos + vec3i(dx, dy, dz));
+                    if (it == lut.end()) continue;
+                    for (int j: it->second) {
+                        if (j != i && !erased[j] && length(pos[i] - pos[j]) < minRadius) {
+                            erased[i] = 1;
+                            break;
+                        }
+                    }
+                }
+    }
+    std::vector<int> kept;
+    for (int i = 0; i < (int)pos.size(); i++)
+        if (!erased[i]) kept.push_back(i);
+    return kept;
+}
+
+// calls f(j) for every point of lut within the radius of p
+template <class F>
+static void forNear(Grid const &lut, std::vector<vec3f> const &pts, vec3f const &p, float r, F const &f) {
+    vec3i c(zeno::floor(p / r));
+    for (int dz = -1; dz <= 1; dz++)
+        for (int dy = -1; dy <= 1; dy++)
+            for (int dx = -1; dx <= 1; dx++) {
+                auto it = lut.find(c + vec3i(dx, dy, dz));
+                if (it == lut.end()) continue;
+                for (int j: it->second)
+                    if (length(pts[j] - p) < r) f(j);
+            }
+}
+
+int main(int argc, char **argv) {
+    int n = argc > 1 ? atoi(argv[1]) : 2000000;
+    float minRadius = argc > 2 ? atof(argv[2]) : 0.002f;
+    int seed = 1;
+
+    auto plane = std::make_shared<PrimitiveObject>();
+    plane->verts.values = {vec3f(0, 0, 0), vec3f(1, 0, 0), vec3f(1, 1, 0), vec3f(0, 1, 0)};
+    plane->tris.values = {vec3i(0, 1, 2), vec3i(0, 2, 3)};
+    // the scatter weighs triangles by twice their area
+    float density = n / 2.f;
+
+    std::shared_ptr<PrimitiveObject> cands, kept;
+    double tScatter = timeMs([&] { cands = primScatter(plane.get(), "tris", "", density, 0, false, seed); });
+    double tNew = timeMs([&] { kept = primScatter(plane.get(), "tris", "", density, minRadius, false, seed); }) - tScatter;
+    auto const &cpos = cands->verts.values;
+    auto const &kpos = kept->verts.values;
+    std::vector<int> oldKept;
+    double tOld = timeMs([&] { oldKept = oldFilter(cpos, minRadius); });
+    printf("%zu candidates, minRadius %g, scatter alone %.1f ms\n", cpos.size(), minRadius, tScatter);
+    printf("old filter %10.1f ms, kept %zu\n", tOld, oldKept.size());
+    printf("new filter %10.1f ms, kept %zu\n", tNew, kpos.size());
+
+    auto lut = bucket(kpos, minRadius);
+    std::size_t close = 0, uncovered = 0;
+    for (int i = 0; i < (int)kpos.size(); i++)
+        forNear(lut, kpos, kpos[i], minRadius, [&] (int j) { close += j != i; });
+    for (auto const &p: cpos) {
+        bool covered = false;
+        forNear(lut, kpos, p, minRadius, [&] (int) { covered = true; });
+        uncovered += !covered;
+    }
+    printf("pairs closer than minRadius: %zu, rejected candidates with no kept point near: %zu\n",
+           close / 2, uncovered);
+
+    std::vector<vec3f> darts;
+    Grid dartLut;
+    for (auto const &p: cpos) {
+        bool free = true;
+        forNear(dartLut, darts, p, minRadius, [&] (int) { free = false; });
+        if (free) {
+            dartLut[vec3i(zeno::floor(p / minRadius))].push_back(darts.size());
+            darts.push_back(p);
+        }
+    }
+    printf("serial dart throwing keeps %zu, new filter %+.1f%%\n", darts.size(),
+           100.0 * ((double)kpos.size() / darts.size() - 1));
+}
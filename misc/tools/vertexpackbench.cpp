@@ -0,0 +1,96 @@
+// times the CPU side of the viewport vertex packing without a GL context: the
+// old path that filled every missing channel and interleaved 60 byte vertices
+// serially, against packVertices with only the present channels, interleaved,
+// planar and with half normals; build with
+//   g++ -std=c++17 -O2 -fopenmp misc/tools/vertexpackbench.cpp zenovis/src/bate/VertexPacking.cpp -Izenovis/include -Izeno/include -o vertexpackbench
+// optional argument: vertex count (default 4000000)
+#include <zenovis/bate/VertexPacking.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+using namespace zenovis;
+
+template <class F>
+static double timeMs(F &&f) {
+    auto t0 = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+static void report(char const *name, double ms, std::size_t bytes, std::size_t n) {
+    printf("%-28s %8.1f ms %8.1f MB %8.1f Mverts/s\n", name, ms, bytes / 1048576.0, n / ms * 1e-3);
+}
+
+int main(int argc, char **argv) {
+    std::size_t n = argc > 1 ? atoll(argv[1]) : 4000000;
+    std::vector<zeno::vec3f> pos(n), nrm(n);
+    for (std::size_t i = 0; i < n; i++) {
+        float a = i * 1e-3f;
+        pos[i] = zeno::vec3f(std::cos(a), std::sin(a), i * 1e-6f);
+        nrm[i] = zeno::vec3f(std::cos(a), std::sin(a), 0);
+    }
+
+    // what GraphicPrimitive did before: add_attr the missing channels, then interleave them all
+    std::vector<float> old;
+    std::size_t oldBytes = 0;
+    double tOld = timeMs([&] {
+        std::vector<zeno::vec3f> clr(n, zeno::vec3f(1)), uv(n), tang(n);
+        old.resize(n * 15);
+        for (std::size_t i = 0; i < n; i++) {
+            zeno::vec3f const *ch[5] = {&pos[i], &clr[i], &nrm[i], &uv[i], &tang[i]};
+            for (int c = 0; c < 5; c++)
+                for (int k = 0; k < 3; k++)
+                    old[i * 15 + c * 3 + k] = (*ch[c])[k];
+        }
+        oldBytes = (clr.size() + uv.size() + tang.size()) * sizeof(zeno::vec3f) + old.size() * sizeof(float);
+    });
+    report("fill + interleave (old)", tOld, oldBytes, n);
+
+    VertexChannelSource src[VertexLayout::NumChannels];
+    src[VertexLayout::Pos].data = pos.data();
+    src[VertexLayout::Clr].constant = zeno::vec3f(1);
+    src[VertexLayout::Nrm].data = nrm.data();
+    PackedVertices packed;
+    for (int planar = 0; planar < 2; planar++) {
+        double t = timeMs([&] { packed = packVertices(n, src, planar); });
+        report(planar ? "packVertices planar" : "packVertices interleaved", t, packed.bytes(), n);
+        // the present channels must come out as the old path wrote them
+        for (std::size_t i = 0; i < n; i += 997) {
+            for (int c: {VertexLayout::Pos, VertexLayout::Nrm}) {
+                float const *p = reinterpret_cast<float const *>(packed.words.data()) +
+                                 (packed.layout.offset[c] + i * packed.layout.channelStride(c)) / 4;
+                for (int k = 0; k < 3; k++) {
+                    if (p[k] != old[i * 15 + c * 3 + k]) {
+                        printf("MISMATCH at vertex %zu channel %d\n", i, c);
+                        return 1;
+                    }
+                }
+            }
+        }
+    }
+    src[VertexLayout::Nrm].half = true;
+    double tHalf = timeMs([&] { packed = packVertices(n, src); });
+    report("packVertices half normals", tHalf, packed.bytes(), n);
+    double tHash = timeMs([&] { hashVertexChannels(packed); });
+    report("hashVertexChannels alone", tHash, packed.bytes(), n);
+
+#ifdef __FLT16_MAX__
+    // floatToHalf against the compiler's conversion on a sample of all floats
+    std::size_t bad = 0;
+    for (std::uint64_t x = 0; x < (1ull << 32); x += 61) {
+        std::uint32_t u = (std::uint32_t)x;
+        float f;
+        std::memcpy(&f, &u, sizeof(f));
+        _Float16 h = (_Float16)f;
+        std::uint16_t ref;
+        std::memcpy(&ref, &h, sizeof(ref));
+        std::uint16_t got = floatToHalf(f);
+        if (got != ref && !(std::isnan(f) && (got & 0x7c00) == 0x7c00 && (got & 0x3ff)))
+            bad++;
+    }
+    printf("floatToHalf: %zu mismatches against _Float16\n", bad);
+#endif
+    return 0;
+}
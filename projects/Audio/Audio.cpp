@@ -12,6 +12,11 @@
 #include <zeno/types/ListObject.h>
 #include "AudioFile.h"
 #include<algorithm>
+#include <string_view>
+#include <mutex>
+#include <map>
+#include <cstdint>
+#include <cstring>
 
 #define MINIMP3_IMPLEMENTATION
 #define MINIMP3_FLOAT_OUTPUT
@@ -21,6 +26,89 @@ namespace zaudio {
 static float lerp(float start, float end, float value) {
     return start + (end - start) * value;
 }
+
+// planned fft objects are shared by all audio nodes, one per length
+static std::shared_ptr<Aquila::Fft> getPlannedFft(std::size_t length) {
+    static std::mutex mtx;
+    static std::map<std::size_t, std::shared_ptr<Aquila::Fft>> plans;
+    std::lock_guard lck(mtx);
+    auto &fft = plans[length];
+    if (!fft) {
+        fft = Aquila::FftFactory::getFft(length);
+        // ooura fft builds its twiddle tables lazily on the first transform,
+        // warm it up here so that later (parallel) transforms only read them
+        std::vector<double> zeros(length);
+        fft->fft(zeros.data());
+    }
+    return fft;
+}
+
+// fill one analysis window starting at start_index, same as what AudioFFT always did
+static void fillWindow(std::vector<float> const &value, int start_index, int duration_count,
+                       bool pre_emphasis, float alpha, bool hamming_window, double *samples) {
+    int last = (int)value.size() - 1;
+    double next = value[std::min(start_index, last)];
+    for (auto i = 0; i < duration_count; i++) {
+        double curr = next;
+        next = value[std::min(start_index + i + 1, last)];
+        samples[i] = pre_emphasis ? next - alpha * curr : curr;
+    }
+    if (hamming_window) {
+        for (auto i = 0; i < duration_count; i++) {
+            double i_value = 0.54 - 0.46 * std::cos(2.0 * M_PI * i / (duration_count - 1));
+            samples[i] = samples[i] * i_value;
+        }
+    }
+}
+
+// content hash of the samples, so that a wave read again on every frame still
+// hits the caches; chunks are hashed in parallel and combined in order
+static std::uint64_t hashSamples(std::vector<float> const &value) {
+    constexpr std::size_t kChunk = 1 << 16;
+    std::size_t nchunks = (value.size() + kChunk - 1) / kChunk;
+    std::vector<std::uint64_t> chunkHash(nchunks);
+#pragma omp parallel for
+    for (std::ptrdiff_t c = 0; c < (std::ptrdiff_t)nchunks; c++) {
+        std::uint64_t h = 0xcbf29ce484222325ull;
+        std::size_t end = std::min(value.size(), (c + 1) * kChunk);
+        for (std::size_t i = c * kChunk; i < end; i++) {
+            std::uint32_t bits;
+            std::memcpy(&bits, &value[i], sizeof(bits));
+            h = (h ^ bits) * 0x100000001b3ull;
+        }
+        chunkHash[c] = h;
+    }
+    std::uint64_t h = value.size();
+    for (auto ch: chunkHash)
+        h ^= ch + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+    return h;
+}
+
+static void melFilterBank(float const *power, std::vector<int> const &bin, int count,
+                          float rangePerFilter, float *fbank_v) {
+    for (auto i = 1; i <= count; i++) {
+        int s = bin[i-1];
+        int m = bin[i];
+        int e = bin[i+1];
+        s = (int) zaudio::lerp(m, s, rangePerFilter);
+        e = (int) zaudio::lerp(m, e, rangePerFilter);
+        float total = 0;
+        for (auto i = s; i < m; i++) {
+            float cof = (float)(m - i) / (float)(m - s);
+            total += power[i] * cof;
+        }
+        for (auto i = m; i < e; i++) {
+            float cof = 1 - (float)(m - i) / (float)(e - m);
+            total += power[i] * cof;
+        }
+        if (total == 0) {
+            fbank_v[i-1] = std::numeric_limits<float>::min();
+        }
+        else {
+            fbank_v[i-1] = log(total);
+        }
+    }
+}
 }
 namespace zeno {
 static std::shared_ptr<PrimitiveObject> readWav(std::string path){
@@ -175,7 +263,7 @@ static std::shared_ptr<PrimitiveObject> readMp3(std::string path) {
             float sampleFrequency = wave->userData().get<zeno::NumericObject>("SampleRate")->get<float>();
             int start_index = int(sampleFrequency * start_time);
             int duration_count = 1024;
-            auto fft = Aquila::FftFactory::getFft(duration_count);
+            auto fft = zaudio::getPlannedFft(duration_count);
             std::vector<double> samples;
             samples.resize(duration_count);
             for (auto i = 0; i < duration_count; i++) {
@@ -263,26 +351,27 @@ static std::shared_ptr<PrimitiveObject> readMp3(std::string path) {
             auto wave = get_input<PrimitiveObject>("wave");
             int duration_count = 1024;
             if (init.empty()) {
-                auto fft = Aquila::FftFactory::getFft(duration_count);
+                auto fft = zaudio::getPlannedFft(duration_count);
+                auto const &value = wave->attr<float>("value");
                 int clip_count = wave->size() / duration_count;
-                init.reserve(clip_count);
-                for (auto i = 0; i < clip_count; i++) {
+                init.resize(clip_count);
+#pragma omp parallel for
+                for (int i = 0; i < clip_count; i++) {
                     std::vector<double> samples;
                     samples.resize(duration_count);
                     for (auto j = 0; j < duration_count; j++) {
-                        samples[j] = wave->attr<float>("value")[min(duration_count * i + j, wave->size()-1)];
+                        samples[j] = value[min(duration_count * i + j, wave->size()-1)];
                     }
                     Aquila::SpectrumType spectrums = fft->fft(samples.data());
-                    {
-                        double E = 0;
-                        for (const auto& spectrum: spectrums) {
-                            E += spectrum.real() * spectrum.real() + spectrum.imag() * spectrum.imag();
-                        }
-                        E /= duration_count;
-                        minE = min(minE, E);
-                        maxE = max(maxE, E);
-                        init.push_back(E);
+                    double E = 0;
+                    for (const auto& spectrum: spectrums) {
+                        E += spectrum.real() * spectrum.real() + spectrum.imag() * spectrum.imag();
                     }
+                    init[i] = E / duration_count;
+                }
+                for (auto E: init) {
+                    minE = min(minE, E);
+                    maxE = max(maxE, E);
                 }
     //            for (auto i = 0; i < clip_count; i++) {
     //                init[i] = init[i] / maxE;
@@ -305,7 +394,7 @@ static std::shared_ptr<PrimitiveObject> readMp3(std::string path) {
             auto start_time = get_input2<float>("time");
             float sampleFrequency = wave->userData().get<zeno::NumericObject>("SampleRate")->get<float>();
             int start_index = int(sampleFrequency * start_time);
-            auto fft = Aquila::FftFactory::getFft(duration_count);
+            auto fft = zaudio::getPlannedFft(duration_count);
             std::vector<double> samples;
             samples.resize(duration_count);
             for (auto i = 0; i < duration_count; i++) {
@@ -376,27 +465,12 @@ static std::shared_ptr<PrimitiveObject> readMp3(std::string path) {
             float sampleFrequency = wave->userData().get<zeno::NumericObject>("SampleRate")->get<float>();
             int start_index = int(sampleFrequency * start_time);
             std::vector<double> samples;
-            samples.resize(duration_count+1);
-            for (auto i = 0; i < duration_count+1; i++) {
-                samples[i] = wave->attr<float>("value")[min((start_index + i), wave->size()-1)];
-            }
-            auto pre_emphasis = get_input2<int>("preEmphasis");
-            if (pre_emphasis) {
-                auto alpha = get_input2<float>("preEmphasisAlpha");
-                for (auto i = 0; i < duration_count; i++) {
-                    samples[i] = samples[i+1] - alpha * samples[i];
-                }
-            }
-            samples.pop_back();
-            auto hamming_window = get_input2<int>("hammingWindow");
-            if (hamming_window) {
-                for (auto i = 0; i < duration_count; i++) {
-                    double i_value = 0.54 - 0.46 * std::cos(2.0 * M_PI * i / (duration_count - 1));
-                    samples[i] = samples[i] * i_value;
-                }
-            }
+            samples.resize(duration_count);
+            zaudio::fillWindow(wave->attr<float>("value"), start_index, duration_count,
+                               get_input2<int>("preEmphasis"), get_input2<float>("preEmphasisAlpha"),
+                               get_input2<int>("hammingWindow"), samples.data());
 
-            auto fft = Aquila::FftFactory::getFft(duration_count);
+            auto fft = zaudio::getPlannedFft(duration_count);
             Aquila::SpectrumType spectrums = fft->fft(samples.data());
 
             auto fft_prim = std::make_shared<PrimitiveObject>();
@@ -435,6 +509,104 @@ static std::shared_ptr<PrimitiveObject> readMp3(std::string path) {
             "audio"
         },
     });
+    // computes the spectra of all animation frames in one parallel pass and keeps them across frames
+    struct AudioSpectrogram : zeno::INode {
+        std::uint64_t cacheKey = 0;
+        std::shared_ptr<PrimitiveObject> spectrogram;
+
+        virtual void apply() override {
+            auto wave = get_input<PrimitiveObject>("wave");
+            auto const &value = wave->attr<float>("value");
+            float sampleFrequency = wave->userData().get<zeno::NumericObject>("SampleRate")->get<float>();
+            auto fps = get_input2<float>("fps");
+            auto duration_count = get_input2<int>("windowSize");
+            auto pre_emphasis = get_input2<int>("preEmphasis");
+            auto alpha = get_input2<float>("preEmphasisAlpha");
+            auto hamming_window = get_input2<int>("hammingWindow");
+            if (fps <= 0 || duration_count < 2 || (duration_count & (duration_count - 1)))
+                throw makeError("AudioSpectrogram: fps must be positive and windowSize a power of two");
+
+            // keyed on the samples rather than on the wave object, the read
+            // nodes make a new wave every frame; hashing is one pass over the
+            // samples, much less than the transforms of every frame
+            std::uint64_t key = zaudio::hashSamples(value);
+            for (float param: {sampleFrequency, fps, (float)duration_count, (float)pre_emphasis, alpha, (float)hamming_window}) {
+                key ^= std::hash<float>{}(param) + 0x9e3779b97f4a7c15ull + (key << 6) + (key >> 2);
+            }
+
+            int bins = duration_count / 2 + 1;
+            if (!spectrogram || key != cacheKey) {
+                int frames = int(value.size() / sampleFrequency * fps) + 1;
+                auto fft = zaudio::getPlannedFft(duration_count);
+                spectrogram = std::make_shared<PrimitiveObject>();
+                spectrogram->resize((std::size_t)frames * bins);
+                auto &frame = spectrogram->add_attr<float>("frame");
+                auto &freq = spectrogram->add_attr<float>("freq");
+                auto &real = spectrogram->add_attr<float>("real");
+                auto &image = spectrogram->add_attr<float>("image");
+                auto &square = spectrogram->add_attr<float>("square");
+                auto &power = spectrogram->add_attr<float>("power");
+#pragma omp parallel for
+                for (int f = 0; f < frames; f++) {
+                    std::vector<double> samples(duration_count);
+                    int start_index = int(sampleFrequency * (f / fps));
+                    zaudio::fillWindow(value, start_index, duration_count, pre_emphasis, alpha,
+                                       hamming_window, samples.data());
+                    Aquila::SpectrumType spectrums = fft->fft(samples.data());
+                    for (int i = 0; i < bins; i++) {
+                        std::size_t k = (std::size_t)f * bins + i;
+                        float r = spectrums[i].real();
+                        float im = spectrums[i].imag();
+                        frame[k] = float(f);
+                        freq[k] = float(i);
+                        real[k] = r;
+                        image[k] = im;
+                        float square_v = r * r + im * im;
+                        square[k] = square_v;
+                        power[k] = square_v / duration_count;
+                    }
+                }
+                spectrogram->userData().set2("frames", frames);
+                spectrogram->userData().set2("bins", bins);
+                spectrogram->userData().set2("fps", fps);
+                cacheKey = key;
+                zeno::log_info("AudioSpectrogram: computed {} frames of {} bins", frames, bins);
+            }
+            // handed out as it is, like the Cached* nodes do with their value
+            set_output("spectrogram", spectrogram);
+
+            // the single frame at `time`, laid out exactly as the FFTPrim of AudioFFT
+            int frames = spectrogram->userData().get2<int>("frames");
+            int f = std::clamp(int(std::round(get_input2<float>("time") * fps)), 0, frames - 1);
+            auto fft_prim = std::make_shared<PrimitiveObject>();
+            fft_prim->resize(bins);
+            for (auto const &name: {"freq", "real", "image", "square", "power"}) {
+                auto const &src = spectrogram->attr<float>(name);
+                auto &dst = fft_prim->add_attr<float>(name);
+                std::copy_n(src.begin() + (std::size_t)f * bins, bins, dst.begin());
+            }
+            set_output("FFTPrim", fft_prim);
+        }
+    };
+    ZENDEFNODE(AudioSpectrogram, {
+        {
+            "wave",
+            {"float", "time", "0"},
+            {"float", "fps", "24"},
+            {"int", "windowSize", "1024"},
+            {"bool", "preEmphasis", "0"},
+            {"float", "preEmphasisAlpha", "0.97"},
+            {"bool", "hammingWindow", "1"},
+        },
+        {
+            "FFTPrim",
+            "spectrogram",
+        },
+        {},
+        {
+            "audio"
+        },
+    });
     struct MelFilter : zeno::INode {
         virtual void apply() override {
             auto fftPrim = get_input<PrimitiveObject>("FFTPrim");
@@ -450,48 +622,42 @@ static std::shared_ptr<PrimitiveObject> readMp3(std::string path) {
                 float hz = 700.0 * (pow(10.0, mel / 2595.0) - 1);
                 hz_points.push_back(hz);
             }
+            // a spectrogram from AudioSpectrogram holds many fft frames, filter all of them at once
+            int frames = fftPrim->userData().get2<int>("frames", 1);
+            int bins = fftPrim->userData().get2<int>("bins", (int)fftPrim->size());
+            int duration_count = (bins - 1) * 2;
             std::vector<int> bin;
             for (const auto& hz: hz_points) {
-                int index = (1024.0+1.0) * hz / sampleFreq;
+                int index = (duration_count+1.0) * hz / sampleFreq;
                 bin.push_back(index);
             }
             auto fbank = std::make_shared<PrimitiveObject>();
-            fbank->resize(count);
+            fbank->resize(count * frames);
             auto& fbank_v = fbank->add_attr<float>("fbank");
-            for (auto i = 1; i <= count; i++) {
-                int s = bin[i-1];
-                int m = bin[i];
-                int e = bin[i+1];
-                s = (int) zaudio::lerp(m, s, rangePerFilter);
-                e = (int) zaudio::lerp(m, e, rangePerFilter);
-                float total = 0;
-                for (auto i = s; i < m; i++) {
-                    float cof = (float)(m - i) / (float)(m - s);
-                    total += power[i] * cof;
-                }
-                for (auto i = m; i < e; i++) {
-                    float cof = 1 - (float)(m - i) / (float)(e - m);
-                    total += power[i] * cof;
-                }
-                if (total == 0) {
-                    fbank_v[i-1] = std::numeric_limits<float>::min();
-                }
-                else {
-                    fbank_v[i-1] = log(total);
-                }
+#pragma omp parallel for
+            for (int f = 0; f < frames; f++) {
+                zaudio::melFilterBank(power.data() + f * bins, bin, count, rangePerFilter, fbank_v.data() + f * count);
             }
             auto indexType = get_input2<std::string>("indexType");
             if (indexType == "index") {
                 auto& index = fbank->add_attr<float>("i");
-                for (auto i = 1; i <= count; i++) {
-                    index[i-1] = (float)(i-1);
+                for (auto i = 0; i < count * frames; i++) {
+                    index[i] = (float)(i % count);
                 };
             } else if (indexType == "indexdivcount") {
                 auto& index = fbank->add_attr<float>("i");
-                for (auto i = 1; i <= count; i++) {
-                    index[i-1] = (float)(i-1) /count;
+                for (auto i = 0; i < count * frames; i++) {
+                    index[i] = (float)(i % count) / count;
                 };
             }
+            if (fftPrim->userData().has("frames")) {
+                auto& frame = fbank->add_attr<float>("frame");
+                for (auto i = 0; i < count * frames; i++) {
+                    frame[i] = (float)(i / count);
+                }
+                fbank->userData().set2("frames", frames);
+                fbank->userData().set2("count", count);
+            }
             set_output("FilterBank", fbank);
         }
     };
@@ -194,21 +194,15 @@ public:
 				nB=1;
 				label=Eigen::VectorXi::Zero(nV);
 				computeTransFromLabel();
-				std::cout << "computeTransFromLabel" << std::endl;
-				std::cout << label.transpose() << std::endl;
 
 				bool cont=true;
 				while (cont) {
 					cbInitSplitBegin();
 					int prev=nB;
 					split(targetNB, 3);
-					std::cout << "split" << std::endl;
-					std::cout << label.transpose() << std::endl;
 					for (int rep=0; rep<nInitIters; rep++) {
 						computeTransFromLabel();
 						computeLabel();
-						std::cout << "computeLabel" << std::endl;
-						std::cout << label.transpose() << std::endl;
 						pruneBones(3);
 					}
 					cont=(nB<targetNB)&&(nB>prev);
@@ -10,6 +10,10 @@
 #include <cstdio>
 #include <iostream>
 #include <fstream>
+#include <chrono>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 
 #include "DemBonesExt.h"
@@ -49,11 +53,13 @@ public:
 
 	void cbIterBegin() {
         fmt::print("Iter {}: ", iter);
+		iterStart=std::chrono::steady_clock::now();
 	}
 
 	bool cbIterEnd() {
 		double err=rmse();
-        fmt::print("RMSE =  {}\n", err);
+		double secs=std::chrono::duration<double>(std::chrono::steady_clock::now()-iterStart).count();
+        fmt::print("RMSE =  {} ({} s)\n", err, secs);
 		if ((err<prevErr*(1+weightEps))&&((prevErr-err)<tolerance*prevErr)) {
 			np--;
 			if (np==0) {
@@ -69,6 +75,7 @@ public:
 	}
 
 	void cbInitSplitEnd() {
+        fmt::print("Init: {} bones\n", nB);
 	}
 
 	void cbWeightsBegin() {
@@ -94,6 +101,7 @@ public:
 private:
 	double prevErr;
 	int np;
+	std::chrono::steady_clock::time_point iterStart;
 };
 
 namespace zeno {
@@ -113,75 +121,106 @@ struct FrameInfo: zeno::IObject {
     MatrixXd boneFrameTranslate;
 };
 
+// fills the sequence and the rest pose of the model, frames holds the vertex
+// positions of each frame, all with as many vertices as the reference
+static void setupModel(MyDemBones &model, std::vector<vec3f const *> const &frames, PrimitiveObject *ref) {
+    model.nS = 1;
+    model.nV = ref->verts.size();
+    model.nF = frames.size();
+
+    model.v.resize(3*model.nF, model.nV);
+    model.fTime.resize(model.nF);
+    model.fStart.resize(model.nS+1);
+    model.fStart(0) = 0;
+    model.fStart(1) = model.fStart(0) + model.nF;
+    model.subjectID = VectorXi::Zero(model.nF);
+
+    // columns are contiguous, so each vertex gathers its positions over all frames
+    #pragma omp parallel for
+    for (int i = 0; i < model.nV; i++) {
+        float *col = model.v.col(i).data();
+        for (int k = 0; k < model.nF; k++) {
+            auto const &pos = frames[k][i];
+            col[k * 3 + 0] = pos[0];
+            col[k * 3 + 1] = pos[1];
+            col[k * 3 + 2] = pos[2];
+        }
+    }
+
+    model.u.resize(3, model.nV);
+    auto const &rest = ref->verts;
+    #pragma omp parallel for
+    for (int i = 0; i < model.nV; i++) {
+        model.u.col(i) << rest[i][0], rest[i][1], rest[i][2];
+    }
+
+    model.fv.clear();
+    model.fv.reserve(ref->tris.size());
+    for (auto const& f: ref->tris) {
+        model.fv.push_back({f[0], f[1], f[2]});
+    }
+}
+
 struct DemBones : zeno::INode {
     virtual void apply() override {
         auto list = get_input<ListObject>("BakedPrimList");
         auto vec_prims = list->get<shared_ptr<PrimitiveObject>>();
         auto prim = get_input<PrimitiveObject>("RefPrim");
         int bone_number = get_param<int>("bone_number");
+        int init_stride = std::max(1, get_param<int>("init_frame_stride"));
 
-        MyDemBones model;
-        model.nS = 1;
-        model.nV = prim->verts.size();
-        model.nF = vec_prims.size();
-        fmt::print("------------- 1 ----------------\n");
-        fmt::print("------------- model.nF: {} ----------------\n", model.nF);
-        fmt::print("------------- model.nV: {} ----------------\n", model.nV);
+#ifdef _OPENMP
+        // Eigen threads its large products only when built with OpenMP, as libzeno
+        // is when ZENO_ENABLE_OPENMP finds it; products inside the solver's own
+        // parallel loops stay serial since nested regions are off
+        Eigen::setNbThreads(omp_get_max_threads());
+#endif
+        fmt::print("------------- model.nF: {} ----------------\n", vec_prims.size());
+        fmt::print("------------- model.nV: {} ----------------\n", prim->verts.size());
+        fmt::print("------------- threads: {} ----------------\n", Eigen::nbThreads());
 
         size_t number_ref_model_vert = prim->verts.size();
-        for (size_t f = 0; f < model.nF; f++) {
+        std::vector<vec3f const *> frames(vec_prims.size());
+        for (size_t f = 0; f < vec_prims.size(); f++) {
             size_t cur_frame_model_vert_number = vec_prims[f]->get()->verts.size();
             if (cur_frame_model_vert_number != number_ref_model_vert) {
                 throw("dem bones vert num not match!");
             }
+            frames[f] = vec_prims[f]->get()->verts.data();
         }
 
-        fmt::print("start read mesh sequence\n");
-        // read mesh sequence
-        {
-            model.v.resize(3*model.nF, model.nV);
-            model.fTime.resize(model.nF);
-            model.fStart.resize(model.nS+1);
-            model.fStart(0)=0;
-
-            for(int k = 0; k < model.nF; k++) {
-                for (int i = 0; i < model.nV; i++) {
-                    auto pos = vec_prims[k]->get()->verts[i];
-                    model.v.col(i).segment<3>(k * 3) << pos[0], pos[1], pos[2];
-                }
-            }
-            model.fStart(1) = model.fStart(0) + model.nF;
+        auto t0 = std::chrono::steady_clock::now();
+        auto elapsed = [&] {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        };
 
-            model.subjectID.resize(model.nF);
-            for (int k=model.fStart(0); k<model.fStart(1); k++)  {
-                model.subjectID(k)=0;
-            }
+        MyDemBones model;
+        setupModel(model, frames, prim.get());
+        fmt::print("read mesh sequence in {} s\n", elapsed());
+
+        // the bone clustering only needs a coarse look at the motion, so it
+        // can run on every init_stride-th frame, the weights it ends with
+        // seed the solve on the whole sequence
+        model.nB = bone_number;
+        if (init_stride > 1 && model.nF > init_stride) {
+            std::vector<vec3f const *> initFrames;
+            for (size_t k = 0; k < frames.size(); k += init_stride)
+                initFrames.push_back(frames[k]);
+            MyDemBones initModel;
+            setupModel(initModel, initFrames, prim.get());
+            initModel.nB = bone_number;
+            initModel.init();
+            model.nB = initModel.nB;
+            model.w = initModel.w;
+            fmt::print("initialized {} bones from {} frames in {} s\n", model.nB, initFrames.size(), elapsed());
         }
+        model.init();
+        fmt::print("initialized in {} s\n", elapsed());
 
-        fmt::print("start read reference mesh\n");
-
-        // read reference mesh
-        {
-            MatrixXd v;
-            v.resize(3, model.nV);
-            for (int i = 0; i < model.nV; i++)  {
-                auto &pos = prim->verts;
-                v.col(i) << pos[i][0], pos[i][1], pos[i][2];
-            }
-            model.u.resize(3, model.nV);
-            model.u.block(0, 0, 3, model.nV) = v;
-
-            // model.fv=importer.fv;
-            for (auto const& f: prim->tris) {
-                model.fv.push_back({f[0], f[1], f[2]});
-            }
-
-            model.nB = bone_number;
-            model.init();
-        }
         fmt::print("Computing Skinning Decomposition:\n");
 
         model.compute();
+        fmt::print("computed skinning decomposition in {} s\n", elapsed());
 
         MatrixXd lr, lt, gb, lbr, lbt;
         model.computeRTB(0, lr, lt, gb, lbr, lbt);
@@ -211,7 +250,7 @@ ZENDEFNODE(DemBones,{
         "SkiningInfo",
         "FrameInfo",
     },
-    {{"int", "bone_number", "20"}},
+    {{"int", "bone_number", "20"}, {"int", "init_frame_stride", "1"}},
     {"DemBones"},
 });
 
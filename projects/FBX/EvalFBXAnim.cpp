@@ -13,9 +13,119 @@
 
 #include <glm/vec4.hpp>
 #include <glm/mat4x4.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <variant>
 
 namespace {
 
+template <class T>
+bool sameBytes(std::vector<T> const &a, std::vector<T> const &b) {
+    return a.size() == b.size() && !std::memcmp(a.data(), b.data(), a.size() * sizeof(T));
+}
+
+// makes dst hold the same arrays as src, arrays that already do are left alone
+template <class T>
+void syncAttrVector(zeno::AttrVector<T> &dst, zeno::AttrVector<T> const &src, bool withValues) {
+    if (withValues ? !sameBytes(dst.values, src.values) : dst.values.size() != src.values.size())
+        dst.values = src.values;
+    for (auto it = dst.attrs.begin(); it != dst.attrs.end();) {
+        it = src.attrs.count(it->first) ? std::next(it) : dst.attrs.erase(it);
+    }
+    for (auto const &[key, arr]: src.attrs) {
+        auto &dstArr = dst.attrs[key];
+        bool same = std::visit([&] (auto const &srcVec) {
+            using V = std::decay_t<decltype(srcVec)>;
+            auto dstVec = std::get_if<V>(&dstArr);
+            return dstVec && sameBytes(*dstVec, srcVec);
+        }, arr);
+        if (!same)
+            dstArr = arr;
+    }
+}
+
+// bone weights of a mesh in compressed rows, with the parts of the output
+// primitive that stay the same over the animation (topology, uvs, normals and
+// colors), built once per FBXData
+struct SkinTable {
+    std::vector<std::string> bones;
+    std::vector<int> start;  // vertex i has influences start[i] to start[i + 1]
+    std::vector<int> bone;
+    std::vector<float> weight;
+    std::vector<zeno::vec3f> restPos;
+    zeno::PrimitiveObject statics;
+
+    void build(std::vector<SVertex> const &vertices, std::vector<unsigned int> const &indices) {
+        std::unordered_map<std::string, int> boneIds;
+        bones.clear();
+        bone.clear();
+        weight.clear();
+        start.assign(1, 0);
+        restPos.resize(vertices.size());
+        for (std::size_t i = 0; i < vertices.size(); i++) {
+            for (auto const &[name, w]: vertices[i].boneWeights) {
+                auto [it, fresh] = boneIds.try_emplace(name, (int)bones.size());
+                if (fresh)
+                    bones.push_back(name);
+                bone.push_back(it->second);
+                weight.push_back(w);
+            }
+            start.push_back((int)bone.size());
+            auto const &pos = vertices[i].position;
+            restPos[i] = zeno::vec3f(pos.x, pos.y, pos.z);
+        }
+
+        statics = zeno::PrimitiveObject();
+        statics.verts.resize(vertices.size());
+        auto &uv = statics.verts.add_attr<zeno::vec3f>("uv");
+        auto &norm = statics.verts.add_attr<zeno::vec3f>("nrm");
+        auto &posb = statics.verts.add_attr<zeno::vec3f>("posb");
+        auto &clr0 = statics.verts.add_attr<zeno::vec3f>("clr0");
+#pragma omp parallel for
+        for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)vertices.size(); i++) {
+            auto const &uvw = vertices[i].texCoord;
+            auto const &nor = vertices[i].normal;
+            auto const &vco = vertices[i].vectexColor;
+            uv[i] = zeno::vec3f(uvw.x, uvw.y, uvw.z);
+            norm[i] = zeno::vec3f(nor.x, nor.y, nor.z);
+            posb[i] = zeno::vec3f(0.0f, 0.0f, 0.0f);
+            clr0[i] = zeno::vec3f(vco.r, vco.g, vco.b);
+        }
+
+        auto &ind = statics.tris;
+        ind.resize(indices.size() / 3);
+        auto &uv0 = statics.tris.add_attr<zeno::vec3f>("uv0");
+        auto &uv1 = statics.tris.add_attr<zeno::vec3f>("uv1");
+        auto &uv2 = statics.tris.add_attr<zeno::vec3f>("uv2");
+#pragma omp parallel for
+        for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)ind.size(); i++) {
+            unsigned int _i1 = indices[i * 3];
+            unsigned int _i2 = indices[i * 3 + 1];
+            unsigned int _i3 = indices[i * 3 + 2];
+            ind[i] = zeno::vec3i(_i1, _i2, _i3);
+            uv0[i] = zeno::vec3f(vertices[_i1].texCoord[0], vertices[_i1].texCoord[1], 0);
+            uv1[i] = zeno::vec3f(vertices[_i2].texCoord[0], vertices[_i2].texCoord[1], 0);
+            uv2[i] = zeno::vec3f(vertices[_i3].texCoord[0], vertices[_i3].texCoord[1], 0);
+        }
+    }
+
+    // turns a primitive handed out on an earlier frame back into the statics,
+    // only the arrays some node downstream changed are copied again; the
+    // positions are left for calculateFinal to overwrite
+    void restore(zeno::PrimitiveObject &prim) const {
+        auto verts = std::move(prim.verts);
+        auto tris = std::move(prim.tris);
+        prim = zeno::PrimitiveObject();
+        prim.verts = std::move(verts);
+        prim.tris = std::move(tris);
+        syncAttrVector(prim.verts, statics.verts, false);
+        syncAttrVector(prim.tris, statics.tris, true);
+    }
+};
+
 struct EvalAnim{
     double m_Duration;
     double m_TicksPerSecond;
@@ -29,8 +139,6 @@ struct EvalAnim{
     std::unordered_map<std::string, SBoneOffset> m_BoneOffset;
     std::unordered_map<std::string, SAnimBone> m_AnimBones;
     //std::unordered_map<std::string, std::string> m_MeshCorsName;
-    std::vector<SVertex> m_Vertices;
-    std::vector<unsigned int> m_Indices;
 
     void initAnim(std::shared_ptr<NodeTree>& nodeTree,
                   std::shared_ptr<BoneTree>& boneTree,
@@ -39,9 +147,6 @@ struct EvalAnim{
         m_Duration = animInfo->duration;
         m_TicksPerSecond = animInfo->tick;
 
-        m_Vertices = fbxData->iVertices.value;
-        m_Indices = fbxData->iIndices.value;
-
         m_RootNode = *nodeTree;
         m_AnimBones = boneTree->AnimBoneMap;
         m_BoneOffset = fbxData->iBoneOffset.value;
@@ -49,17 +154,15 @@ struct EvalAnim{
         m_CurrentFrame = 0.0f;
     }
 
-    void updateAnimation(int fi, std::shared_ptr<zeno::PrimitiveObject>& prim, float s, float fps) {
+    void updateAnimation(int fi, float fps) {
         // TODO Use the actual frame number
         float dt = fi / fps;
         m_DeltaTime = dt;
-        m_CurrentFrame += m_TicksPerSecond * dt;
-        m_CurrentFrame = fmod(m_CurrentFrame, m_Duration);
+        m_CurrentFrame = fmod(m_TicksPerSecond * dt, m_Duration);
 
         //zeno::log_info("Update: F {} D {} C {}", fi, dt, m_CurrentFrame);
 
         calculateBoneTransform(&m_RootNode, aiMatrix4x4());
-        calculateFinal(prim, s);
     }
 
     void decomposeAnimation(std::shared_ptr<zeno::DictObject> &t,
@@ -152,68 +255,105 @@ struct EvalAnim{
         }
     }
 
-    void calculateFinal(std::shared_ptr<zeno::PrimitiveObject>& prim, float s){
-        auto &ver = prim->verts;
-        auto &ind = prim->tris;
-        auto &uv = prim->verts.add_attr<zeno::vec3f>("uv");
-        auto &norm = prim->verts.add_attr<zeno::vec3f>("nrm");
-        auto &posb = prim->verts.add_attr<zeno::vec3f>("posb");
-
-        for(unsigned int i=0; i<m_Vertices.size(); i++){
-            auto& bwe = m_Vertices[i].boneWeights;
-            auto& pos = m_Vertices[i].position;
-            auto& uvw = m_Vertices[i].texCoord;
-            auto& nor = m_Vertices[i].normal;
-            auto& vco = m_Vertices[i].vectexColor;
-            auto &clr0 = prim->verts.add_attr<zeno::vec3f>("clr0");
-            glm::vec4 tpos(0.0f, 0.0f, 0.0f, 0.0f);
-
-            bool infd = false;
-
-            for(auto& b: bwe){
-
-                infd = true;
-                auto& tr = m_Transforms[b.first];
-                glm::mat4 trans = glm::mat4(tr.a1,tr.b1,tr.c1,tr.d1,
-                                            tr.a2,tr.b2,tr.c2,tr.d2,
-                                            tr.a3,tr.b3,tr.c3,tr.d3,
-                                            tr.a4,tr.b4,tr.c4,tr.d4);
-                glm::vec4 lpos = trans * glm::vec4(pos.x, pos.y, pos.z, 1.0f);
-                tpos += lpos * b.second;
+    // skins the rest positions of the table with the current bone transforms,
+    // dual quaternion blending takes only the rotation and translation of each
+    // bone, so it avoids the candy wrapper of linear blending but drops scale
+    void calculateFinal(SkinTable const &skin, zeno::PrimitiveObject &prim, float s, bool dualQuat) {
+        auto &ver = prim.verts.values;
+
+        // bone matrices as three rows of a 3x4 affine transform
+        std::vector<glm::vec4> rows(skin.bones.size() * 3);
+        std::vector<glm::quat> real(skin.bones.size()), dual(skin.bones.size());
+        for (std::size_t b = 0; b < skin.bones.size(); b++) {
+            auto& tr = m_Transforms[skin.bones[b]];
+            rows[b * 3 + 0] = glm::vec4(tr.a1, tr.a2, tr.a3, tr.a4);
+            rows[b * 3 + 1] = glm::vec4(tr.b1, tr.b2, tr.b3, tr.b4);
+            rows[b * 3 + 2] = glm::vec4(tr.c1, tr.c2, tr.c3, tr.c4);
+            if (dualQuat) {
+                aiVector3t<float> trans;
+                aiQuaterniont<float> rotate;
+                aiVector3t<float> scale;
+                tr.Decompose(scale, rotate, trans);
+                real[b] = glm::quat(rotate.w, rotate.x, rotate.y, rotate.z);
+                dual[b] = glm::quat(0.0f, trans.x, trans.y, trans.z) * real[b] * 0.5f;
             }
-            if(! infd)
-                tpos = glm::vec4(pos.x, pos.y, pos.z, 1.0f);
-
-            glm::vec3 fpos = glm::vec3(tpos.x/tpos.w, tpos.y/tpos.w, tpos.z/tpos.w);
-
-            ver.emplace_back(fpos.x*s, fpos.y*s, fpos.z*s);
-            posb.emplace_back(0.0f, 0.0f, 0.0f);
-            uv.emplace_back(uvw.x, uvw.y, uvw.z);
-            norm.emplace_back(nor.x, nor.y, nor.z);
-            clr0.emplace_back(vco.r, vco.g, vco.b);
-        }
-
-        for(unsigned int i=0; i<m_Indices.size(); i+=3){
-            zeno::vec3i incs(m_Indices[i],m_Indices[i+1],m_Indices[i+2]);
-            ind.push_back(incs);
         }
 
-        auto &uv0 = prim->tris.add_attr<zeno::vec3f>("uv0");
-        auto &uv1 = prim->tris.add_attr<zeno::vec3f>("uv1");
-        auto &uv2 = prim->tris.add_attr<zeno::vec3f>("uv2");
-        for(unsigned int i=0; i<ind.size(); i++){
-            unsigned int _i1 = ind[i][0];
-            unsigned int _i2 = ind[i][1];
-            unsigned int _i3 = ind[i][2];
-            uv0[i] = zeno::vec3f(m_Vertices[_i1].texCoord[0], m_Vertices[_i1].texCoord[1], 0);
-            uv1[i] = zeno::vec3f(m_Vertices[_i2].texCoord[0], m_Vertices[_i2].texCoord[1], 0);
-            uv2[i] = zeno::vec3f(m_Vertices[_i3].texCoord[0], m_Vertices[_i3].texCoord[1], 0);
-
+#pragma omp parallel for
+        for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)skin.restPos.size(); i++) {
+            auto const &rp = skin.restPos[i];
+            glm::vec3 pos(rp[0], rp[1], rp[2]);
+            int b0 = skin.start[i], b1 = skin.start[i + 1];
+            glm::vec3 fpos = pos;
+            if (b0 != b1 && !dualQuat) {
+                glm::vec4 r0(0.0f), r1(0.0f), r2(0.0f);
+                float wsum = 0.0f;
+                for (int k = b0; k < b1; k++) {
+                    int b = skin.bone[k];
+                    float w = skin.weight[k];
+                    r0 += rows[b * 3 + 0] * w;
+                    r1 += rows[b * 3 + 1] * w;
+                    r2 += rows[b * 3 + 2] * w;
+                    wsum += w;
+                }
+                glm::vec4 hpos(pos, 1.0f);
+                if (wsum != 0.0f)
+                    fpos = glm::vec3(glm::dot(r0, hpos), glm::dot(r1, hpos), glm::dot(r2, hpos)) / wsum;
+            } else if (b0 != b1) {
+                glm::quat qr(0.0f, 0.0f, 0.0f, 0.0f), qd(0.0f, 0.0f, 0.0f, 0.0f);
+                auto const &pivot = real[skin.bone[b0]];
+                for (int k = b0; k < b1; k++) {
+                    int b = skin.bone[k];
+                    // keep all quaternions in the same hemisphere as the first
+                    float w = glm::dot(pivot, real[b]) < 0.0f ? -skin.weight[k] : skin.weight[k];
+                    qr += real[b] * w;
+                    qd += dual[b] * w;
+                }
+                float len = glm::length(qr);
+                qr /= len;
+                qd /= len;
+                glm::vec3 rv(qr.x, qr.y, qr.z), dv(qd.x, qd.y, qd.z);
+                fpos = qr * pos + 2.0f * (qr.w * dv - qd.w * rv + glm::cross(rv, dv));
+            }
+            ver[i] = zeno::vec3f(fpos.x * s, fpos.y * s, fpos.z * s);
         }
     }
 };
 
 struct EvalFBXAnim : zeno::INode {
+    std::shared_ptr<FBXData> m_skinData;
+    SkinTable m_skin;
+
+    // the prims of the last frames, one that nothing else holds anymore is
+    // skinned again instead of copying the statics into a new one; the prim of
+    // the previous frame is usually still an input of the nodes downstream
+    static constexpr std::size_t kMaxFramePrims = 2;
+    std::deque<std::shared_ptr<zeno::PrimitiveObject>> m_framePrims;
+
+    std::shared_ptr<zeno::PrimitiveObject> framePrim() {
+        for (auto it = m_framePrims.begin(); it != m_framePrims.end(); ++it) {
+            if (it->use_count() == 1) {
+                auto prim = std::move(*it);
+                m_framePrims.erase(it);
+                m_skin.restore(*prim);
+                m_framePrims.push_back(prim);
+                return prim;
+            }
+        }
+        auto prim = std::make_shared<zeno::PrimitiveObject>(m_skin.statics);
+        m_framePrims.push_back(prim);
+        if (m_framePrims.size() > kMaxFramePrims)
+            m_framePrims.pop_front();
+        return prim;
+    }
+
+    // the animation is set up again only when one of its inputs is another
+    // object, with a cached import that's once per session
+    EvalAnim m_anim;
+    std::shared_ptr<FBXData> m_animData;
+    std::shared_ptr<NodeTree> m_animNodeTree;
+    std::shared_ptr<BoneTree> m_animBoneTree;
+    std::shared_ptr<AnimInfo> m_animInfo;
 
     virtual void apply() override {
         int frameid;
@@ -244,7 +384,6 @@ struct EvalFBXAnim : zeno::INode {
             zeno::log_error("FBX: Empty NodeTree, BoneTree or AnimInfo");
         }
 
-        auto prim = std::make_shared<zeno::PrimitiveObject>();
         auto transDict = std::make_shared<zeno::DictObject>();
         auto quatDict = std::make_shared<zeno::DictObject>();
         auto scaleDict = std::make_shared<zeno::DictObject>();
@@ -253,11 +392,32 @@ struct EvalFBXAnim : zeno::INode {
         auto matName = std::make_shared<zeno::StringObject>();
         auto outMeshName = std::make_shared<zeno::StringObject>();
 
-        EvalAnim anim;
-        anim.initAnim(nodeTree, boneTree, fbxData, animInfo);
-        anim.updateAnimation(frameid, prim, s, fps);
+        auto t0 = std::chrono::steady_clock::now();
+        bool reinit = m_animData != fbxData || m_animNodeTree != nodeTree
+                   || m_animBoneTree != boneTree || m_animInfo != animInfo;
+        if (reinit) {
+            m_anim = EvalAnim();
+            m_anim.initAnim(nodeTree, boneTree, fbxData, animInfo);
+            m_animData = fbxData;
+            m_animNodeTree = nodeTree;
+            m_animBoneTree = boneTree;
+            m_animInfo = animInfo;
+        }
+        auto &anim = m_anim;
+        anim.updateAnimation(frameid, fps);
+        bool rebuilt = m_skinData != fbxData;
+        if (rebuilt) {
+            m_skin.build(fbxData->iVertices.value, fbxData->iIndices.value);
+            m_skinData = fbxData;
+            m_framePrims.clear();
+        }
+        auto prim = framePrim();
+        anim.calculateFinal(m_skin, *prim, s, get_param<std::string>("skinning") == "DUAL_QUATERNION");
         anim.updateCameraAndLight(fbxData, iCamera, iLight, s);
         anim.decomposeAnimation(transDict, quatDict, scaleDict);
+        auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        zeno::log_debug("FBX: Evaluated frame {} in {} ms{}{}", frameid, ms,
+                        reinit ? ", animation initialized" : "", rebuilt ? ", skin table built" : "");
 
         auto prims = std::make_shared<zeno::ListObject>();
         auto& meshName = fbxData->iMeshName.value_relName;
@@ -337,6 +497,7 @@ ZENDEFNODE(EvalFBXAnim,
                {
                    {"enum FROM_MAYA DEFAULT", "unit", "FROM_MAYA"},
                    {"enum TRUE FALSE", "interAnimData", "FALSE"},
+                   {"enum LINEAR DUAL_QUATERNION", "skinning", "LINEAR"},
                },  /* category: */
                {
                    "FBX",
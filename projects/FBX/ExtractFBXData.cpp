@@ -14,6 +14,8 @@
 #include <glm/vec4.hpp>
 #include <glm/mat4x4.hpp>
 
+#include <map>
+
 namespace {
 
 struct ExtractFBXData : zeno::INode {
@@ -274,41 +276,68 @@ ZENDEFNODE(ExtractCameraData,
            });
 
 struct ExchangeFBXData : zeno::INode {
+    // the FBXData from ReadFBXPrim is shared by every frame, so it's never
+    // changed in place: rebinding makes a copy, and the copies of the last
+    // frame are handed out again while their source and trees stay the same,
+    // which lets EvalFBXAnim keep its state
+    struct Rebound {
+        std::shared_ptr<FBXData> src;
+        std::shared_ptr<FBXData> dst;
+    };
+    std::map<FBXData const *, Rebound> m_rebound;
 
     virtual void apply() override {
         auto animinfo = get_input<AnimInfo>("animinfo");
         auto nodetree = get_input<NodeTree>("nodetree");
         auto bonetree = get_input<BoneTree>("bonetree");
 
+        std::map<FBXData const *, Rebound> rebound;
+        auto rebind = [&] (std::shared_ptr<FBXData> const &src) {
+            auto &r = rebound[src.get()];
+            if (r.dst)
+                return r.dst;
+            r.src = src;
+            auto it = m_rebound.find(src.get());
+            if (src->nodeTree == nodetree && src->boneTree == bonetree && src->animInfo == animinfo) {
+                r.dst = src;
+            } else if (it != m_rebound.end() && it->second.dst->nodeTree == nodetree
+                       && it->second.dst->boneTree == bonetree && it->second.dst->animInfo == animinfo) {
+                r.dst = it->second.dst;
+            } else {
+                r.dst = std::make_shared<FBXData>(*src);
+                r.dst->nodeTree = nodetree;
+                r.dst->boneTree = bonetree;
+                r.dst->animInfo = animinfo;
+            }
+            return r.dst;
+        };
+
         auto paramDType = get_param<std::string>("dType");
         std::string dType;
         if(paramDType == "DATA"){
             auto data = get_input<FBXData>("d");
-            data->nodeTree = nodetree;
-            data->boneTree = bonetree;
-            data->animInfo = animinfo;
-            set_output("d", std::move(data));
+            set_output("d", rebind(data));
         }else if(paramDType == "DATAS"){
             auto datas = get_input<zeno::DictObject>("d");
+            auto outDatas = std::make_shared<zeno::DictObject>();
             for (auto &[k, v]: datas->lut) {
-                auto vc = zeno::safe_dynamic_cast<FBXData>(v.get());
-                vc->animInfo = animinfo;
-                vc->boneTree = bonetree;
-                vc->nodeTree = nodetree;
+                auto vc = zeno::safe_dynamic_cast<FBXData>(v);
+                outDatas->lut[k] = rebind(vc);
             }
-            set_output("d", std::move(datas));
+            set_output("d", std::move(outDatas));
         }else if(paramDType == "MATS"){
             auto mats = get_input<zeno::DictObject>("d");
+            auto outMats = std::make_shared<zeno::DictObject>();
             for (auto &[k, v]: mats->lut) {
-                auto vc = zeno::safe_dynamic_cast<MatData>(v.get());
+                auto vc = std::make_shared<MatData>(*zeno::safe_dynamic_cast<MatData>(v.get()));
                 for(auto &[_k, _v]: vc->iFbxData.value){
-                    _v->animInfo = animinfo;
-                    _v->nodeTree = nodetree;
-                    _v->boneTree = bonetree;
+                    _v = rebind(_v);
                 }
+                outMats->lut[k] = std::move(vc);
             }
-            set_output("d", std::move(mats));
+            set_output("d", std::move(outMats));
         }
+        m_rebound = std::move(rebound);
     }
 };
 ZENDEFNODE(ExchangeFBXData,
@@ -26,6 +26,7 @@
 #include <zeno/types/DictObject.h>
 #include <zeno/types/ListObject.h>
 #include <zeno/utils/logger.h>
+#include <zeno/utils/format.h>
 #include <zeno/extra/GlobalState.h>
 
 #include <stack>
@@ -33,6 +34,11 @@
 #include <unordered_map>
 #include <filesystem>
 #include <fstream>
+#include <chrono>
+#include <mutex>
+#include <map>
+#include <algorithm>
+#include <cstdint>
 
 #include <glm/vec4.hpp>
 #include <glm/mat4x4.hpp>
@@ -1007,18 +1013,63 @@ void readFBXFile(
     zeno::log_info("FBX: Total Indices count {}", mesh.fbxData.iIndices.value.size());
 }
 
+struct FBXImport {
+    std::filesystem::file_time_type mtime;
+    std::uint64_t lastUse = 0;
+    std::shared_ptr<zeno::DictObject> datas = std::make_shared<zeno::DictObject>();
+    std::shared_ptr<NodeTree> nodeTree = std::make_shared<NodeTree>();
+    std::shared_ptr<FBXData> data = std::make_shared<FBXData>();
+    std::shared_ptr<BoneTree> boneTree = std::make_shared<BoneTree>();
+    std::shared_ptr<AnimInfo> animInfo = std::make_shared<AnimInfo>();
+    std::shared_ptr<zeno::PrimitiveObject> prim = std::make_shared<zeno::PrimitiveObject>();
+    std::shared_ptr<zeno::DictObject> prims = std::make_shared<zeno::DictObject>();
+    std::shared_ptr<zeno::DictObject> mats = std::make_shared<zeno::DictObject>();
+};
+
+// the last few imports are kept, a file is parsed again only when it changes
+// on disk, is read with other options or has been pushed out by other files
+std::shared_ptr<FBXImport> importFBXCached(std::string const &path, SFBXReadOption readOption, bool &reused) {
+    constexpr std::size_t kMaxImports = 4;
+    static std::mutex mtx;
+    static std::map<std::string, std::shared_ptr<FBXImport>> cache;
+    static std::uint64_t useCounter = 0;
+
+    std::error_code ec;
+    auto mtime = std::filesystem::last_write_time(std::filesystem::u8path(path), ec);
+    auto key = zeno::format("{}|{}{}{}{}", path, readOption.invertOpacity, readOption.makePrim,
+                            readOption.enableUDIM, readOption.generate);
+    {
+        std::lock_guard lck(mtx);
+        auto it = cache.find(key);
+        if (!ec && it != cache.end() && it->second->mtime == mtime) {
+            it->second->lastUse = ++useCounter;
+            reused = true;
+            return it->second;
+        }
+    }
+
+    reused = false;
+    auto imp = std::make_shared<FBXImport>();
+    imp->mtime = mtime;
+    readFBXFile(imp->datas, imp->nodeTree, imp->data, imp->boneTree, imp->animInfo,
+                path.c_str(), imp->prim, imp->prims, imp->mats, readOption);
+    if (!ec) {
+        std::lock_guard lck(mtx);
+        imp->lastUse = ++useCounter;
+        cache[key] = imp;
+        while (cache.size() > kMaxImports) {
+            cache.erase(std::min_element(cache.begin(), cache.end(), [] (auto const &l, auto const &r) {
+                return l.second->lastUse < r.second->lastUse;
+            }));
+        }
+    }
+    return imp;
+}
+
 struct ReadFBXPrim : zeno::INode {
 
     virtual void apply() override {
         auto path = get_input<zeno::StringObject>("path")->get();
-        std::shared_ptr<zeno::DictObject> datas = std::make_shared<zeno::DictObject>();
-        auto nodeTree = std::make_shared<NodeTree>();
-        auto animInfo = std::make_shared<AnimInfo>();
-        auto data = std::make_shared<FBXData>();
-        auto boneTree = std::make_shared<BoneTree>();
-        auto prim = std::make_shared<zeno::PrimitiveObject>();
-        std::shared_ptr<zeno::DictObject> prims = std::make_shared<zeno::DictObject>();
-        std::shared_ptr<zeno::DictObject> mats = std::make_shared<zeno::DictObject>();
 
         auto fbxFileName = Path(path)
                                .replace_extension("")
@@ -1043,8 +1094,36 @@ struct ReadFBXPrim : zeno::INode {
 
         zeno::log_info("FBX: UDIM {} PRIM {} INVERT {}", readOption.enableUDIM,readOption.makePrim,readOption.invertOpacity);
 
-        readFBXFile(datas, nodeTree, data, boneTree, animInfo,
-                    path.c_str(), prim, prims, mats, readOption);
+        auto t0 = std::chrono::steady_clock::now();
+        bool reused = false;
+        auto imp = importFBXCached(path, readOption, reused);
+
+        // the parsed scene is shared by every frame: the FBXData and the trees
+        // are handed out as they are, so nodes downstream like EvalFBXAnim see
+        // the same objects each frame and keep their state; no node changes
+        // them in place, ExchangeFBXData rebinds copies. The dicts, materials
+        // and prims are fresh since prim nodes edit their inputs
+        auto data = imp->data;
+        auto nodeTree = imp->nodeTree;
+        auto boneTree = imp->boneTree;
+        auto animInfo = imp->animInfo;
+        auto datas = std::make_shared<zeno::DictObject>();
+        for (auto const &[k, v]: imp->datas->lut) {
+            if (std::dynamic_pointer_cast<FBXData>(v))
+                datas->lut[k] = v;
+            else
+                datas->lut[k] = v->clone();
+        }
+        auto mats = std::make_shared<zeno::DictObject>();
+        for (auto const &[k, v]: imp->mats->lut)
+            mats->lut[k] = v->clone();
+        auto prim = std::static_pointer_cast<zeno::PrimitiveObject>(imp->prim->clone());
+        auto prims = std::make_shared<zeno::DictObject>();
+        for (auto const &[k, v]: imp->prims->lut)
+            prims->lut[k] = v->clone();
+
+        auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        zeno::log_info("FBX: {} {} in {} ms", reused ? "Reused import of" : "Imported", path, ms);
 
         if(generate){
             int count = 0;
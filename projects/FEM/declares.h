@@ -116,6 +116,13 @@ struct FEMIntegrator : zeno::IObject {
 
     SpMat _connMatrix;
 
+    // linear solver state of SolveFEM, the symbolic analysis only depends on the sparsity
+    // pattern of _connMatrix, so it is done once and only the numeric factorization is redone
+    Eigen::SimplicialLDLT<SpMat> _LDLTSolver;
+    bool _LDLTAnalyzed = false;
+    // the last Newton step, used as the initial guess of the iterative solver
+    VecXd _lastDp;
+
     size_t _stepID;
 
     // initialize all the element-wise attributes by interpolating corresponding vertex-wise attributes, 
@@ -153,6 +160,8 @@ struct FEMIntegrator : zeno::IObject {
         _connMatrix = SpMat(prim->size() * 3,prim->size() * 3);
         _connMatrix.setFromTriplets(connTriplets.begin(),connTriplets.end());
         _connMatrix.makeCompressed();
+        _LDLTAnalyzed = false;
+        _lastDp.resize(0);
 
         // _elmVolume.resize(nm_elms);
         _elmdFdx.resize(nm_elms);
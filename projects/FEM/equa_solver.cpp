@@ -388,9 +388,6 @@ ZENDEFNODE(SolveFEMFast,{
 struct SolveFEM : zeno::INode {
     virtual void apply() override {
         // std::cout << "BEGIN SOLVER " << std::endl;
-        Eigen::SparseLU<SpMat> _LUSolver;
-        Eigen::SimplicialLDLT<SpMat> _LDLTSolver;
-
         auto integrator = get_input<FEMIntegrator>("integrator");
         auto shape = get_input<PrimitiveObject>("shape");
         auto elmView = get_input<PrimitiveObject>("elmView");
@@ -409,6 +406,9 @@ struct SolveFEM : zeno::INode {
         auto c2 = get_input2<float>("CurvatureCoeff");
         auto beta = get_input2<float>("BTL_shrinkingRate");
         auto epsilon = get_input2<float>("epsilon");
+        auto linear_solver = get_input2<std::string>("linearSolver");
+        auto max_cg_iters = get_input2<int>("maxCGIters");
+        auto cg_tolerance = get_input2<float>("cgTolerance");
 
         std::vector<Vec2d> wolfeBuffer;
         wolfeBuffer.resize(max_linesearch);
@@ -441,7 +441,9 @@ struct SolveFEM : zeno::INode {
         FEM_Scaler e0,e1,eg0;
         do{
 
+            double begin_assemble = omp_get_wtime();
             e0 = integrator->EvalObjDerivHessian(shape,elmView,interpShape,r,HBuffer,true);
+            double end_assemble = omp_get_wtime();
             // std::cout << "FINISH EVAL A X B" << std::endl;
             
             if(iter_idx == 0)
@@ -514,10 +516,36 @@ struct SolveFEM : zeno::INode {
             }
             r *= -1;
 
-            clock_t begin_solve = clock();
-            _LDLTSolver.compute(MatHelper::MapHMatrix(shape->size(),integrator->_connMatrix,HBuffer.data()));
-            dp = _LDLTSolver.solve(r);
-            clock_t end_solve = clock();
+            double begin_solve = omp_get_wtime();
+            auto H = MatHelper::MapHMatrix(shape->size(),integrator->_connMatrix,HBuffer.data());
+            int cg_iters = 0;
+            if(linear_solver == "PCG"){
+                Eigen::ConjugateGradient<SpMat,Eigen::Lower|Eigen::Upper,Eigen::DiagonalPreconditioner<FEM_Scaler>> cg;
+                cg.setMaxIterations(max_cg_iters);
+                cg.setTolerance(cg_tolerance);
+                cg.compute(H);
+                // warm start from the last Newton step, which may come from the previous frame
+                bool warm_start = integrator->_lastDp.size() == r.size();
+                if(warm_start)
+                    dp = cg.solveWithGuess(r,integrator->_lastDp);
+                else
+                    dp = cg.solve(r);
+                cg_iters = cg.iterations();
+                if(warm_start && dp.dot(r) <= 0){
+                    // an unconverged warm started solution is not guaranteed to be a descent direction
+                    dp = cg.solve(r);
+                    cg_iters += cg.iterations();
+                }
+            }else{
+                if(!integrator->_LDLTAnalyzed){
+                    integrator->_LDLTSolver.analyzePattern(H);
+                    integrator->_LDLTAnalyzed = true;
+                }
+                integrator->_LDLTSolver.factorize(H);
+                dp = integrator->_LDLTSolver.solve(r);
+            }
+            integrator->_lastDp = dp;
+            double end_solve = omp_get_wtime();
 
             // std::cout << "INTERNAL SIZE : " << r.norm() << "\t" << dp.norm() << HBuffer.norm() << std::endl;
 
@@ -560,7 +588,13 @@ struct SolveFEM : zeno::INode {
                     break;
                 }
             }
-            std::cout << "SOLVE TIME : " << (float)(end_solve - begin_solve)/CLOCKS_PER_SEC << "\t" << r0 << "\t" << r.norm() << "\t" << eg0 << "\t" << search_idx << "\t" << e_start << "\t" << e0 << "\t" << e1 << std::endl;
+            double end_linesearch = omp_get_wtime();
+            std::cout << "NEWTON STEP " << iter_idx << " : assemble " << end_assemble - begin_assemble << "\tsolve " << end_solve - begin_solve
+                << "\tlinesearch " << end_linesearch - end_solve;
+            if(linear_solver == "PCG")
+                std::cout << "\tcg iters " << cg_iters;
+            std::cout << std::endl;
+            std::cout << "SOLVE TIME : " << end_solve - begin_solve << "\t" << r0 << "\t" << r.norm() << "\t" << eg0 << "\t" << search_idx << "\t" << e_start << "\t" << e0 << "\t" << e1 << std::endl;
 
             ++iter_idx;
         }while(iter_idx < max_iters);
@@ -585,7 +619,8 @@ struct SolveFEM : zeno::INode {
 ZENDEFNODE(SolveFEM,{
     {"integrator","shape","elmView","skin",{"int","maxNRIters","10"},{"int","maxBTLs","10"},{"float","ArmijoCoeff","0.01"},
         {"float","CurvatureCoeff","0.9"},{"float","BTL_shrinkingRate","0.5"},
-        {"float","epsilon","1e-8"}
+        {"float","epsilon","1e-8"},{"enum LDLT PCG","linearSolver","LDLT"},
+        {"int","maxCGIters","1000"},{"float","cgTolerance","1e-4"}
     },
     {"shape"},
     {},
@@ -14,6 +14,8 @@
 #include "simd_vdb_poisson.h"
 #include <openvdb/tools/Interpolation.h>
 #include <xmmintrin.h>
+#include <chrono>
+#include <zeno/utils/log.h>
 // #include "BPS3D_volume_vel_cache.h" // decouple Datan BEM works for now
 
 #include "tbb/blocked_range3d.h"
@@ -3508,7 +3510,8 @@ void FLIP_vdb::solve_pressure_simd(
     openvdb::FloatGrid::Ptr &pushed_out_liquid_sdf,
     openvdb::FloatGrid::Ptr &rhsgrid, openvdb::FloatGrid::Ptr &curr_pressure,
     openvdb::Vec3fGrid::Ptr &face_weight, openvdb::Vec3fGrid::Ptr &velocity,
-    openvdb::Vec3fGrid::Ptr &solid_velocity, float dt, float dx) {
+    openvdb::Vec3fGrid::Ptr &solid_velocity, float dt, float dx,
+    std::shared_ptr<simd_vdb_poisson> *solver_cache) {
   // CSim::TimerMan::timer("Sim.step/vdbflip/pressure/buildlevel").start();
 
     //skip if there is no dof to solve
@@ -3516,12 +3519,18 @@ void FLIP_vdb::solve_pressure_simd(
 		return;
 	}
 
-  auto simd_solver =
-      simd_vdb_poisson(liquid_sdf, face_weight, velocity,
-                       solid_velocity, dt, dx);
+  auto simd_solver_ptr = std::make_shared<simd_vdb_poisson>(
+      liquid_sdf, face_weight, velocity, solid_velocity, dt, dx);
+  auto &simd_solver = *simd_solver_ptr;
 
-  simd_solver.construct_levels();
+  simd_solver.construct_levels(solver_cache ? solver_cache->get() : nullptr);
+  if (solver_cache) {
+    // whatever is reused has been taken over by the new hierarchy
+    solver_cache->reset();
+  }
+  auto rhs_begin = std::chrono::steady_clock::now();
   simd_solver.build_rhs();
+  auto rhs_end = std::chrono::steady_clock::now();
   // CSim::TimerMan::timer("Sim.step/vdbflip/pressure/buildlevel").stop();
 
   auto pressure = simd_solver.m_laplacian_with_levels[0]->get_zero_vec_grid();
@@ -3541,10 +3550,13 @@ void FLIP_vdb::solve_pressure_simd(
     }
   }; // end set_warm_pressure
 
-  // simd_solver.m_laplacian_with_levels[0]->m_dof_leafmanager->foreach(set_warm_pressure);
+  simd_solver.m_laplacian_with_levels[0]->m_dof_leafmanager->foreach (
+      set_warm_pressure);
 
   // CSim::TimerMan::timer("Sim.step/vdbflip/pressure/simdpcg").start();
+  auto pcg_begin = std::chrono::steady_clock::now();
   bool converged = simd_solver.pcg_solve(pressure, 1e-7);
+  auto pcg_end = std::chrono::steady_clock::now();
   // CSim::TimerMan::timer("Sim.step/vdbflip/pressure/simdpcg").stop();
   if (converged)
     curr_pressure.swap(pressure);
@@ -3555,6 +3567,23 @@ void FLIP_vdb::solve_pressure_simd(
     simd_solver.smooth_solve(pressure, 200);
     curr_pressure.swap(pressure);
   }
+
+  const auto &stats = simd_solver.m_stats;
+  auto ms = [](auto begin, auto end) {
+    return std::chrono::duration<double, std::milli>(end - begin).count();
+  };
+  zeno::log_debug("pressure solve: {} levels, {} dofs, {}/{} leaves reused{}, "
+                  "{} iterations, residual {}{}; levels {:.3} ms, coarsest {:.3} ms, "
+                  "rhs {:.3} ms, pcg {:.3} ms",
+                  stats.levels, stats.ndof, stats.reused_leaves, stats.leaves,
+                  stats.reused_topology ? ", same layout" : "", stats.iterations,
+                  stats.residual, converged ? "" : ", not converged", stats.levels_ms,
+                  stats.coarsest_ms, ms(rhs_begin, rhs_end), ms(pcg_begin, pcg_end));
+
+  if (solver_cache) {
+    simd_solver.release_scratch();
+    *solver_cache = std::move(simd_solver_ptr);
+  }
   // CSim::TimerMan::timer("Sim.step/vdbflip/pressure/updatevel").start();
   // apply_pressure_gradient(dt);
   // CSim::TimerMan::timer("Sim.step/vdbflip/pressure/updatevel").stop();
@@ -4,8 +4,9 @@
 #include "openvdb/points/PointConversion.h"
 #include <openvdb/Types.h>
 #include <openvdb/openvdb.h>
+#include <memory>
 
-
+class simd_vdb_poisson;
 
 static inline float frand(unsigned int i) {
 	unsigned int value = (i ^ 61) ^ (i >> 16);
@@ -149,12 +150,16 @@ struct FLIP_vdb {
       openvdb::FloatGrid::Ptr &liquid_sdf, openvdb::FloatGrid::Ptr &solid_sdf,
       openvdb::FloatGrid::Ptr &pushed_out_liquid_sdf, float dx);
 
+  // curr_pressure is the initial guess and receives the result, if
+  // solver_cache is given the multigrid hierarchy of the last solve is
+  // taken from it and this solve's is left there for the next one
   static void solve_pressure_simd(
       openvdb::FloatGrid::Ptr &liquid_sdf,
       openvdb::FloatGrid::Ptr &pushed_out_liquid_sdf,
       openvdb::FloatGrid::Ptr &rhsgrid, openvdb::FloatGrid::Ptr &curr_pressure,
       openvdb::Vec3fGrid::Ptr &face_weight, openvdb::Vec3fGrid::Ptr &velocity,
-      openvdb::Vec3fGrid::Ptr &solid_velocity, float dt, float dx);
+      openvdb::Vec3fGrid::Ptr &solid_velocity, float dt, float dx,
+      std::shared_ptr<simd_vdb_poisson> *solver_cache = nullptr);
 
   static void apply_pressure_gradient(
       openvdb::FloatGrid::Ptr &liquid_sdf, openvdb::FloatGrid::Ptr &solid_sdf,
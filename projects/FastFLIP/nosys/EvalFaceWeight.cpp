@@ -18,6 +18,7 @@ struct CutCellWeightEval : zeno::INode {
     auto face_weight = get_input("FaceWeight")->as<VDBFloat3Grid>();
     auto liquid_sdf = get_input("LiquidSDF")->as<VDBFloatGrid>();
     auto solid_sdf = get_input("SolidSDF")->as<VDBFloatGrid>();
+    face_weight->detach();
     FLIP_vdb::calculate_face_weights(face_weight->m_grid, liquid_sdf->m_grid,
                                      solid_sdf->m_grid);
   }
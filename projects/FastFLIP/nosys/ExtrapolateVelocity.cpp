@@ -535,6 +535,7 @@ struct Vec3FieldExtrapolate : zeno::INode {
     int n = get_param<int>("NumIterates");
     auto velocity = get_input("Field")->as<VDBFloat3Grid>();
 
+    velocity->detach();
     vdb_velocity_extrapolator::extrapolate(n, velocity->m_grid);
   }
 };
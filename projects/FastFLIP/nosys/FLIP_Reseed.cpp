@@ -10,6 +10,7 @@ struct FluidReseed : zeno::INode {
     auto particles = get_input("Particles")->as<VDBPointsGrid>();
     auto liquidSDF = get_input("LiquidSDF")->as<VDBFloatGrid>();
     auto liquidVel = get_input("FluidVel")->as<VDBFloat3Grid>();
+    particles->detach();
     FLIP_vdb::reseed_fluid(particles->m_grid, liquidSDF->m_grid,
                            liquidVel->m_grid);
   }
@@ -21,6 +21,7 @@ struct FieldAddVector : zeno::INode {
     auto ivec3 =
         get_input("invec3")->as<zeno::NumericObject>()->get<zeno::vec3f>();
     auto velocity = get_input("Velocity")->as<VDBFloat3Grid>();
+    velocity->detach();
     if (has_input("FieldWeight")) {
       auto face_weight = get_input("FieldWeight")->as<VDBFloat3Grid>();
 
@@ -25,6 +25,8 @@ struct PushOutLiquidSDF : zeno::INode {
     auto pushed_out_liquid_sdf =
         get_input("ExtractedLiquidSDF")->as<VDBFloatGrid>();
 
+    liquid_sdf->detach();
+    pushed_out_liquid_sdf->detach();
     FLIP_vdb::clamp_liquid_phi_in_solids(liquid_sdf->m_grid, solid_sdf->m_grid,
                                          pushed_out_liquid_sdf->m_grid, dx);
   }
@@ -39,6 +39,7 @@ struct G2P_Advector : zeno::INode {
     else
       solid_vel = nullptr;
     auto velocity_after_p2g = get_input("PostAdvVelocity")->as<VDBFloat3Grid>();
+    particles->detach();
     FLIP_vdb::Advect(dt, dx, particles->m_grid, velocity->m_grid,
                      velocity_after_p2g->m_grid, solid_sdf,
                      solid_vel, smoothness, RK_ORDER);
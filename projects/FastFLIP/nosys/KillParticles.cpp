@@ -152,6 +152,7 @@ struct KillParticlesInSDF : zeno::INode {
         auto points = get_input<VDBPointsGrid>("Particles");
         auto sdf = get_input<VDBFloatGrid>("KillerSDF");
         auto keep = has_input("OpType:") ? get_input2<std::string>("OpType:") : "KEEP";
+        points->detach();
         kill_particles_inside(points->m_grid, sdf->m_grid, keep=="KEEP");
         set_output("Particles", std::move(points));
     }
@@ -31,6 +31,7 @@ struct FLIP_P2G : zeno::INode {
     auto ExtractedLiquidSDFGrid =
         get_input("ExtractedLiquidSDF")->as<VDBFloatGrid>();
     bool setActive = false;
+    // no detach() needed, every output grid gets a new tree or is replaced
     FLIP_vdb::particle_to_grid_collect_style(
         Particles->m_grid, VelGrid->m_grid, PostP2GVelGrid->m_grid,
         VelWeightGrid->m_grid, LiquidSDFGrid->m_grid,
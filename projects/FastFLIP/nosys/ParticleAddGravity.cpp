@@ -15,6 +15,7 @@ struct ParticleAddDV : zeno::INode {
     float vy = get_param<float>("vy");
     float vz = get_param<float>("vz");
     openvdb::Vec3R _dv = openvdb::Vec3R(dv[0], dv[1], dv[2]);
+    particles->detach();
     FLIP_vdb::point_integrate_vector(particles->m_grid, _dv, "vel");
   }
 };
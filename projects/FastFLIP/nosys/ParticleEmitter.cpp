@@ -31,6 +31,7 @@ struct ParticleEmitter : zeno::INode {
       liquid_sdf = get_input("LiquidSDF")->as<VDBFloatGrid>()->m_grid;
     }
 
+    particles->detach();
     FLIP_vdb::emit_liquid(particles->m_grid, shape->m_grid,
                           velocityVolume, liquid_sdf, vx, vy,
                           vz);
@@ -21,6 +21,10 @@ static void FLIP_vdb::solve_pressure_simd(
 namespace zeno {
 
 struct AssembleSolvePPE : zeno::INode {
+  // multigrid hierarchy of the last substep, reused where the liquid is
+  // unchanged when reuseSolver is on
+  std::shared_ptr<simd_vdb_poisson> m_solver;
+
   virtual void apply() override {
     auto dt = get_input("dt")->as<zeno::NumericObject>()->get<float>();
     auto dx = get_param<float>("dx");
@@ -36,10 +40,13 @@ struct AssembleSolvePPE : zeno::INode {
     auto face_weight = get_input("CellFWeight")->as<VDBFloat3Grid>();
     auto velocity = get_input("Velocity")->as<VDBFloat3Grid>();
     auto solid_velocity = get_input("SolidVelocity")->as<VDBFloat3Grid>();
+    auto reuse = get_param<bool>("reuseSolver");
+    if (!reuse)
+      m_solver = nullptr;
     FLIP_vdb::solve_pressure_simd(
         liquid_sdf->m_grid, pushed_out_liquid_sdf->m_grid, rhsgrid->m_grid,
         curr_pressure->m_grid, face_weight->m_grid, velocity->m_grid,
-        solid_velocity->m_grid, dt, dx);
+        solid_velocity->m_grid, dt, dx, reuse ? &m_solver : nullptr);
   }
 };
 
@@ -59,6 +66,7 @@ static int defAssembleSolvePPE = zeno::defNodeClass<AssembleSolvePPE>(
                          /* params: */
                          {
                              {"float", "dx", "0.0"},
+                             {"bool", "reuseSolver", "0"},
                          },
 
                          /* category: */
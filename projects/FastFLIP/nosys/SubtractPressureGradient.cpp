@@ -38,6 +38,7 @@ struct SubtractPressureGradient : zeno::INode {
     auto velocity = get_input("Velocity")->as<VDBFloat3Grid>();
     auto solid_velocity = get_input("SolidVelocity")->as<VDBFloat3Grid>();
 
+    velocity->detach();
     FLIP_vdb::apply_pressure_gradient(
         liquid_sdf->m_grid, solid_sdf->m_grid, pushed_out_liquid_sdf->m_grid,
         curr_pressure->m_grid, face_weight->m_grid, velocity->m_grid,
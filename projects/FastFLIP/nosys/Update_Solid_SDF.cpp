@@ -23,6 +23,7 @@ struct FLIP_Solid_Modifier : zeno::INode {
     if (moving_solid_sdf != nullptr)
       moving_solids.emplace_back(moving_solid_sdf->m_grid);
 
+    static_solid_sdf->detach();
     FLIP_vdb::update_solid_sdf(moving_solids, static_solid_sdf->m_grid,
                                particles->m_grid);
   }
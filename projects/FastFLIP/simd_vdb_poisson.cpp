@@ -6,10 +6,12 @@
 #include "openvdb/tree/LeafManager.h"
 #include "tbb/concurrent_vector.h"
 #include <atomic>
+#include <chrono>
 simd_vdb_poisson::Laplacian_with_level::Laplacian_with_level(
     openvdb::FloatGrid::Ptr in_liquid_phi,
     openvdb::Vec3fGrid::Ptr in_face_weights, const float in_dt,
-    const float in_dx) {
+    const float in_dx, const Laplacian_with_level *previous,
+    const std::set<openvdb::Coord> *clean_leaves) {
   // random token to identify the finest level
   std::random_device device;
   std::mt19937 generator(/*seed=*/device());
@@ -52,13 +54,14 @@ simd_vdb_poisson::Laplacian_with_level::Laplacian_with_level(
   m_Neg_z_entry = m_Neg_x_entry->deepCopy();
   m_Neg_z_entry->setName("Neg_z_term");
 
-  initialize_finest(in_liquid_phi, in_face_weights);
+  initialize_finest(in_liquid_phi, in_face_weights, previous, clean_leaves);
 
   initialize_evaluators();
 }
 
 simd_vdb_poisson::Laplacian_with_level::Laplacian_with_level(
-    const Laplacian_with_level &parent, coarsening) {
+    const Laplacian_with_level &parent, coarsening,
+    const Laplacian_with_level *same_topology) {
   // copy the token
   m_root_token = parent.m_root_token;
 
@@ -67,11 +70,12 @@ simd_vdb_poisson::Laplacian_with_level::Laplacian_with_level(
   m_dx_this_level = 2.0f * parent.m_dx_this_level;
   m_level = parent.m_level + 1;
 
-  initialize_entries_from_parent(parent);
+  initialize_entries_from_parent(parent, same_topology);
 }
 
 void simd_vdb_poisson::Laplacian_with_level::initialize_entries_from_parent(
-    const Laplacian_with_level &parent) {
+    const Laplacian_with_level &parent,
+    const Laplacian_with_level *same_topology) {
   // the parent diagonal and face terms is already trimmed
   // hence only the parent dof_idx keeps the actual layout
   // of the degree of freedoms
@@ -79,48 +83,58 @@ void simd_vdb_poisson::Laplacian_with_level::initialize_entries_from_parent(
       openvdb::math::Transform::createLinearTransform(m_dx_this_level);
   coarse_xform->postTranslate(openvdb::Vec3d(0.5 * parent.m_dx_this_level));
 
-  m_dof_idx = openvdb::Int32Grid::create(-1);
-  m_dof_idx->setTransform(coarse_xform);
-  for (auto iter = parent.m_dof_idx->tree().cbeginLeaf(); iter; ++iter) {
-    m_dof_idx->tree().touchLeaf(openvdb::Coord(iter->origin().asVec3i() / 2));
-  }
+  if (same_topology) {
+    // the dof layout only depends on the finer levels' layouts, which are
+    // the same as when same_topology was built, and is never modified
+    m_dof_idx = same_topology->m_dof_idx;
+    m_ndof = same_topology->m_ndof;
+    m_dof_leafmanager =
+        std::make_unique<openvdb::tree::LeafManager<openvdb::Int32Tree>>(
+            m_dof_idx->tree());
+  } else {
+    m_dof_idx = openvdb::Int32Grid::create(-1);
+    m_dof_idx->setTransform(coarse_xform);
+    for (auto iter = parent.m_dof_idx->tree().cbeginLeaf(); iter; ++iter) {
+      m_dof_idx->tree().touchLeaf(openvdb::Coord(iter->origin().asVec3i() / 2));
+    }
 
-  m_dof_leafmanager =
-      std::make_unique<openvdb::tree::LeafManager<openvdb::Int32Tree>>(
-          m_dof_idx->tree());
+    m_dof_leafmanager =
+        std::make_unique<openvdb::tree::LeafManager<openvdb::Int32Tree>>(
+            m_dof_idx->tree());
 
-  // piecewise constant interpolation and restriction function
-  // coarse voxel =8 fine voxels
-  auto set_dof_mask_op = [&](openvdb::Int32Tree::LeafNodeType &leaf,
-                             openvdb::Index leafpos) {
-    auto fine_dof_axr{parent.m_dof_idx->getConstAccessor()};
-    for (auto iter = leaf.beginValueAll(); iter; ++iter) {
-      // the global coordinate in the coarse level
-      auto C_gcoord{iter.getCoord().asVec3i()};
-      auto parent_g_coord = C_gcoord * 2;
-
-      bool no_target_dof = true;
-      for (int ii = 0; ii < 2 && no_target_dof; ii++) {
-        for (int jj = 0; jj < 2 && no_target_dof; jj++) {
-          for (int kk = 0; kk < 2 && no_target_dof; kk++) {
-            if (fine_dof_axr.isValueOn(
-                    openvdb::Coord(parent_g_coord).offsetBy(ii, jj, kk))) {
-              no_target_dof = false;
+    // piecewise constant interpolation and restriction function
+    // coarse voxel =8 fine voxels
+    auto set_dof_mask_op = [&](openvdb::Int32Tree::LeafNodeType &leaf,
+                               openvdb::Index leafpos) {
+      auto fine_dof_axr{parent.m_dof_idx->getConstAccessor()};
+      for (auto iter = leaf.beginValueAll(); iter; ++iter) {
+        // the global coordinate in the coarse level
+        auto C_gcoord{iter.getCoord().asVec3i()};
+        auto parent_g_coord = C_gcoord * 2;
+
+        bool no_target_dof = true;
+        for (int ii = 0; ii < 2 && no_target_dof; ii++) {
+          for (int jj = 0; jj < 2 && no_target_dof; jj++) {
+            for (int kk = 0; kk < 2 && no_target_dof; kk++) {
+              if (fine_dof_axr.isValueOn(
+                      openvdb::Coord(parent_g_coord).offsetBy(ii, jj, kk))) {
+                no_target_dof = false;
+              }
             }
           }
-        }
-      } // for all fine voxels accociated
+        } // for all fine voxels accociated
 
-      if (no_target_dof) {
-        iter.setValueOff();
-      } else {
-        iter.setValueOn();
-      }
-    } // end for all voxel in this leaf
-  };  // end set dof_idx_op
-  m_dof_leafmanager->foreach (set_dof_mask_op);
+        if (no_target_dof) {
+          iter.setValueOff();
+        } else {
+          iter.setValueOn();
+        }
+      } // end for all voxel in this leaf
+    };  // end set dof_idx_op
+    m_dof_leafmanager->foreach (set_dof_mask_op);
 
-  set_dof_idx(m_dof_idx);
+    set_dof_idx(m_dof_idx);
+  }
 
   float dt_over_dxsqr = m_dt / (m_dx_this_level * m_dx_this_level);
   // set up the full diagonal matrix, full face weight matrix
@@ -280,13 +294,42 @@ void simd_vdb_poisson::Laplacian_with_level::initialize_entries_from_parent(
 
 void simd_vdb_poisson::Laplacian_with_level::initialize_finest(
     openvdb::FloatGrid::Ptr in_liquid_phi,
-    openvdb::Vec3fGrid::Ptr in_face_weights) {
+    openvdb::Vec3fGrid::Ptr in_face_weights,
+    const Laplacian_with_level *previous,
+    const std::set<openvdb::Coord> *clean_leaves) {
   // really create the poisson matrix
 
   float dt_over_dxsqr = m_dt / (m_dx_this_level * m_dx_this_level);
 
   // this function is to be used with the leaf manager of diagonal term
   auto set_coeffs = [&](float_leaf_t &leaf, openvdb::Index leafpos) {
+    // the inputs of this leaf are unchanged, take the entries of previous
+    const int_leaf_t *old_dof_leaf = nullptr;
+    if (clean_leaves && clean_leaves->count(leaf.origin())) {
+      old_dof_leaf = previous->m_dof_idx->tree().probeConstLeaf(leaf.origin());
+    }
+    if (old_dof_leaf) {
+      auto copy_entries = [&](openvdb::FloatGrid &to,
+                              const openvdb::FloatGrid &from) {
+        auto *to_leaf = to.tree().probeLeaf(leaf.origin());
+        if (const auto *from_leaf =
+                from.tree().probeConstLeaf(leaf.origin())) {
+          std::copy(from_leaf->buffer().data(),
+                    from_leaf->buffer().data() + from_leaf->SIZE,
+                    to_leaf->buffer().data());
+        } else {
+          // the leaf was trimmed, all of its entries were the default
+          to_leaf->fill(from.background());
+        }
+        to_leaf->setValueMask(old_dof_leaf->getValueMask());
+      };
+      copy_entries(*m_Diagonal, *previous->m_Diagonal);
+      copy_entries(*m_Neg_x_entry, *previous->m_Neg_x_entry);
+      copy_entries(*m_Neg_y_entry, *previous->m_Neg_y_entry);
+      copy_entries(*m_Neg_z_entry, *previous->m_Neg_z_entry);
+      return;
+    }
+
     // in the initial state, the tree contains both phi<0 and phi>0
     // we only take the phi<0
     const auto &phi_leaf = *in_liquid_phi->tree().probeConstLeaf(leaf.origin());
@@ -1794,19 +1837,102 @@ void simd_vdb_poisson::Laplacian_with_level::trim_default_nodes(
   }
 }
 
-void simd_vdb_poisson::construct_levels() {
+void simd_vdb_poisson::hash_leaf_inputs() {
+  auto phi_leafman =
+      openvdb::tree::LeafManager<openvdb::FloatTree>(m_liquid_sdf->tree());
+  std::vector<openvdb::Coord> origins(phi_leafman.leafCount());
+  std::vector<uint64_t> hashes(phi_leafman.leafCount());
+
+  auto hash_op = [&](float_leaf_t &leaf, openvdb::Index leafpos) {
+    // fnv-1a over 32 bit words
+    uint64_t h = 0xcbf29ce484222325ull;
+    auto mix = [&h](const void *data, size_t bytes) {
+      const auto *words = static_cast<const uint32_t *>(data);
+      for (size_t i = 0; i < bytes / 4; i++) {
+        h = (h ^ words[i]) * 0x100000001b3ull;
+      }
+    };
+    mix(leaf.buffer().data(), sizeof(float) * leaf.SIZE);
+    for (openvdb::Index i = 0; i < leaf.getValueMask().WORD_COUNT; i++) {
+      auto word = leaf.getValueMask().template getWord<openvdb::Index64>(i);
+      mix(&word, sizeof(word));
+    }
+    if (const auto *weight_leaf =
+            m_face_weight->tree().probeConstLeaf(leaf.origin())) {
+      mix(weight_leaf->buffer().data(),
+          sizeof(openvdb::Vec3f) * weight_leaf->SIZE);
+    } else {
+      // a tile or the background
+      openvdb::Vec3f weight = m_face_weight->tree().getValue(leaf.origin());
+      mix(&weight, sizeof(weight));
+    }
+    origins[leafpos] = leaf.origin();
+    hashes[leafpos] = h;
+  }; // end hash op
+  phi_leafman.foreach (hash_op);
+
+  m_leaf_input_hash.clear();
+  for (size_t i = 0; i < origins.size(); i++) {
+    m_leaf_input_hash.emplace(origins[i], hashes[i]);
+  }
+}
+
+void simd_vdb_poisson::construct_levels(const simd_vdb_poisson *previous) {
+  auto levels_begin = std::chrono::steady_clock::now();
+  hash_leaf_inputs();
+
+  // the stencil of a voxel reads the phi and face weights of its neighbours,
+  // so a leaf keeps its entries only if its face neighbour leaves' inputs
+  // are unchanged as well
+  const Laplacian_with_level *previous_level0 = nullptr;
+  std::set<openvdb::Coord> clean_leaves;
+  if (previous && !previous->m_laplacian_with_levels.empty() &&
+      previous->dt == dt && previous->m_dx == m_dx) {
+    previous_level0 = previous->m_laplacian_with_levels[0].get();
+    auto unchanged = [&](const openvdb::Coord &origin) {
+      auto it = m_leaf_input_hash.find(origin);
+      auto old_it = previous->m_leaf_input_hash.find(origin);
+      return it != m_leaf_input_hash.end() &&
+             old_it != previous->m_leaf_input_hash.end() &&
+             it->second == old_it->second;
+    };
+    const int leaf_dim = float_leaf_t::DIM;
+    for (const auto &[origin, hash] : m_leaf_input_hash) {
+      bool clean = unchanged(origin);
+      for (int i_f = 0; i_f < 6 && clean; i_f++) {
+        auto neib = origin;
+        neib[i_f / 2] += (i_f % 2 == 0) ? leaf_dim : -leaf_dim;
+        clean = unchanged(neib);
+      }
+      if (clean) {
+        clean_leaves.insert(origin);
+      }
+    }
+  }
+
   // build the first level
   Laplacian_with_level::Ptr level0 = std::make_shared<Laplacian_with_level>(
-      m_liquid_sdf, m_face_weight, dt, m_dx);
+      m_liquid_sdf, m_face_weight, dt, m_dx, previous_level0, &clean_leaves);
 
   m_laplacian_with_levels.push_back(level0);
 
+  // the coarse layouts follow from the finest one
+  bool same_topology =
+      previous_level0 &&
+      level0->m_dof_idx->tree().hasSameTopology(
+          previous_level0->m_dof_idx->tree());
+
   int max_dof = 4000;
   while (m_laplacian_with_levels.back()->m_ndof > max_dof) {
+    size_t level = m_laplacian_with_levels.size();
+    const Laplacian_with_level *same_topology_level = nullptr;
+    if (same_topology && level < previous->m_laplacian_with_levels.size()) {
+      same_topology_level = previous->m_laplacian_with_levels[level].get();
+    }
     Laplacian_with_level::Ptr next_level =
         std::make_shared<Laplacian_with_level>(
             *m_laplacian_with_levels.back(),
-            Laplacian_with_level::coarsening());
+            Laplacian_with_level::coarsening(), same_topology_level);
     m_laplacian_with_levels.push_back(next_level);
   }
 
@@ -1839,9 +1965,35 @@ void simd_vdb_poisson::construct_levels() {
       m_K_cycle_ws.push_back(openvdb::FloatGrid::create());
     }
   }
-  construct_coarsest_exact_solver();
+  auto coarsest_begin = std::chrono::steady_clock::now();
+  construct_coarsest_exact_solver(same_topology ? previous : nullptr);
+  auto coarsest_end = std::chrono::steady_clock::now();
   printf("levels: %zd Dof:%d\n", m_laplacian_with_levels.size(),
          m_laplacian_with_levels[0]->m_ndof);
+
+  m_stats.levels = m_laplacian_with_levels.size();
+  m_stats.ndof = m_laplacian_with_levels[0]->m_ndof;
+  m_stats.leaves = m_leaf_input_hash.size();
+  m_stats.reused_leaves = clean_leaves.size();
+  m_stats.reused_topology = same_topology;
+  m_stats.levels_ms = std::chrono::duration<double, std::milli>(
+                          coarsest_begin - levels_begin).count();
+  m_stats.coarsest_ms = std::chrono::duration<double, std::milli>(
+                            coarsest_end - coarsest_begin).count();
+}
+
+void simd_vdb_poisson::release_scratch() {
+  m_v_cycle_lhss.clear();
+  m_v_cycle_rhss.clear();
+  m_v_cycle_temps.clear();
+  m_K_cycle_cs.clear();
+  m_K_cycle_vs.clear();
+  m_K_cycle_ds.clear();
+  m_K_cycle_ws.clear();
+  m_liquid_sdf.reset();
+  m_face_weight.reset();
+  m_velocity.reset();
+  m_solid_velocity.reset();
 }
 
 void simd_vdb_poisson::Vcycle(const openvdb::FloatGrid::Ptr in_out_lhs,
@@ -2348,7 +2500,8 @@ void simd_vdb_poisson::Kcycle_SRJ(const openvdb::FloatGrid::Ptr in_out_lhs,
   }
 }
 
-void simd_vdb_poisson::construct_coarsest_exact_solver() {
+void simd_vdb_poisson::construct_coarsest_exact_solver(
+    const simd_vdb_poisson *same_topology) {
   // the coarse level usually contains <1000 dofs
   tbb::concurrent_vector<Eigen::Triplet<float>> ijval;
 
@@ -2418,9 +2571,16 @@ void simd_vdb_poisson::construct_coarsest_exact_solver() {
   //}
   m_coarsest_eigen_matrix.setFromTriplets(ijval.begin(), ijval.end());
   printf("factor\n");
-  m_coarsest_solver =
-      std::make_shared<Eigen::SimplicialLDLT<Eigen::SparseMatrix<float>>>(
-          m_coarsest_eigen_matrix);
+  if (same_topology && same_topology->m_coarsest_solver &&
+      same_topology->m_coarsest_eigen_matrix.rows() == ndof) {
+    // same sparsity pattern, keep the ordering and symbolic factorization
+    m_coarsest_solver = same_topology->m_coarsest_solver;
+    m_coarsest_solver->factorize(m_coarsest_eigen_matrix);
+  } else {
+    m_coarsest_solver =
+        std::make_shared<Eigen::SimplicialLDLT<Eigen::SparseMatrix<float>>>(
+            m_coarsest_eigen_matrix);
+  }
 }
 
 void simd_vdb_poisson::write_coarsest_eigen_rhs(
@@ -2573,6 +2733,9 @@ bool simd_vdb_poisson::pcg_solve(openvdb::FloatGrid::Ptr in_out_presssure,
   float numax = tolerance * nu;
   numax = std::min(numax, 1e-7f);
 
+  m_stats.iterations = 0;
+  m_stats.residual = nu;
+
   // line3
   if (nu <= numax) {
     return true;
@@ -2598,6 +2761,8 @@ bool simd_vdb_poisson::pcg_solve(openvdb::FloatGrid::Ptr in_out_presssure,
     lv_axpy(-alpha, z, r);
     nu = lv_abs_max(r);
     printf("iter:%d err:%e\n", m_iteration, nu);
+    m_stats.iterations = m_iteration + 1;
+    m_stats.residual = nu;
     // line9
     if (nu <= numax || m_iteration == (m_max_iter - 1)) {
       // line10
@@ -2,6 +2,8 @@
 #include "Eigen/Eigen"
 #include "openvdb/openvdb.h"
 #include "openvdb/tree/LeafManager.h"
+#include <map>
+#include <set>
 struct alignas(32) simd_laplacian_apply_op;
 
 // use simd intrinsics to solve the poisson's equation
@@ -50,17 +52,29 @@ public:
     using Ptr = std::shared_ptr<Laplacian_with_level>;
     struct coarsening {};
     // constructor from liquid phi, vector face weights, dx, dt
+    // the leaves in clean_leaves copy their entries from previous instead of
+    // recomputing them, their inputs must be unchanged since previous was built
     Laplacian_with_level(openvdb::FloatGrid::Ptr in_liquid_phi,
                          openvdb::Vec3fGrid::Ptr in_face_weights,
-                         const float in_dt, const float in_dx);
+                         const float in_dt, const float in_dx,
+                         const Laplacian_with_level *previous = nullptr,
+                         const std::set<openvdb::Coord> *clean_leaves = nullptr);
 
     // construct the coarse level laplacian
-    Laplacian_with_level(const Laplacian_with_level &parent, coarsening);
+    // same_topology is a level of an earlier hierarchy whose finer levels had
+    // the same degree of freedom layout, its dof index tree is shared
+    Laplacian_with_level(const Laplacian_with_level &parent, coarsening,
+                         const Laplacian_with_level *same_topology = nullptr);
 
-    void initialize_entries_from_parent(const Laplacian_with_level &parent);
+    void initialize_entries_from_parent(
+        const Laplacian_with_level &parent,
+        const Laplacian_with_level *same_topology = nullptr);
 
-    void initialize_finest(openvdb::FloatGrid::Ptr in_liquid_phi,
-                           openvdb::Vec3fGrid::Ptr in_face_weights);
+    void initialize_finest(
+        openvdb::FloatGrid::Ptr in_liquid_phi,
+        openvdb::Vec3fGrid::Ptr in_face_weights,
+        const Laplacian_with_level *previous = nullptr,
+        const std::set<openvdb::Coord> *clean_leaves = nullptr);
 
     // it assumes the dof idx tree already has the same topology as the
     // full diagonal tree before trim happens
@@ -179,7 +193,29 @@ public:
   std::vector<openvdb::FloatGrid::Ptr> m_K_cycle_vs;
   std::vector<openvdb::FloatGrid::Ptr> m_K_cycle_ds;
   std::vector<openvdb::FloatGrid::Ptr> m_K_cycle_ws;
-  void construct_levels();
+  // per solve numbers, filled by construct_levels and pcg_solve
+  struct solve_stats {
+    int levels = 0;
+    int ndof = 0;
+    int iterations = 0;
+    float residual = 0;
+    size_t leaves = 0;
+    size_t reused_leaves = 0;
+    bool reused_topology = false;
+    double levels_ms = 0;
+    double coarsest_ms = 0;
+  };
+  solve_stats m_stats;
+
+  // previous is the solver of the last substep, or null to build everything
+  // from scratch: finest level leaves whose liquid phi and face weights
+  // (their own and their face neighbours') are unchanged keep their entries,
+  // and if the degree of freedom layout is unchanged the coarse levels keep
+  // their dof index trees and the coarsest solver its symbolic factorization
+  void construct_levels(const simd_vdb_poisson *previous = nullptr);
+  // drops the v cycle and k cycle scratch grids, what is left is what
+  // construct_levels reuses from a previous solver
+  void release_scratch();
   void Vcycle(const openvdb::FloatGrid::Ptr in_out_lhs,
               const openvdb::FloatGrid::Ptr in_rhs, int n1 = 1, int n2 = 2,
               int ncoarse = 40);
@@ -211,7 +247,8 @@ public:
   Eigen::VectorXf m_coarsest_eigen_rhs, m_coarsest_eigen_solution;
   std::shared_ptr<Eigen::SimplicialLDLT<Eigen::SparseMatrix<float>>>
       m_coarsest_solver;
-  void construct_coarsest_exact_solver();
+  void construct_coarsest_exact_solver(
+      const simd_vdb_poisson *same_topology = nullptr);
   void write_coarsest_eigen_rhs(Eigen::VectorXf &out_eigen_rhs,
                                 openvdb::FloatGrid::Ptr in_rhs);
   void write_coarsest_grid_solution(openvdb::FloatGrid::Ptr in_out_result,
@@ -250,4 +287,9 @@ private:
 
   float dt;
   float m_dx;
+
+  // hash of the liquid phi leaf and the face weights at the same origin,
+  // for every leaf of the liquid phi the finest level was built from
+  std::map<openvdb::Coord, uint64_t> m_leaf_input_hash;
+  void hash_leaf_inputs();
 };
\ No newline at end of file
@@ -6,10 +6,14 @@
 //#include <opensubdiv/far/stencilTableFactory.h>
 //#include <opensubdiv/osd/cpuEvaluator.h>
 //#include <opensubdiv/osd/cpuVertexBuffer.h>
+#include <zeno/funcs/PrimitiveAdjacency.h>
 #include <opensubdiv/far/topologyDescriptor.h>
 #include <opensubdiv/far/primvarRefiner.h>
+#include <opensubdiv/far/stencilTableFactory.h>
+#include <opensubdiv/osd/ompEvaluator.h>
 #include <cstring>
 #include <cstdio>
+#include <memory>
 
 namespace zeno {
 namespace {
@@ -127,20 +131,15 @@ namespace {
 }
 
 
-//------------------------------------------------------------------------------
-static void osdPrimSubdiv(PrimitiveObject *prim, int levels, std::string edgeCreaseAttr = {}, bool triangulate = false, bool asQuadFaces = false, bool hasLoopUVs = true) {
-    const int maxlevel=levels;
-    if (maxlevel <= 0 || !prim->verts.size()) return;
-
-    if (prim->loops.size() && prim->loop_uvs.size())
-        hasLoopUVs = false;
-
-        //nCoarseVerts=0,
-        //nRefinedVerts=0;
-    //std::vector<int> ncfaces(maxlevel);
-    //std::vector<int> ncedges(maxlevel);
+// face lists of a prim in the layout Far::TopologyDescriptor points into
+struct OSDTopology {
+    std::vector<int> polysInd, polysLen, uvsInd;
+    std::vector<Far::TopologyDescriptor::FVarChannel> channels;
+    Far::TopologyDescriptor desc;
+};
 
-    std::vector<int> polysInd, polysLen;
+static bool osdMakeTopology(PrimitiveObject *prim, OSDTopology &topo, std::string const &edgeCreaseAttr, bool hasLoopUVs) {
+    auto &polysInd = topo.polysInd, &polysLen = topo.polysLen;
     int primpolyreduced = 0;
     for (int i = 0; i < prim->polys.size(); i++) {
         auto [base, len] = prim->polys[i];
@@ -173,10 +172,10 @@ static void osdPrimSubdiv(PrimitiveObject *prim, int levels, std::string edgeCre
         offsetred += len;
     }
 
-    if (!polysLen.size() || !polysInd.size()) return;
+    if (!polysLen.size() || !polysInd.size()) return false;
 
 
-    Far::TopologyDescriptor desc;
+    auto &desc = topo.desc;
     desc.numVertices = prim->verts.size();
     desc.numFaces = polysLen.size();
     desc.numVertsPerFace = polysLen.data();
@@ -188,8 +187,8 @@ static void osdPrimSubdiv(PrimitiveObject *prim, int levels, std::string edgeCre
         desc.creaseWeights = crease.data();
     }
 
-    std::vector<Far::TopologyDescriptor::FVarChannel> channels;
-    std::vector<int> uvsInd;
+    auto &channels = topo.channels;
+    auto &uvsInd = topo.uvsInd;
     /*std::vector<std::string> chanveckeys;*/
     if (hasLoopUVs) {
 
@@ -229,16 +228,10 @@ static void osdPrimSubdiv(PrimitiveObject *prim, int levels, std::string edgeCre
         desc.numFVarChannels = channels.size();
         desc.fvarChannels = channels.data();
     }
-    
-        prim->points.clear();
-        prim->lines.clear();
-        prim->tris.clear();
-        prim->quads.clear();
-        prim->polys.clear();
-        prim->loops.clear();
-
-
+    return true;
+}
 
+static std::unique_ptr<Far::TopologyRefiner> osdRefineUniform(Far::TopologyDescriptor const &desc, int maxlevel, bool hasLoopUVs) {
     Sdc::SchemeType refinetfactype = OpenSubdiv::Sdc::SCHEME_CATMARK;
     Sdc::Options refineofactptions;
     refineofactptions.SetVtxBoundaryInterpolation(Sdc::Options::VTX_BOUNDARY_EDGE_ONLY);
@@ -255,6 +248,159 @@ static void osdPrimSubdiv(PrimitiveObject *prim, int levels, std::string edgeCre
         refineOptions.fullTopologyInLastLevel = hasLoopUVs;
         refiner->RefineUniform(refineOptions);
     }
+    return refiner;
+}
+
+static void osdClearFaces(PrimitiveObject *prim) {
+    prim->points.clear();
+    prim->lines.clear();
+    prim->tris.clear();
+    prim->quads.clear();
+    prim->polys.clear();
+    prim->loops.clear();
+}
+
+// vertex and uv indices of the quads at the highest level refined
+static void osdFineFaces(Far::TopologyRefiner const &refiner, int maxlevel, bool hasLoopUVs,
+                         std::vector<vec4i> &faceVerts, std::vector<vec4i> &faceFVars) {
+    Far::TopologyLevel const & refLastLevel = refiner.GetLevel(maxlevel);
+    int nfaces = refLastLevel.GetNumFaces();
+    faceVerts.resize(nfaces);
+    faceFVars.resize(hasLoopUVs ? nfaces : 0);
+    for (int face = 0; face < nfaces; ++face) {
+        Far::ConstIndexArray fverts = refLastLevel.GetFaceVertices(face);
+        // all refined Catmark faces should be quads
+        assert(fverts.size()==4);
+        faceVerts[face] = {fverts[0], fverts[1], fverts[2], fverts[3]};
+        if (hasLoopUVs) {
+            Far::ConstIndexArray fvars = refLastLevel.GetFaceFVarValues(face);
+            assert(fvars.size()==4);
+            faceFVars[face] = {fvars[0], fvars[1], fvars[2], fvars[3]};
+        }
+    }
+}
+
+static void osdWriteFineFaces(PrimitiveObject *prim, std::vector<vec4i> const &faceVerts, std::vector<vec4i> const &faceFVars,
+                              bool triangulate, bool asQuadFaces, bool hasLoopUVs) {
+    int nfaces = faceVerts.size();
+    if (triangulate) {
+        prim->tris.resize(nfaces * 2);
+        for (int face = 0; face < nfaces; ++face) {
+
+            auto const &fverts = faceVerts[face];
+
+            auto &reftri1 = prim->tris[face * 2];
+            auto &reftri2 = prim->tris[face * 2 + 1];
+            reftri1[0] = fverts[0];
+            reftri1[1] = fverts[1];
+            reftri1[2] = fverts[2];
+            reftri2[0] = fverts[0];
+            reftri2[1] = fverts[2];
+            reftri2[2] = fverts[3];
+
+            //printf("f ");
+            //for (int vert=0; vert<fverts.size(); ++vert) {
+                //printf("%d ", fverts[vert]+1); // OBJ uses 1-based arrays...
+            //}
+            //printf("\n");
+        }
+
+        if (hasLoopUVs) {  // very qianqiang uv0~2 for quads/tris, avoid use
+            auto &uv0 = prim->tris.add_attr<vec3f>("uv0");
+            auto &uv1 = prim->tris.add_attr<vec3f>("uv1");
+            auto &uv2 = prim->tris.add_attr<vec3f>("uv2");
+            for (int face = 0; face < nfaces; ++face) {
+                auto const &fvars = faceFVars[face];
+                uv0[face*2] = v2to3(prim->uvs[fvars[0]]);
+                uv1[face*2] = v2to3(prim->uvs[fvars[1]]);
+                uv2[face*2] = v2to3(prim->uvs[fvars[2]]);
+                uv0[face*2+1] = v2to3(prim->uvs[fvars[0]]);
+                uv1[face*2+1] = v2to3(prim->uvs[fvars[2]]);
+                uv2[face*2+1] = v2to3(prim->uvs[fvars[3]]);
+            }
+            prim->uvs.clear();
+        }
+
+    } else if (asQuadFaces) {
+
+        prim->quads.resize(nfaces);
+        for (int face = 0; face < nfaces; ++face) {
+
+            auto const &fverts = faceVerts[face];
+
+            auto &refquad = prim->quads[face];
+            refquad[0] = fverts[0];
+            refquad[1] = fverts[1];
+            refquad[2] = fverts[2];
+            refquad[3] = fverts[3];
+
+            //printf("f ");
+            //for (int vert=0; vert<fverts.size(); ++vert) {
+                //printf("%d ", fverts[vert]+1); // OBJ uses 1-based arrays...
+            //}
+            //printf("\n");
+        }
+
+        if (hasLoopUVs) {  // very qianqiang uv0~3 for quads/tris, avoid use
+            auto &uv0 = prim->quads.add_attr<vec3f>("uv0");
+            auto &uv1 = prim->quads.add_attr<vec3f>("uv1");
+            auto &uv2 = prim->quads.add_attr<vec3f>("uv2");
+            auto &uv3 = prim->quads.add_attr<vec3f>("uv3");
+            for (int face = 0; face < nfaces; ++face) {
+                auto const &fvars = faceFVars[face];
+                uv0[face] = v2to3(prim->uvs[fvars[0]]);
+                uv1[face] = v2to3(prim->uvs[fvars[1]]);
+                uv2[face] = v2to3(prim->uvs[fvars[2]]);
+                uv3[face] = v2to3(prim->uvs[fvars[3]]);
+            }
+            prim->uvs.clear();
+        }
+
+    } else {
+
+        prim->polys.resize(nfaces);
+        prim->loops.resize(nfaces * 4);
+
+        for (int face = 0; face < nfaces; ++face) {
+
+            auto const &fverts = faceVerts[face];
+
+            prim->loops[face*4+0] = fverts[0];
+            prim->loops[face*4+1] = fverts[1];
+            prim->loops[face*4+2] = fverts[2];
+            prim->loops[face*4+3] = fverts[3];
+            prim->polys[face] = {face * 4, 4};
+        }
+
+        if (hasLoopUVs) {
+            auto &loop_uvs = prim->loop_uvs;
+            loop_uvs.resize(nfaces * 4);
+
+            for (int face = 0; face < nfaces; ++face) {
+                auto const &fvars = faceFVars[face];
+                loop_uvs[face*4+0] = fvars[0];
+                loop_uvs[face*4+1] = fvars[1];
+                loop_uvs[face*4+2] = fvars[2];
+                loop_uvs[face*4+3] = fvars[3];
+            }
+        }
+
+    }
+}
+
+//------------------------------------------------------------------------------
+static void osdPrimSubdiv(PrimitiveObject *prim, int levels, std::string edgeCreaseAttr = {}, bool triangulate = false, bool asQuadFaces = false, bool hasLoopUVs = true) {
+    const int maxlevel=levels;
+    if (maxlevel <= 0 || !prim->verts.size()) return;
+
+    if (prim->loops.size() && prim->loop_uvs.size())
+        hasLoopUVs = false;
+
+    OSDTopology topo;
+    if (!osdMakeTopology(prim, topo, edgeCreaseAttr, hasLoopUVs)) return;
+    osdClearFaces(prim);
+
+    auto refiner = osdRefineUniform(topo.desc, maxlevel, hasLoopUVs);
 
     //// Allocate a buffer for vertex primvar data. The buffer length is set to
     //// be the sum of all children vertices up to the highest level of refinement.
@@ -410,7 +556,6 @@ static void osdPrimSubdiv(PrimitiveObject *prim, int levels, std::string edgeCre
         Far::TopologyLevel const & refLastLevel = refiner->GetLevel(maxlevel);
 
         int nverts = refLastLevel.GetNumVertices();
-        int nfaces = refLastLevel.GetNumFaces();
 
         //std::vector<int> nfvverts;
         int nfvars{};
@@ -457,121 +602,9 @@ static void osdPrimSubdiv(PrimitiveObject *prim, int levels, std::string edgeCre
         //prim->polys.clear();
         //prim->loops.clear();
         // Print faces
-        if (triangulate) {
-            prim->tris.resize(nfaces * 2);
-            for (int face = 0; face < nfaces; ++face) {
-
-                Far::ConstIndexArray fverts = refLastLevel.GetFaceVertices(face);
-
-                // all refined Catmark faces should be quads
-                assert(fverts.size()==4);
-
-                auto &reftri1 = prim->tris[face * 2];
-                auto &reftri2 = prim->tris[face * 2 + 1];
-                reftri1[0] = fverts[0];
-                reftri1[1] = fverts[1];
-                reftri1[2] = fverts[2];
-                reftri2[0] = fverts[0];
-                reftri2[1] = fverts[2];
-                reftri2[2] = fverts[3];
-
-                //printf("f ");
-                //for (int vert=0; vert<fverts.size(); ++vert) {
-                    //printf("%d ", fverts[vert]+1); // OBJ uses 1-based arrays...
-                //}
-                //printf("\n");
-            }
-
-            if (hasLoopUVs) {  // very qianqiang uv0~2 for quads/tris, avoid use
-                auto &uv0 = prim->tris.add_attr<vec3f>("uv0");
-                auto &uv1 = prim->tris.add_attr<vec3f>("uv1");
-                auto &uv2 = prim->tris.add_attr<vec3f>("uv2");
-                for (int face = 0; face < nfaces; ++face) {
-                    Far::ConstIndexArray fvars = refLastLevel.GetFaceFVarValues(face);
-                    assert(fvars.size() == 4);
-                    uv0[face*2] = v2to3(prim->uvs[fvars[0]]);
-                    uv1[face*2] = v2to3(prim->uvs[fvars[1]]);
-                    uv2[face*2] = v2to3(prim->uvs[fvars[2]]);
-                    uv0[face*2+1] = v2to3(prim->uvs[fvars[0]]);
-                    uv1[face*2+1] = v2to3(prim->uvs[fvars[2]]);
-                    uv2[face*2+1] = v2to3(prim->uvs[fvars[3]]);
-                }
-                prim->uvs.clear();
-            }
-
-        } else if (asQuadFaces) {
-
-            prim->quads.resize(nfaces);
-            for (int face = 0; face < nfaces; ++face) {
-
-                Far::ConstIndexArray fverts = refLastLevel.GetFaceVertices(face);
-
-                // all refined Catmark faces should be quads
-                assert(fverts.size()==4);
-
-                auto &refquad = prim->quads[face];
-                refquad[0] = fverts[0];
-                refquad[1] = fverts[1];
-                refquad[2] = fverts[2];
-                refquad[3] = fverts[3];
-
-                //printf("f ");
-                //for (int vert=0; vert<fverts.size(); ++vert) {
-                    //printf("%d ", fverts[vert]+1); // OBJ uses 1-based arrays...
-                //}
-                //printf("\n");
-            }
-
-            if (hasLoopUVs) {  // very qianqiang uv0~3 for quads/tris, avoid use
-                auto &uv0 = prim->quads.add_attr<vec3f>("uv0");
-                auto &uv1 = prim->quads.add_attr<vec3f>("uv1");
-                auto &uv2 = prim->quads.add_attr<vec3f>("uv2");
-                auto &uv3 = prim->quads.add_attr<vec3f>("uv3");
-                for (int face = 0; face < nfaces; ++face) {
-                    Far::ConstIndexArray fvars = refLastLevel.GetFaceFVarValues(face);
-                    assert(fvars.size() == 4);
-                    uv0[face] = v2to3(prim->uvs[fvars[0]]);
-                    uv1[face] = v2to3(prim->uvs[fvars[1]]);
-                    uv2[face] = v2to3(prim->uvs[fvars[2]]);
-                    uv3[face] = v2to3(prim->uvs[fvars[3]]);
-                }
-                prim->uvs.clear();
-            }
-
-        } else {
-
-            prim->polys.resize(nfaces);
-            prim->loops.resize(nfaces * 4);
-
-            for (int face = 0; face < nfaces; ++face) {
-
-                Far::ConstIndexArray fverts = refLastLevel.GetFaceVertices(face);
-
-                // all refined Catmark faces should be quads
-                assert(fverts.size()==4);
-
-                prim->loops[face*4+0] = fverts[0];
-                prim->loops[face*4+1] = fverts[1];
-                prim->loops[face*4+2] = fverts[2];
-                prim->loops[face*4+3] = fverts[3];
-                prim->polys[face] = {face * 4, 4};
-            }
-
-            if (hasLoopUVs) {
-                auto &loop_uvs = prim->loop_uvs;
-                loop_uvs.resize(nfaces * 4);
-
-                for (int face = 0; face < nfaces; ++face) {
-                    Far::ConstIndexArray fvars = refLastLevel.GetFaceFVarValues(face);
-                    assert(fvars.size()==4);
-                    loop_uvs[face*4+0] = fvars[0];
-                    loop_uvs[face*4+1] = fvars[1];
-                    loop_uvs[face*4+2] = fvars[2];
-                    loop_uvs[face*4+3] = fvars[3];
-                }
-            }
-
-        }
+        std::vector<vec4i> faceVerts, faceFVars;
+        osdFineFaces(*refiner, maxlevel, hasLoopUVs, faceVerts, faceFVars);
+        osdWriteFineFaces(prim, faceVerts, faceFVars, triangulate, asQuadFaces, hasLoopUVs);
 
     }
 
@@ -595,7 +628,108 @@ static void osdPrimSubdiv(PrimitiveObject *prim, int levels, std::string edgeCre
     //delete vbuffer;
 }
 
+// stencil tables of one topology, refined once and then reapplied to the vertex
+// data of every frame as long as only the positions and attributes change
+struct OSDStencilCache {
+    bool valid = false;
+    uint64_t key = 0;
+    std::unique_ptr<Far::StencilTable const> vertexStencils;
+    std::unique_ptr<Far::StencilTable const> varyingStencils;
+    std::unique_ptr<Far::StencilTable const> fvarStencils;
+    std::vector<vec4i> faceVerts, faceFVars;
+};
+
+static uint64_t osdCacheKey(PrimitiveObject *prim, int levels, std::string const &edgeCreaseAttr, bool hasLoopUVs) {
+    uint64_t h = primTopologyHash(prim);
+    auto mix = [&] (void const *data, size_t nbytes) {
+        auto p = static_cast<unsigned char const *>(data);
+        for (size_t i = 0; i < nbytes; i++)
+            h = (h ^ p[i]) * 0x100000001b3ull;
+    };
+    int flags[3] = {levels, (int)hasLoopUVs, (int)prim->uvs.size()};
+    mix(flags, sizeof(flags));
+    mix(edgeCreaseAttr.data(), edgeCreaseAttr.size());
+    if (edgeCreaseAttr.size()) {
+        auto const &crease = prim->lines.attr<float>(edgeCreaseAttr);
+        mix(crease.data(), crease.size() * sizeof(float));
+    }
+    if (hasLoopUVs)
+        mix(prim->loop_uvs.data(), prim->loop_uvs.size() * sizeof(int));
+    return h;
+}
+
+static void osdEvalStencils(Far::StencilTable const &table, float const *src, float *dst, int width) {
+    Osd::BufferDescriptor desc(0, width, width);
+    Osd::OmpEvaluator::EvalStencils(src, desc, dst, desc,
+                                    table.GetSizes().data(), table.GetOffsets().data(),
+                                    table.GetControlIndices().data(), table.GetWeights().data(),
+                                    0, table.GetNumStencils());
+}
+
+// same result as osdPrimSubdiv, but the refiner only runs when the topology changes,
+// every other frame is a few sparse matrix products evaluated in parallel
+static void osdPrimSubdivCached(PrimitiveObject *prim, OSDStencilCache &cache, int levels, std::string const &edgeCreaseAttr,
+                                bool triangulate, bool asQuadFaces, bool hasLoopUVs) {
+    const int maxlevel=levels;
+    if (maxlevel <= 0 || !prim->verts.size()) return;
+
+    if (prim->loops.size() && prim->loop_uvs.size())
+        hasLoopUVs = false;
+
+    auto key = osdCacheKey(prim, maxlevel, edgeCreaseAttr, hasLoopUVs);
+    if (!cache.valid || cache.key != key) {
+        cache.valid = false;
+        OSDTopology topo;
+        if (!osdMakeTopology(prim, topo, edgeCreaseAttr, hasLoopUVs)) return;
+        auto refiner = osdRefineUniform(topo.desc, maxlevel, hasLoopUVs);
+
+        Far::StencilTableFactory::Options options;
+        options.generateIntermediateLevels = false;
+        options.generateOffsets = true;
+        options.interpolationMode = Far::StencilTableFactory::INTERPOLATE_VERTEX;
+        cache.vertexStencils.reset(Far::StencilTableFactory::Create(*refiner, options));
+        options.interpolationMode = Far::StencilTableFactory::INTERPOLATE_VARYING;
+        cache.varyingStencils.reset(Far::StencilTableFactory::Create(*refiner, options));
+        cache.fvarStencils.reset();
+        if (hasLoopUVs) {
+            options.interpolationMode = Far::StencilTableFactory::INTERPOLATE_FACE_VARYING;
+            options.fvarChannel = 0;
+            cache.fvarStencils.reset(Far::StencilTableFactory::Create(*refiner, options));
+        }
+        osdFineFaces(*refiner, maxlevel, hasLoopUVs, cache.faceVerts, cache.faceFVars);
+        cache.key = key;
+        cache.valid = true;
+        log_debug("OSDPrimSubdiv: rebuilt stencils, {} coarse verts -> {} fine verts",
+                  prim->verts.size(), cache.vertexStencils->GetNumStencils());
+    }
+    osdClearFaces(prim);
+
+    AttrVector<vec3f> fine_verts(cache.vertexStencils->GetNumStencils());
+    osdEvalStencils(*cache.vertexStencils, reinterpret_cast<float const *>(prim->verts.data()),
+                    reinterpret_cast<float *>(fine_verts.data()), 3);
+    prim->verts.foreach_attr([&] (auto const &key, auto const &arr) {
+        using T = std::decay_t<decltype(arr[0])>;
+        auto &fine_arr = fine_verts.add_attr<T>(key);
+        osdEvalStencils(*cache.varyingStencils, reinterpret_cast<float const *>(arr.data()),
+                        reinterpret_cast<float *>(fine_arr.data()), sizeof(T) / sizeof(float));
+    });
+    std::swap(prim->verts, fine_verts);
+
+    if (hasLoopUVs) {
+        AttrVector<vec2f> fine_uvs(cache.fvarStencils->GetNumStencils());
+        if (prim->uvs.size()) {
+            osdEvalStencils(*cache.fvarStencils, reinterpret_cast<float const *>(prim->uvs.data()),
+                            reinterpret_cast<float *>(fine_uvs.data()), 2);
+        }
+        std::swap(prim->uvs, fine_uvs);
+    }
+
+    osdWriteFineFaces(prim, cache.faceVerts, cache.faceFVars, triangulate, asQuadFaces, hasLoopUVs);
+}
+
 struct OSDPrimSubdiv : INode {
+    OSDStencilCache stencilCache;
+
     virtual void apply() override {
         auto prim = get_input<PrimitiveObject>("prim");
         int levels = get_input2<int>("levels");
@@ -603,8 +737,11 @@ struct OSDPrimSubdiv : INode {
         bool triangulate = get_input2<bool>("triangulate");
         bool asQuadFaces = get_input2<bool>("asQuadFaces");
         bool hasLoopUVs = get_input2<bool>("hasLoopUVs");
-        if (levels) osdPrimSubdiv(prim.get(), levels, edgeCreaseAttr, triangulate,
-                                  asQuadFaces, hasLoopUVs);
+        bool cacheTopology = get_input2<bool>("cacheTopology");
+        if (levels && cacheTopology) osdPrimSubdivCached(prim.get(), stencilCache, levels, edgeCreaseAttr,
+                                                         triangulate, asQuadFaces, hasLoopUVs);
+        else if (levels) osdPrimSubdiv(prim.get(), levels, edgeCreaseAttr, triangulate,
+                                       asQuadFaces, hasLoopUVs);
         set_output("prim", std::move(prim));
     }
 };
@@ -616,6 +753,7 @@ ZENO_DEFNODE(OSDPrimSubdiv)({
         {"bool", "triangulate", "1"},
         {"bool", "asQuadFaces", "1"},
         {"bool", "hasLoopUVs", "1"},
+        {"bool", "cacheTopology", "0"},
     },
     {
         "prim",
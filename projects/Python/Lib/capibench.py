@@ -0,0 +1,61 @@
+# -*- coding: utf-8 -*-
+# type: ignore
+# measures per-call overhead of the C API handle table, run from a PythonScript node
+
+import ze
+import time
+import ctypes
+
+api = ze.api
+n = 100000
+
+
+def bench(name, count, func):
+    t0 = time.perf_counter()
+    func()
+    dt = time.perf_counter() - t0
+    print('{:<32} {:10.1f} ns/call'.format(name, dt * 1e9 / count))
+
+
+def create_destroy():
+    obj_ = ctypes.c_uint64(0)
+    val_ = ctypes.c_float(1.0)
+    one_ = ctypes.c_size_t(1)
+    for i in range(n):
+        api.Zeno_CreateObjectFloat(ctypes.pointer(obj_), ctypes.pointer(val_), one_)
+        api.Zeno_DestroyObject(obj_)
+
+bench('create+destroy float', n, create_destroy)
+
+
+obj_ = ctypes.c_uint64(0)
+api.Zeno_CreateObjectFloat(ctypes.pointer(obj_), ctypes.pointer(ctypes.c_float(1.0)), ctypes.c_size_t(1))
+
+def get_float():
+    val_ = ctypes.c_float(0)
+    one_ = ctypes.c_size_t(1)
+    for i in range(n):
+        api.Zeno_GetObjectFloat(obj_, ctypes.pointer(val_), one_)
+
+bench('get float', n, get_float)
+api.Zeno_DestroyObject(obj_)
+
+
+m = 1000
+prims_ = (ctypes.c_uint64 * m)()
+ptrs_ = (ctypes.c_void_p * m)()
+lens_ = (ctypes.c_size_t * m)()
+types_ = (ctypes.c_int * m)()
+
+bench('create prims (batched)', m, lambda: api.Zeno_CreateObjectPrimitives(prims_, ctypes.c_size_t(m)))
+
+def get_prim_data():
+    ptr_ = ctypes.c_void_p()
+    len_ = ctypes.c_size_t()
+    type_ = ctypes.c_int()
+    for i in range(m):
+        api.Zeno_GetObjectPrimData(ctypes.c_uint64(prims_[i]), ctypes.c_int(0), b'pos', ctypes.pointer(ptr_), ctypes.pointer(len_), ctypes.pointer(type_))
+
+bench('get prim data', m, get_prim_data)
+bench('get prim data (batched)', m, lambda: api.Zeno_GetObjectsPrimData(prims_, ctypes.c_size_t(m), ctypes.c_int(0), b'pos', ptrs_, lens_, types_))
+bench('destroy prims (batched)', m, lambda: api.Zeno_DestroyObjects(prims_, ctypes.c_size_t(m)))
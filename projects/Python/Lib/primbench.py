@@ -0,0 +1,46 @@
+# -*- coding: utf-8 -*-
+# type: ignore
+# round-trips a large primitive between zeno and numpy, run from a PythonScript node
+
+import ze
+import time
+import numpy as np
+
+n = 10000000
+
+
+def bench(name, func):
+    t0 = time.perf_counter()
+    ret = func()
+    print('{:<36} {:10.2f} ms'.format(name, (time.perf_counter() - t0) * 1e3))
+    return ret
+
+
+prim = ze.ZenoPrimitiveObject.new()
+bench('resize verts to {}'.format(n), lambda: prim.verts.resize(n))
+clr = bench('add_attr clr', lambda: prim.verts.add_attr('clr', (float, 3)))
+
+pos = bench('view pos as numpy (zero-copy)', lambda: prim.verts.numpy('pos'))
+assert pos.shape == (n, 3) and pos.dtype == np.float32
+bench('fill pos in numpy', lambda: pos.__setitem__(slice(None), np.random.rand(n, 3).astype(np.float32)))
+bench('write clr from numpy', lambda: clr.from_numpy(pos * 0.5))
+
+before = pos[:, 0].copy()
+out = bench('PrimTranslate in zeno', lambda: ze.no.PrimTranslate(prim=prim, offset=[1, 0, 0]).prim.asPrim())
+res = bench('view result as numpy (zero-copy)', lambda: out.verts.numpy('pos'))
+assert np.allclose(res[:, 0], before + 1)
+
+m = 100000
+small = ze.ZenoPrimitiveObject.new()
+small.verts.resize(m)
+bench('to_list of {} verts (copying)'.format(m), lambda: small.verts.pos.to_list())
+
+# the views above pin the memory, so resizing has to wait until they are gone
+try:
+    prim.verts.resize(n // 2)
+except BufferError:
+    pass
+else:
+    assert False, 'resize must refuse while numpy views exist'
+del pos, res
+bench('resize after dropping the views', lambda: prim.verts.resize(n // 2))
@@ -5,6 +5,7 @@ Zeno Python API module
 
 import ctypes
 import functools
+import weakref
 from typing import Union, Optional, Any, Iterator, Iterable, Callable
 from types import MappingProxyType
 
@@ -48,13 +49,16 @@ def initDLLPath(path: str):
     define(ctypes.c_uint32, 'Zeno_CreateObjectFloat', ctypes.POINTER(ctypes.c_uint64), ctypes.POINTER(ctypes.c_float), ctypes.c_size_t)
     define(ctypes.c_uint32, 'Zeno_CreateObjectString', ctypes.POINTER(ctypes.c_uint64), ctypes.POINTER(ctypes.c_char), ctypes.c_size_t)
     define(ctypes.c_uint32, 'Zeno_CreateObjectPrimitive', ctypes.POINTER(ctypes.c_uint64))
+    define(ctypes.c_uint32, 'Zeno_CreateObjectPrimitives', ctypes.POINTER(ctypes.c_uint64), ctypes.c_size_t)
     define(ctypes.c_uint32, 'Zeno_DestroyObject', ctypes.c_uint64)
+    define(ctypes.c_uint32, 'Zeno_DestroyObjects', ctypes.POINTER(ctypes.c_uint64), ctypes.c_size_t)
     define(ctypes.c_uint32, 'Zeno_ObjectIncReference', ctypes.c_uint64)
     define(ctypes.c_uint32, 'Zeno_GetObjectLiterialType', ctypes.c_uint64, ctypes.POINTER(ctypes.c_int))
     define(ctypes.c_uint32, 'Zeno_GetObjectInt', ctypes.c_uint64, ctypes.POINTER(ctypes.c_int), ctypes.c_size_t)
     define(ctypes.c_uint32, 'Zeno_GetObjectFloat', ctypes.c_uint64, ctypes.POINTER(ctypes.c_float), ctypes.c_size_t)
     define(ctypes.c_uint32, 'Zeno_GetObjectString', ctypes.c_uint64, ctypes.POINTER(ctypes.c_char), ctypes.POINTER(ctypes.c_size_t))
     define(ctypes.c_uint32, 'Zeno_GetObjectPrimData', ctypes.c_uint64, ctypes.c_int, ctypes.c_char_p, ctypes.POINTER(ctypes.c_void_p), ctypes.POINTER(ctypes.c_size_t), ctypes.POINTER(ctypes.c_int))
+    define(ctypes.c_uint32, 'Zeno_GetObjectsPrimData', ctypes.POINTER(ctypes.c_uint64), ctypes.c_size_t, ctypes.c_int, ctypes.c_char_p, ctypes.POINTER(ctypes.c_void_p), ctypes.POINTER(ctypes.c_size_t), ctypes.POINTER(ctypes.c_int))
 # ZENO_CAPI Zeno_Error Zeno_AddObjectPrimAttr(Zeno_Object object_, Zeno_PrimMembType primArrType_, const char *attrName_, Zeno_PrimDataType dataType_) ZENO_CAPI_NOEXCEPT;
     define(ctypes.c_uint32, 'Zeno_AddObjectPrimAttr', ctypes.c_uint64, ctypes.c_int, ctypes.c_char_p, ctypes.c_int)
     define(ctypes.c_uint32, 'Zeno_GetObjectPrimDataKeys', ctypes.c_uint64, ctypes.c_int, ctypes.POINTER(ctypes.c_size_t), ctypes.POINTER(ctypes.c_char_p))
@@ -317,7 +321,7 @@ class _MappingProxyWrapper:
 
 class ZenoPrimitiveObject(ZenoObject):
     def _getArray(self, kind: int):
-        return _AttrVectorWrapper(self._handle, kind)
+        return _AttrVectorWrapper(self, kind)
 
     def __repr__(self) -> str:
         return '[zeno primitive at {}]'.format(self._handle)
@@ -347,11 +351,11 @@ class ZenoPrimitiveObject(ZenoObject):
         return self._getArray(4)
 
     @property
-    def polys(self):
+    def loops(self):
         return self._getArray(5)
 
     @property
-    def loops(self):
+    def polys(self):
         return self._getArray(6)
 
     @property
@@ -366,28 +370,85 @@ class ZenoPrimitiveObject(ZenoObject):
         return ZenoObject.fromHandle(self._handle)
 
 
+# per (primitive handle, member kind): the spans whose memory was handed to numpy or
+# memoryview and are still referenced by such a view, and how often it was resized
+_spanExports: dict[tuple[int, int], 'weakref.WeakSet[_MemSpanWrapper]'] = {}
+_spanGenerations: dict[tuple[int, int], int] = {}
+
+
 class _MemSpanWrapper:
     _ptr: int
     _len: int
     _type: Any
     _dim: int
+    _owner: Any
+    _key: Optional[tuple[int, int]]
+    _generation: int
+
+    _typestrLut = {
+        ctypes.c_float: '<f4',
+        ctypes.c_int: '<i4',
+    }
 
-    def __init__(self, ptr_: int, len_: int, type_: Any, dim_: int):
+    def __init__(self, ptr_: int, len_: int, type_: Any, dim_: int, owner_: Any = None, key_: Optional[tuple[int, int]] = None):
         self._ptr = ptr_
         self._len = len_
         self._type = type_
         self._dim = dim_
+        self._owner = owner_  # keeps the primitive alive while views of its memory exist
+        self._key = key_
+        self._generation = _spanGenerations.get(key_, 0) if key_ is not None else 0
+
+    def _checkValid(self):
+        if self._key is not None and _spanGenerations.get(self._key, 0) != self._generation:
+            raise BufferError('attribute was resized after this span was taken, fetch it again')
+
+    def _export(self):
+        # resize() refuses to run while the span is kept alive by a view of it
+        self._checkValid()
+        if self._key is not None:
+            _spanExports.setdefault(self._key, weakref.WeakSet()).add(self)
+
+    @property
+    def __array_interface__(self) -> dict[str, Any]:
+        # zero-copy view for numpy.asarray, vec3f becomes a (N, 3) float32 array;
+        # the array keeps this span and the primitive alive, and the primitive
+        # can't be resized from here until the array is gone
+        self._export()
+        shape = (self._len, self._dim) if self._dim != 1 else (self._len,)
+        return {
+            'version': 3,
+            'shape': shape,
+            'typestr': self._typestrLut[self._type],
+            'data': (self._ptr or 0, False),
+        }
+
+    def to_numpy(self):
+        import numpy
+        return numpy.asarray(self)
+
+    def memoryview(self) -> memoryview:
+        count = self._len * self._dim
+        if count == 0:
+            return memoryview(b'').cast(self._type._type_)
+        self._export()
+        arr = (self._type * count).from_address(self._ptr)
+        arr._owner = self
+        view = memoryview(arr).cast('B')
+        return view.cast(self._type._type_, (self._len, self._dim)) if self._dim != 1 else view.cast(self._type._type_)
 
     def __repr__(self) -> str:
         return '[zeno attribute at {} of len {} with type {} and dim {}]'.format(self._ptr, self._len, self._type, self._dim)
 
     def __getitem__(self, index: int) -> Numeric:
+        self._checkValid()
         if index < 0 or index >= self._len:
             raise IndexError('index {} out of range [0, {})'.format(index, self._len))
         base = ctypes.cast(self._ptr, ctypes.POINTER(self._type))
         return [base[index * self._dim + i] for i in range(self._dim)] if self._dim != 1 else base[index]
 
     def __setitem__(self, index: int, value: Numeric):
+        self._checkValid()
         if index < 0 or index >= self._len:
             raise IndexError('index {} out of range [0, {})'.format(index, self._len))
         base = ctypes.cast(self._ptr, ctypes.POINTER(self._type))
@@ -398,6 +459,7 @@ class _MemSpanWrapper:
             base[index] = value
 
     def to_list(self) -> list[Numeric]:
+        self._checkValid()
         base = ctypes.cast(self._ptr, ctypes.POINTER(self._type))
         if self._dim != 1:
             return [[base[index * self._dim + i] for i in range(self._dim)] for index in range(self._len)]
@@ -406,7 +468,11 @@ class _MemSpanWrapper:
 
     def from_list(self, lst: list[Numeric]):
         if len(lst) != self._len:
-            raise ValueError('list length mismatch {} != {}', len(lst), self._len)
+            raise ValueError('list length mismatch {} != {}'.format(len(lst), self._len))
+        if hasattr(lst, '__array_interface__'):
+            self.from_numpy(lst)
+            return
+        self._checkValid()
         base = ctypes.cast(self._ptr, ctypes.POINTER(self._type))
         if self._dim != 1:
             for index, val in enumerate(lst):
@@ -416,6 +482,15 @@ class _MemSpanWrapper:
             for index, val in enumerate(lst):
                 base[index] = val
 
+    def from_numpy(self, arr):
+        import numpy
+        self._checkValid()
+        arr = numpy.ascontiguousarray(arr, dtype=self._typestrLut[self._type])
+        if arr.size != self._len * self._dim:
+            raise ValueError('array size mismatch {} != {}'.format(arr.size, self._len * self._dim))
+        if arr.size:
+            ctypes.memmove(self._ptr, arr.ctypes.data, arr.nbytes)
+
     def raw_data(self) -> tuple[int, int, Any, int]:
         return (self._ptr, self._len, self._type, self._dim)
 
@@ -432,6 +507,7 @@ class _MemSpanWrapper:
 class _AttrVectorWrapper:
     _handle: int
     _kind: int
+    _owner: ZenoObject
 
     _typeLut = [
         ctypes.c_float,
@@ -457,11 +533,13 @@ class _AttrVectorWrapper:
         (int, 4): 7,
     }
 
-    def __init__(self, handle: int, kind: int):
-        self._handle = handle
+    def __init__(self, owner: ZenoObject, kind: int):
+        self._handle = owner.toHandle()
         self._kind = kind
+        self._owner = owner
 
     def add_attr(self, attrName: str, dataType: tuple[type, int]):
+        # the attributes live in a std::map, adding one leaves the others where they are
         dataTypeInd = self._typeUnlut[dataType]
         api.Zeno_AddObjectPrimAttr(ctypes.c_uint64(self._handle), ctypes.c_int(self._kind), ctypes.c_char_p(attrName.encode()), ctypes.c_int(dataTypeInd))
         return self.attr(attrName)
@@ -471,7 +549,7 @@ class _AttrVectorWrapper:
         lenRet_ = ctypes.c_size_t()
         typeRet_ = ctypes.c_int()
         api.Zeno_GetObjectPrimData(ctypes.c_uint64(self._handle), ctypes.c_int(self._kind), ctypes.c_char_p(attrName.encode()), ctypes.pointer(ptrRet_), ctypes.pointer(lenRet_), ctypes.pointer(typeRet_))
-        return _MemSpanWrapper(ptrRet_.value, lenRet_.value, self._typeLut[typeRet_.value], self._dimLut[typeRet_.value])  # type: ignore
+        return _MemSpanWrapper(ptrRet_.value, lenRet_.value, self._typeLut[typeRet_.value], self._dimLut[typeRet_.value], self._owner, (self._handle, self._kind))  # type: ignore
 
     def keys(self) -> list[str]:
         count_ = ctypes.c_size_t(0)
@@ -510,7 +588,17 @@ class _AttrVectorWrapper:
         return lenRet_.value
 
     def resize(self, newSize: int):
+        # resizing reallocates every attribute of this member on the C++ side, which would
+        # leave numpy arrays and memoryviews of them dangling, like bytearray it refuses to
+        # while such views exist; spans taken before must be fetched again afterwards
+        key = (self._handle, self._kind)
+        if _spanExports.get(key):
+            raise BufferError('{} numpy or memoryview exports of this primitive are alive, delete them before resize'.format(len(_spanExports[key])))
         api.Zeno_ResizeObjectPrimData(ctypes.c_uint64(self._handle), ctypes.c_int(self._kind), ctypes.c_size_t(newSize))
+        _spanGenerations[key] = _spanGenerations.get(key, 0) + 1
+
+    def numpy(self, attrName: str = 'pos'):
+        return self.attr(attrName).to_numpy()
 
 
 class ZenoGraph:
@@ -90,8 +90,15 @@ struct PythonFunctor {
         scope_exit pyKwargsDel = [=] {
             Py_DECREF(pyKwargs);
         };
+        std::vector<Zeno_Object> needToDel;
+        scope_exit needToDelEraser = [&] {
+            for (auto handle: needToDel) {
+                capiEraseObjectSharedPtr(handle);
+            }
+        };
         for (auto const &[key, val]: args) {
             Zeno_Object handle = capiLoadObjectSharedPtr(val);
+            needToDel.push_back(handle);
             auto valLong = PyLong_FromUnsignedLongLong(handle);
             scope_exit valLongDel = [=] {
                 Py_DECREF(valLong);
@@ -254,9 +261,10 @@ struct PythonScript : INode {
             throw makeError("failed to set ze._args");
         std::shared_ptr<Graph> currGraphSP = getThisGraph()->shared_from_this();  // TODO
         Zeno_Graph currGraphHandle = capiLoadGraphSharedPtr(currGraphSP);
-        //scope_exit currGraphEraser = [=] {
-            //capiEraseGraphSharedPtr(currGraphHandle);
-        //};
+        // every load takes its own slot, so it has to be given back once the script is done
+        scope_exit currGraphEraser = [=] {
+            capiEraseGraphSharedPtr(currGraphHandle);
+        };
         {
             PyObject *currGraphLong = PyLong_FromUnsignedLongLong(currGraphHandle);
             scope_exit currGraphLongDel = [=] {
@@ -265,13 +273,13 @@ struct PythonScript : INode {
             if (PyDict_SetItemString(zenoModDict, "_currgraph", currGraphLong) < 0)
                 throw makeError("failed to set ze._currgraph");
         }
-        //scope_exit currGraphLongReset = [=] {
-            //PyObject *currGraphLongZero = PyLong_FromUnsignedLongLong(0);
-            //scope_exit currGraphLongZeroDel = [=] {
-                //Py_DECREF(currGraphLongZero);
-            //};
-            //(void)PyDict_SetItemString(zenoModDict, "_currgraph", currGraphLongZero);
-        //};
+        scope_exit currGraphLongReset = [=] {
+            PyObject *currGraphLongZero = PyLong_FromUnsignedLongLong(0);
+            scope_exit currGraphLongZeroDel = [=] {
+                Py_DECREF(currGraphLongZero);
+            };
+            (void)PyDict_SetItemString(zenoModDict, "_currgraph", currGraphLongZero);
+        };
         if (path.empty()) {
             auto code = get_input2<std::string>("code");
             mainMod = PyRun_StringFlags(code.c_str(), Py_file_input, globals, globals, NULL);
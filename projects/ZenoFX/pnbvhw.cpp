@@ -1,4 +1,5 @@
 #include "LinearBvh.h"
+#include <zeno/types/BvhObject.h>
 #include <zeno/zeno.h>
 #include <zeno/types/StringObject.h>
 #include <zeno/types/PrimitiveObject.h>
@@ -147,9 +148,69 @@ struct QueryNearestPrimitive : zeno::INode {
     int pid;
     bool operator<(const KVPair &o) const noexcept { return dist < o.dist; }
   };
+  // same query on the triangle BvhObject built by PrimBuildBvh
+  void applyBvhObject() {
+    using namespace zeno;
+
+    auto bvh = get_input<BvhObject>("lbvh");
+    auto line = std::make_shared<PrimitiveObject>();
+
+    int pid = 0;
+    BvhObject::NearestHit best;
+    if (has_input<PrimitiveObject>("prim")) {
+      auto prim = get_input<PrimitiveObject>("prim");
+
+      auto idTag = get_input2<std::string>("idTag");
+      auto distTag = get_input2<std::string>("distTag");
+      auto weightTag = get_input2<std::string>("weightTag");
+
+      auto &bvhids = prim->add_attr<float>(idTag);
+      auto &dists = prim->add_attr<float>(distTag);
+      auto &ws = prim->add_attr<zeno::vec3f>(weightTag);
+
+      std::vector<BvhObject::NearestHit> hits(prim->size());
+      bvh->nearestBatch(prim->verts.data(), hits.data(), hits.size());
+      for (int i = 0; i < hits.size(); ++i) {
+        bvhids[i] = hits[i].primId;
+        dists[i] = hits[i].dist;
+        ws[i] = hits[i].bary;
+        if (hits[i].dist < best.dist)
+          best = hits[i], pid = i;
+      }
+      line->verts.push_back(prim->verts[pid]);
+    } else if (has_input<NumericObject>("prim")) {
+      auto p = get_input<NumericObject>("prim")->get<vec3f>();
+      best = bvh->nearest(p);
+      line->verts.push_back(p);
+    } else
+      throw std::runtime_error("unknown primitive kind (only supports "
+                               "PrimitiveObject and NumericObject::vec3f).");
+
+    line->verts.push_back(best.pos);
+    line->lines.push_back({0, 1});
+
+    auto tri = std::make_shared<PrimitiveObject>();
+    if (best.primId >= 0) {
+      auto k = bvh->triOrder[best.primId];
+      tri->verts.push_back(bvh->triV0[k]);
+      tri->verts.push_back(bvh->triV0[k] + bvh->triE1[k]);
+      tri->verts.push_back(bvh->triV0[k] + bvh->triE2[k]);
+      tri->tris.push_back({0, 1, 2});
+    }
+
+    set_output("primid", std::make_shared<NumericObject>(pid));
+    set_output("bvh_primid", std::make_shared<NumericObject>(best.primId));
+    set_output("dist", std::make_shared<NumericObject>(best.dist));
+    set_output("bvh_prim", std::move(tri));
+    set_output("segment", std::move(line));
+  }
+
   virtual void apply() override {
     using namespace zeno;
 
+    if (has_input<BvhObject>("lbvh"))
+      return applyBvhObject();
+
     auto lbvh = get_input<LBvh>("lbvh");
     auto line = std::make_shared<PrimitiveObject>();
 
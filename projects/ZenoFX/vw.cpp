@@ -214,6 +214,7 @@ struct VDBWrangle : zeno::INode {
             (get_input<zeno::StringObject>("ModifyActive")->get())=="true" : false;
         auto changeBackground = has_input("ChangeBackground") ?
             (get_input<zeno::StringObject>("ChangeBackground")->get())=="true" : false;
+        grid->detach();
         if (auto p = std::dynamic_pointer_cast<zeno::VDBFloatGrid>(grid); p)
             vdb_wrangle(exec, p->m_grid, modifyActive, changeBackground, hasPos);
         else if (auto p = std::dynamic_pointer_cast<zeno::VDBFloat3Grid>(grid); p)
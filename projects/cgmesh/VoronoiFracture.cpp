@@ -10,11 +10,19 @@
 #include <zeno/utils/vec.h>
 #include <voro++/voro++.hh>
 #include "EigenUtils.h"
+#include <Eigen/Geometry>
 #include "igl_sink.h"
 #include <zeno/types/UserData.h>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <limits>
 #include <mutex>
+#include <optional>
+#include <set>
 #include <vector>
 #include <tuple>
+#include <unordered_map>
 
 namespace {
 using namespace zeno;
@@ -161,6 +169,599 @@ ZENO_DEFNODE(AABBVoronoi)({
 });
 
 
+// uniform grid binning the triangles of a mesh by their bounding boxes, so that
+// each voronoi cell only has to look at the triangles near it
+struct TriangleGrid {
+    Eigen::Vector3d origin, invCell;
+    Eigen::Vector3i res;
+    std::vector<int> start, items;
+
+    TriangleGrid(Eigen::MatrixXd const &V, Eigen::MatrixXi const &F) {
+        Eigen::Vector3d bmin = V.colwise().minCoeff().transpose();
+        Eigen::Vector3d bmax = V.colwise().maxCoeff().transpose();
+        int n = std::clamp((int)std::cbrt(F.rows() * 0.5), 1, 128);
+        res = Eigen::Vector3i(n, n, n);
+        origin = bmin;
+        invCell = (bmax - bmin).cwiseMax(1e-12).cwiseInverse() * n;
+
+        std::vector<std::pair<Eigen::Vector3i, Eigen::Vector3i>> ranges(F.rows());
+        start.assign(res.prod() + 1, 0);
+        for (int f = 0; f < F.rows(); f++) {
+            Eigen::Vector3d tmin = V.row(F(f, 0)).transpose(), tmax = tmin;
+            for (int k = 1; k < 3; k++) {
+                tmin = tmin.cwiseMin(V.row(F(f, k)).transpose());
+                tmax = tmax.cwiseMax(V.row(F(f, k)).transpose());
+            }
+            ranges[f] = {toCell(tmin), toCell(tmax)};
+            forCells(ranges[f].first, ranges[f].second, [&] (int c) { start[c]++; });
+        }
+        int sum = 0;
+        for (auto &x: start) {
+            int cnt = x;
+            x = sum;
+            sum += cnt;
+        }
+        items.resize(sum);
+        std::vector<int> cursor(start.begin(), start.end() - 1);
+        for (int f = 0; f < F.rows(); f++) {
+            forCells(ranges[f].first, ranges[f].second, [&] (int c) { items[cursor[c]++] = f; });
+        }
+    }
+
+    Eigen::Vector3i toCell(Eigen::Vector3d const &p) const {
+        Eigen::Vector3d q = (p - origin).cwiseProduct(invCell);
+        Eigen::Vector3i c;
+        for (int k = 0; k < 3; k++)
+            c(k) = std::clamp((int)std::floor(q(k)), 0, res(k) - 1);
+        return c;
+    }
+
+    template <class F>
+    void forCells(Eigen::Vector3i const &cmin, Eigen::Vector3i const &cmax, F const &f) const {
+        for (int z = cmin(2); z <= cmax(2); z++)
+            for (int y = cmin(1); y <= cmax(1); y++)
+                for (int x = cmin(0); x <= cmax(0); x++)
+                    f(x + res(0) * (y + res(1) * z));
+    }
+
+    // triangles whose grid cells overlap the given box, sorted and unique
+    void query(Eigen::Vector3d const &bmin, Eigen::Vector3d const &bmax, std::vector<int> &out) const {
+        out.clear();
+        forCells(toCell(bmin), toCell(bmax), [&] (int c) {
+            out.insert(out.end(), items.begin() + start[c], items.begin() + start[c + 1]);
+        });
+        std::sort(out.begin(), out.end());
+        out.erase(std::unique(out.begin(), out.end()), out.end());
+    }
+};
+
+using HalfSpaces = std::vector<std::pair<Eigen::Vector3d, double>>;
+
+// a convex voronoi cell: the half-space n.x <= d of each face, n pointing out
+// of the cell, and the loop of cell verts around that face, counter-clockwise
+// seen from outside
+struct CellHull {
+    Eigen::Vector3d bmin, bmax, center;
+    std::vector<Eigen::Vector3d> corners;
+    std::vector<std::vector<int>> faces;
+    HalfSpaces planes;
+    double eps;
+};
+
+// the planes come from the polys voro++ gave the cell, which stay next to the
+// tris when it is triangulated
+CellHull cellHull(PrimitiveObject const *cell) {
+    auto const &pos = cell->verts;
+    CellHull hull;
+    hull.corners.resize(pos.size());
+    for (size_t i = 0; i < pos.size(); i++)
+        hull.corners[i] = Eigen::Vector3d(pos[i][0], pos[i][1], pos[i][2]);
+    hull.bmin = hull.bmax = hull.corners[0];
+    hull.center.setZero();
+    for (auto const &q: hull.corners) {
+        hull.bmin = hull.bmin.cwiseMin(q);
+        hull.bmax = hull.bmax.cwiseMax(q);
+        hull.center += q;
+    }
+    hull.center /= pos.size();
+    hull.eps = 1e-6 * (hull.bmax - hull.bmin).norm();
+
+    for (auto [start, len]: cell->polys) {
+        std::vector<int> loop(cell->loops.begin() + start, cell->loops.begin() + start + len);
+        // newell's normal, robust to the slightly non planar loops of near degenerate faces
+        Eigen::Vector3d n = Eigen::Vector3d::Zero(), mid = Eigen::Vector3d::Zero();
+        for (int k = 0; k < len; k++) {
+            auto const &p = hull.corners[loop[k]], &q = hull.corners[loop[(k + 1) % len]];
+            n += p.cross(q);
+            mid += p;
+        }
+        mid /= len;
+        if (len < 3 || n.norm() <= 1e-12)
+            continue;
+        n.normalize();
+        if (n.dot(mid - hull.center) < 0) {
+            n = -n;
+            std::reverse(loop.begin(), loop.end());
+        }
+        hull.planes.emplace_back(n, n.dot(mid));
+        hull.faces.push_back(std::move(loop));
+    }
+    return hull;
+}
+
+// the triangles whose boxes overlap the cell's box, the only ones that can reach into it
+void cellCandidates(Eigen::MatrixXd const &V, Eigen::MatrixXi const &F, TriangleGrid const &grid,
+                    CellHull const &hull, std::vector<int> &cands) {
+    Eigen::Vector3d bmin = hull.bmin.array() - hull.eps, bmax = hull.bmax.array() + hull.eps;
+    grid.query(bmin, bmax, cands);
+    cands.erase(std::remove_if(cands.begin(), cands.end(), [&] (int f) {
+        Eigen::Vector3d a = V.row(F(f, 0)).transpose(), b = V.row(F(f, 1)).transpose(), c = V.row(F(f, 2)).transpose();
+        Eigen::Vector3d tmin = a.cwiseMin(b).cwiseMin(c), tmax = a.cwiseMax(b).cwiseMax(c);
+        return (tmin.array() > bmax.array()).any() || (tmax.array() < bmin.array()).any();
+    }), cands.end());
+}
+
+// does the triangle touch the convex cell given as half-spaces n.x <= d?
+// sutherland-hodgman clip against every plane, eps makes it conservative
+bool triangleTouchesCell(Eigen::Vector3d const &a, Eigen::Vector3d const &b, Eigen::Vector3d const &c,
+                         HalfSpaces const &planes, double eps) {
+    std::vector<Eigen::Vector3d> poly{a, b, c}, next;
+    for (auto const &[n, d]: planes) {
+        next.clear();
+        for (size_t i = 0; i < poly.size(); i++) {
+            auto const &p = poly[i], &q = poly[(i + 1) % poly.size()];
+            double dp = n.dot(p) - d - eps, dq = n.dot(q) - d - eps;
+            if (dp <= 0)
+                next.push_back(p);
+            if ((dp < 0) != (dq < 0) && dp != dq)
+                next.push_back(p + (q - p) * (dp / (dp - dq)));
+        }
+        std::swap(poly, next);
+        if (poly.empty())
+            return false;
+    }
+    return true;
+}
+
+// generalized winding number of a closed mesh at point p (van oosterom-strackee solid angles)
+double meshWindingNumber(Eigen::MatrixXd const &V, Eigen::MatrixXi const &F, Eigen::Vector3d const &p) {
+    double sum = 0;
+#pragma omp parallel for reduction(+:sum)
+    for (int f = 0; f < F.rows(); f++) {
+        Eigen::Vector3d a = V.row(F(f, 0)).transpose() - p;
+        Eigen::Vector3d b = V.row(F(f, 1)).transpose() - p;
+        Eigen::Vector3d c = V.row(F(f, 2)).transpose() - p;
+        double la = a.norm(), lb = b.norm(), lc = c.norm();
+        double num = a.dot(b.cross(c));
+        double den = la * lb * lc + a.dot(b) * lc + b.dot(c) * la + c.dot(a) * lb;
+        sum += 2 * std::atan2(num, den);
+    }
+    return sum / (4 * M_PI);
+}
+
+// ear clipping of a simple ccw polygon, false if no ear is left to cut off,
+// which is what polygons that cross themselves end up with
+bool triangulateLoop(std::vector<Eigen::Vector2d> const &pts, std::vector<int> const &ids,
+                     std::vector<Eigen::Vector3i> &out, double tol) {
+    auto cross = [&] (int a, int b, int c) {
+        Eigen::Vector2d u = pts[b] - pts[a], v = pts[c] - pts[a];
+        return u(0) * v(1) - u(1) * v(0);
+    };
+    std::vector<int> idx(pts.size());
+    for (int i = 0; i < (int)idx.size(); i++)
+        idx[i] = i;
+    int i = 0;
+    while (idx.size() > 3) {
+        int m = idx.size(), ear = -1, flat = -1;
+        double flatArea = tol;
+        for (int t = 0; t < m && ear == -1; t++, i = (i + 1) % m) {
+            int a = idx[(i + m - 1) % m], b = idx[i], c = idx[(i + 1) % m];
+            double area = cross(a, b, c);
+            if (std::abs(area) <= flatArea) {
+                flat = i;
+                flatArea = std::abs(area);
+            }
+            if (area <= 0)
+                continue;
+            bool empty = true;
+            for (int j = 0; j < m && empty; j++) {
+                int p = idx[j];
+                if (p != a && p != b && p != c)
+                    empty = cross(a, b, p) < 0 || cross(b, c, p) < 0 || cross(c, a, p) < 0;
+            }
+            if (empty)
+                ear = i;
+        }
+        // collinear runs are cut off as slivers, so the cap still shares its rim verts
+        if (ear == -1)
+            ear = flat;
+        if (ear == -1)
+            return false;
+        out.emplace_back(ids[idx[(ear + m - 1) % m]], ids[idx[ear]], ids[idx[(ear + 1) % m]]);
+        idx.erase(idx.begin() + ear);
+        i = ear % (m - 1);
+    }
+    out.emplace_back(ids[idx[0]], ids[idx[1]], ids[idx[2]]);
+    return true;
+}
+
+// intersect a closed mesh with a convex cell. tris are the mesh triangles
+// whose boxes overlap the cell's box, the others can't reach into the cell.
+// They are clipped to every half-space, then each face of the cell gets a
+// cap: the loops of cut edges in its plane, joined along the face's border
+// where they end on it, or the whole face where it lies inside the mesh.
+// False when that can't be done safely (open or non-manifold input, mesh
+// faces lying in a cell plane, caps with holes, a cell the surface doesn't
+// enter), so the caller can fall back to the exact boolean
+bool clipMeshToCell(Eigen::MatrixXd const &V, Eigen::MatrixXi const &F, std::vector<int> const &cands,
+                    CellHull const &hull, Eigen::MatrixXd &VC, Eigen::MatrixXi &FC, bool &anyFromA) {
+    auto const &planes = hull.planes;
+    double eps = hull.eps;
+    int nfaces = planes.size();
+
+    std::vector<Eigen::Vector3d> pos;
+    std::unordered_map<int, int> local;
+    std::vector<Eigen::Vector3i> tris, newTris;
+    for (int f: cands) {
+        Eigen::Vector3i ind;
+        for (int k = 0; k < 3; k++) {
+            auto [it, isNew] = local.try_emplace(F(f, k), (int)pos.size());
+            if (isNew)
+                pos.push_back(V.row(F(f, k)).transpose());
+            ind[k] = it->second;
+        }
+        tris.push_back(ind);
+    }
+
+    std::vector<double> dist;
+    std::map<std::pair<int, int>, int> cuts;
+    std::vector<int> poly;
+    for (auto const &[n, d]: planes) {
+        if (tris.empty())
+            break;
+        dist.resize(pos.size());
+        for (size_t i = 0; i < pos.size(); i++) {
+            double s = n.dot(pos[i]) - d;
+            dist[i] = std::abs(s) <= eps ? 0 : s;
+        }
+        cuts.clear();
+        auto cutVert = [&] (int a, int b) {
+            auto [it, isNew] = cuts.try_emplace(std::minmax(a, b), (int)pos.size());
+            if (isNew) {
+                Eigen::Vector3d p = pos[a] + (pos[b] - pos[a]) * (dist[a] / (dist[a] - dist[b]));
+                pos.push_back(p);
+                dist.push_back(0);
+            }
+            return it->second;
+        };
+        newTris.clear();
+        for (auto const &ind: tris) {
+            if (dist[ind[0]] == 0 && dist[ind[1]] == 0 && dist[ind[2]] == 0)
+                return false;
+            poly.clear();
+            for (int k = 0; k < 3; k++) {
+                int a = ind[k], b = ind[(k + 1) % 3];
+                if (dist[a] <= 0)
+                    poly.push_back(a);
+                if ((dist[a] < 0 && dist[b] > 0) || (dist[a] > 0 && dist[b] < 0))
+                    poly.push_back(cutVert(a, b));
+            }
+            for (int k = 1; k + 1 < (int)poly.size(); k++)
+                newTris.emplace_back(poly[0], poly[k], poly[k + 1]);
+        }
+        std::swap(tris, newTris);
+    }
+    // without any of the surface inside, the cell can't tell whether it's in or out
+    if (tris.empty())
+        return false;
+    size_t numClipped = tris.size();
+
+    // the rim of each face: directed edges of the clipped surface lying in its
+    // plane, an edge in the plane kept on both sides is no rim
+    auto onPlane = [&] (int j, int i) {
+        return std::abs(planes[j].first.dot(pos[i]) - planes[j].second) <= eps;
+    };
+    std::vector<std::set<std::pair<int, int>>> rim(nfaces);
+    for (size_t t = 0; t < numClipped; t++) {
+        for (int k = 0; k < 3; k++) {
+            int a = tris[t][k], b = tris[t][(k + 1) % 3], face = -1;
+            for (int j = 0; j < nfaces; j++) {
+                if (onPlane(j, a) && onPlane(j, b)) {
+                    // an edge running along an edge of the cell
+                    if (face != -1)
+                        return false;
+                    face = j;
+                }
+            }
+            if (face != -1 && !rim[face].erase({b, a}) && !rim[face].emplace(a, b).second)
+                return false;
+        }
+    }
+
+    std::map<std::pair<int, int>, int> edgeFace;
+    for (int j = 0; j < nfaces; j++) {
+        auto const &loop = hull.faces[j];
+        for (size_t k = 0; k < loop.size(); k++)
+            edgeFace[{loop[k], loop[(k + 1) % loop.size()]}] = j;
+    }
+    auto twinFace = [&] (int j, int k) {
+        auto const &loop = hull.faces[j];
+        auto it = edgeFace.find({loop[(k + 1) % loop.size()], loop[k]});
+        return it == edgeFace.end() ? -1 : it->second;
+    };
+    std::vector<int> cornerVert(hull.corners.size(), -1);
+    auto corner = [&] (int c) {
+        if (cornerVert[c] == -1) {
+            cornerVert[c] = pos.size();
+            pos.push_back(hull.corners[c]);
+        }
+        return cornerVert[c];
+    };
+
+    // along each border edge of a face with a rim: whether a rim ends on it,
+    // and whether the cap runs along it, that is, it lies inside the mesh
+    std::vector<std::vector<char>> edgeHasEnd(nfaces), edgeInside(nfaces);
+    std::map<int, int> capNext;
+    std::set<int> capIn;
+    std::vector<std::pair<double, int>> ends;  // border position, vert; starts negated as -1 - vert
+    std::vector<int> loop;
+    std::vector<Eigen::Vector2d> loop2d;
+    for (int j = 0; j < nfaces; j++) {
+        if (rim[j].empty())
+            continue;
+        auto const &n = planes[j].first;
+        auto const &border = hull.faces[j];
+        int m = border.size();
+        edgeHasEnd[j].assign(m, 0);
+        edgeInside[j].assign(m, 0);
+
+        // the cap runs the rim backwards, which makes it face along n
+        capNext.clear();
+        capIn.clear();
+        for (auto const &[a, b]: rim[j]) {
+            if (!capNext.emplace(b, a).second || !capIn.insert(a).second)
+                return false;
+        }
+
+        // open chains start and end on the border, find where
+        ends.clear();
+        auto borderPos = [&] (int x, int &edge) {
+            double best = std::numeric_limits<double>::infinity(), bestT = 0;
+            for (int k = 0; k < m; k++) {
+                auto const &p = hull.corners[border[k]], &q = hull.corners[border[(k + 1) % m]];
+                Eigen::Vector3d e = q - p;
+                double t = std::clamp((pos[x] - p).dot(e) / std::max(e.squaredNorm(), 1e-300), 0.0, 1.0);
+                double dd = (p + t * e - pos[x]).norm();
+                if (dd < best) {
+                    best = dd;
+                    bestT = t;
+                    edge = k;
+                }
+            }
+            return best <= 1e3 * eps ? edge + bestT : -1.0;
+        };
+        for (auto const &[a, b]: capNext) {
+            for (int x: {a, b}) {
+                bool isStart = x == a && !capIn.count(x), isEnd = x == b && !capNext.count(x);
+                if (!isStart && !isEnd)
+                    continue;
+                int edge = -1;
+                double s = borderPos(x, edge);
+                if (s < 0)
+                    return false;
+                edgeHasEnd[j][edge] = 1;
+                ends.emplace_back(s, isStart ? -1 - x : x);
+            }
+        }
+        std::sort(ends.begin(), ends.end());
+
+        Eigen::Vector3d u = n.unitOrthogonal(), v = n.cross(u);
+        auto emitLoop = [&] {
+            double area = 0;
+            for (size_t k = 0; k < loop2d.size(); k++) {
+                auto const &p = loop2d[k], &q = loop2d[(k + 1) % loop2d.size()];
+                area += p(0) * q(1) - p(1) * q(0);
+            }
+            // a clockwise loop is a hole in the cap (or an inside-out mesh)
+            if (loop.size() < 3 || area <= 0)
+                return false;
+            return triangulateLoop(loop2d, loop, tris, eps * eps);
+        };
+        auto push = [&] (int x) {
+            loop.push_back(x);
+            loop2d.emplace_back(u.dot(pos[x]), v.dot(pos[x]));
+        };
+
+        // each chain end goes on along the border to the next chain start
+        size_t nends = ends.size();
+        for (size_t k = 0; k < nends; k++) {
+            bool isStart = ends[k].second < 0, nextIsStart = ends[(k + 1) % nends].second < 0;
+            if (isStart == nextIsStart)
+                return false;
+        }
+        std::map<int, size_t> endAt;
+        for (size_t k = 0; k < nends; k++) {
+            if (ends[k].second >= 0)
+                endAt[ends[k].second] = k;
+        }
+        while (!endAt.empty()) {
+            loop.clear();
+            loop2d.clear();
+            size_t k = endAt.begin()->second;
+            int firstEnd = ends[k].second;
+            while (true) {
+                auto [se, e] = ends[k];
+                auto [ss, negStart] = ends[(k + 1) % nends];
+                int s = -1 - negStart;
+                endAt.erase(e);
+                push(e);
+                // the border corners strictly between the end and the start
+                int ke = (int)se, ks = (int)ss;
+                int steps = ks - ke + (ss <= se ? m : 0);
+                for (int i = 1; i <= steps; i++) {
+                    int c = border[(ke + i) % m];
+                    if ((hull.corners[c] - pos[e]).norm() > eps && (hull.corners[c] - pos[s]).norm() > eps)
+                        push(corner(c));
+                }
+                for (int i = 0; i <= steps; i++)
+                    edgeInside[j][(ke + i) % m] = 1;
+                int x = s;
+                for (auto it = capNext.find(x); it != capNext.end(); it = capNext.find(x)) {
+                    push(x);
+                    x = it->second;
+                    capNext.erase(it);
+                }
+                if (x == firstEnd)
+                    break;
+                if (!endAt.count(x))
+                    return false;
+                k = endAt[x];
+            }
+            if (!emitLoop())
+                return false;
+        }
+        // the loops that don't touch the border
+        while (!capNext.empty()) {
+            loop.clear();
+            loop2d.clear();
+            int start = capNext.begin()->first, x = start;
+            do {
+                auto it = capNext.find(x);
+                if (it == capNext.end())
+                    return false;
+                push(x);
+                x = it->second;
+                capNext.erase(it);
+            } while (x != start);
+            if (!emitLoop())
+                return false;
+        }
+    }
+
+    // a face without rim lies all inside or all outside the mesh, the same
+    // as the border it shares with a face that has one, or with a face
+    // already decided; a rim ending on that border means it's not that simple
+    std::vector<int> inside(nfaces, -1), queue;
+    for (int j = 0; j < nfaces; j++) {
+        if (!rim[j].empty()) {
+            inside[j] = 2;
+            queue.push_back(j);
+        }
+    }
+    // no rim at all, the surface is wholly inside the cell
+    if (queue.empty())
+        std::fill(inside.begin(), inside.end(), 0);
+    while (!queue.empty()) {
+        int j = queue.back();
+        queue.pop_back();
+        for (int k = 0; k < (int)hull.faces[j].size(); k++) {
+            int o = twinFace(j, k);
+            if (o == -1)
+                return false;
+            if (!rim[o].empty())
+                continue;
+            int in = inside[j];
+            if (in == 2) {
+                if (edgeHasEnd[j][k])
+                    return false;
+                in = edgeInside[j][k];
+            }
+            if (inside[o] == -1) {
+                inside[o] = in;
+                queue.push_back(o);
+            } else if (inside[o] != in) {
+                return false;
+            }
+        }
+    }
+    for (int j = 0; j < nfaces; j++) {
+        if (inside[j] == -1)
+            return false;
+        if (inside[j] != 1)
+            continue;
+        auto const &border = hull.faces[j];
+        for (size_t k = 1; k + 1 < border.size(); k++)
+            tris.emplace_back(corner(border[0]), corner(border[k]), corner(border[k + 1]));
+    }
+
+    std::vector<int> remap(pos.size(), -1);
+    int nverts = 0;
+    for (auto const &ind: tris)
+        for (int k = 0; k < 3; k++)
+            if (remap[ind[k]] == -1)
+                remap[ind[k]] = nverts++;
+    VC.resize(nverts, 3);
+    for (size_t i = 0; i < pos.size(); i++)
+        if (remap[i] != -1)
+            VC.row(remap[i]) = pos[i].transpose();
+    FC.resize(tris.size(), 3);
+    for (size_t t = 0; t < tris.size(); t++)
+        for (int k = 0; k < 3; k++)
+            FC(t, k) = remap[tris[t][k]];
+    anyFromA = true;
+    return true;
+}
+
+// classify every voronoi cell against the mesh: 0 = outside, 1 = inside, 2 = cut by the surface,
+// only the cut cells need the exact boolean, the others are either dropped or kept as is
+std::vector<int> classifyCells(Eigen::MatrixXd const &V, Eigen::MatrixXi const &F, TriangleGrid const &grid,
+                               std::vector<std::shared_ptr<PrimitiveObject>> const &cells,
+                               std::vector<vec2i> const &neighs) {
+    int ncells = cells.size();
+    std::vector<int> status(ncells, 2);
+    std::vector<Eigen::Vector3d> centers(ncells);
+
+#pragma omp parallel for
+    for (int i = 0; i < ncells; i++) {
+        auto const &cell = cells[i];
+        if (!cell->verts.size()) {
+            status[i] = 0;
+            continue;
+        }
+        auto hull = cellHull(cell.get());
+        centers[i] = hull.center;
+
+        std::vector<int> cands;
+        cellCandidates(V, F, grid, hull, cands);
+        bool touches = false;
+        for (int f: cands) {
+            Eigen::Vector3d a = V.row(F(f, 0)).transpose(), b = V.row(F(f, 1)).transpose(), c = V.row(F(f, 2)).transpose();
+            if (triangleTouchesCell(a, b, c, hull.planes, hull.eps)) {
+                touches = true;
+                break;
+            }
+        }
+        status[i] = touches ? 2 : -1;
+    }
+
+    // two neighbouring cells untouched by the surface can't be separated by it, so
+    // each connected group of them needs only one inside test
+    std::vector<std::vector<int>> lut(ncells);
+    for (auto const &e: neighs) {
+        lut[e[0]].push_back(e[1]);
+        lut[e[1]].push_back(e[0]);
+    }
+    std::vector<int> stack;
+    for (int i = 0; i < ncells; i++) {
+        if (status[i] != -1) continue;
+        int inside = meshWindingNumber(V, F, centers[i]) > 0.5 ? 1 : 0;
+        status[i] = inside;
+        stack.push_back(i);
+        while (!stack.empty()) {
+            int x = stack.back();
+            stack.pop_back();
+            for (int y: lut[x]) {
+                if (status[y] == -1) {
+                    status[y] = inside;
+                    stack.push_back(y);
+                }
+            }
+        }
+    }
+    return status;
+}
+
+
 struct VoronoiFracture : AABBVoronoi {
     virtual void apply() override {
         auto primA = get_input<PrimitiveObject>("meshPrim");
@@ -183,25 +784,63 @@ struct VoronoiFracture : AABBVoronoi {
         auto primListB = std::dynamic_pointer_cast<ListObject>(outputs.at("primList"));
         auto neighListB = std::dynamic_pointer_cast<ListObject>(outputs.at("neighList"));
         auto listB = primListB->get<PrimitiveObject>();
+        auto neighB = neighListB->getLiterial<zeno::vec2i>();
         std::map<int, std::shared_ptr<PrimitiveObject>> dictC;
         std::mutex mtx;
 
+        std::vector<int> status(listB.size(), 2);
+        auto fastPath = get_param<bool>("convexFastPath");
+        std::optional<TriangleGrid> grid;
+        if (fastPath && VFA.second.rows() == 0) {
+            std::fill(status.begin(), status.end(), 0);
+        } else if (fastPath) {
+            grid.emplace(VFA.first, VFA.second);
+            status = classifyCells(VFA.first, VFA.second, *grid, listB, neighB);
+            int counts[3] = {0, 0, 0};
+            for (int s: status) counts[s]++;
+            log_info("VoronoiFracture: {} cells inside, {} outside, {} cut by the mesh", counts[1], counts[0], counts[2]);
+        }
+
         #pragma omp parallel for
         for (int i = 0; i < listB.size(); i++) {
-            log_debug("VoronoiFracture: processing fragment #{}...", i);
             auto const &primB = listB[i];
-            auto [VB, FB] = get_param<bool>("doMeshFix2") ? prim_to_eigen_with_fix(primB.get()) : prim_to_eigen(primB.get());
+            if (status[i] == 0) {
+                log_debug("null piece encountered at #{}, removing...", i);
+                continue;
+            }
+            if (status[i] == 1) {
+                auto primC = std::make_shared<PrimitiveObject>();
+                primC->verts.values = primB->verts.values;
+                primC->tris.values = primB->tris.values;
+                primC->userData().set("isBoundary", objectFromLiterial(false));
+                std::lock_guard _(mtx);
+                dictC.emplace(i, std::move(primC));
+                continue;
+            }
+            log_debug("VoronoiFracture: processing fragment #{}...", i);
             Eigen::MatrixXd VC;
             Eigen::MatrixXi FC;
-            Eigen::VectorXi J;
-            igl_mesh_boolean(VFA.first, VFA.second, VB, FB, "Intersect", VC, FC, J);
-            if (VC.size() != 0) {
-                bool anyFromA = false;
+            bool anyFromA = false;
+            bool clipped = false;
+            if (grid) {
+                auto hull = cellHull(primB.get());
+                std::vector<int> cands;
+                cellCandidates(VFA.first, VFA.second, *grid, hull, cands);
+                clipped = clipMeshToCell(VFA.first, VFA.second, cands, hull, VC, FC, anyFromA);
+                if (!clipped)
+                    log_debug("VoronoiFracture: clipping fragment #{} failed, using mesh boolean", i);
+            }
+            if (!clipped) {
+                auto [VB, FB] = get_param<bool>("doMeshFix2") ? prim_to_eigen_with_fix(primB.get()) : prim_to_eigen(primB.get());
+                Eigen::VectorXi J;
+                igl_mesh_boolean(VFA.first, VFA.second, VB, FB, "Intersect", VC, FC, J);
                 for (int i = 0; i < J.size(); i++) {
                     if (J(i) < VFA.second.rows()) {
                         anyFromA = true;
                     }
                 }
+            }
+            if (VC.size() != 0) {
                 auto primC = std::make_shared<PrimitiveObject>();
                 eigen_to_prim(VC, FC, primC.get());
                 primC->userData().set("isBoundary", objectFromLiterial(anyFromA));
@@ -212,7 +851,6 @@ struct VoronoiFracture : AABBVoronoi {
             }
         }
 
-        auto neighB = neighListB->getLiterial<zeno::vec2i>();
         auto primListC = std::make_shared<ListObject>();
         std::map<int, int> dictD;
         for (auto const &[key, prim]: dictC) {
@@ -255,6 +893,7 @@ ZENO_DEFNODE(VoronoiFracture)({
         {"bool", "periodicX", "0"},
         {"bool", "periodicY", "0"},
         {"bool", "periodicZ", "0"},
+        {"bool", "convexFastPath", "1"},
         },
         {"cgmesh"},
 });
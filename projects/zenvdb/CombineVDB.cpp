@@ -68,12 +68,14 @@ struct  ResampleVDBGrid : zeno::INode {
         {
           auto target = get_input("resampleTo")->as<VDBFloatGrid>();
           auto source = get_input("resampleFrom")->as<VDBFloatGrid>();
+          target->detach();
           resampleVDB<openvdb::FloatGrid>(source->m_grid, target->m_grid);
         }
         else if (sourceType==std::string("Vec3fGrid"))
         {
           auto target = get_input("resampleTo")->as<VDBFloat3Grid>();
           auto source = get_input("resampleFrom")->as<VDBFloat3Grid>();
+          target->detach();
           resampleVDB<openvdb::Vec3fGrid>(source->m_grid, target->m_grid);
         }
         set_output("resampleTo", get_input("resampleTo"));
@@ -108,6 +110,7 @@ struct CombineVDB : zeno::INode{
         auto target = get_input("FieldA")->as<VDBFloatGrid>();
         auto source = get_input("FieldB")->as<VDBFloatGrid>();
         if (get_param<bool>("writeBack")) {
+            target->detach();
             auto srcgrid = source->m_grid->deepCopy();
             if(OpType=="CSGUnion") {
               openvdb::tools::csgUnion(*(target->m_grid), *(srcgrid));
@@ -136,6 +139,7 @@ struct CombineVDB : zeno::INode{
         auto target = get_input("FieldA")->as<VDBFloatGrid>();
         auto source = get_input("FieldB")->as<VDBFloatGrid>();
         auto srcgrid = source->m_grid->deepCopy();
+        target->detach();
         openvdb::tools::compSum(*(target->m_grid), *(srcgrid));
         set_output("FieldOut", get_input("FieldA"));
       }
@@ -143,6 +147,7 @@ struct CombineVDB : zeno::INode{
         auto target = get_input("FieldA")->as<VDBFloat3Grid>();
         auto source = get_input("FieldB")->as<VDBFloat3Grid>();
         auto srcgrid = source->m_grid->deepCopy();
+        target->detach();
         openvdb::tools::compSum(*(target->m_grid), *(srcgrid));
         set_output("FieldOut", get_input("FieldA"));
       }
@@ -153,6 +158,7 @@ struct CombineVDB : zeno::INode{
         auto target = get_input("FieldA")->as<VDBFloatGrid>();
         auto source = get_input("FieldB")->as<VDBFloatGrid>();
         auto srcgrid = source->m_grid->deepCopy();
+        target->detach();
         openvdb::tools::compMul(*(target->m_grid), *(srcgrid));
         set_output("FieldOut", get_input("FieldA"));
       }
@@ -160,6 +166,7 @@ struct CombineVDB : zeno::INode{
         auto target = get_input("FieldA")->as<VDBFloat3Grid>();
         auto source = get_input("FieldB")->as<VDBFloat3Grid>();
         auto srcgrid = source->m_grid->deepCopy();
+        target->detach();
         openvdb::tools::compMul(*(target->m_grid), *(srcgrid));
         set_output("FieldOut", get_input("FieldA"));
       }
@@ -170,6 +177,7 @@ struct CombineVDB : zeno::INode{
         auto target = get_input("FieldA")->as<VDBFloatGrid>();
         auto source = get_input("FieldB")->as<VDBFloatGrid>();
         auto srcgrid = source->m_grid->deepCopy();
+        target->detach();
         openvdb::tools::compReplace(*(target->m_grid), *(srcgrid));
         set_output("FieldOut", get_input("FieldA"));
       }
@@ -177,6 +185,7 @@ struct CombineVDB : zeno::INode{
         auto target = get_input("FieldA")->as<VDBFloat3Grid>();
         auto source = get_input("FieldB")->as<VDBFloat3Grid>();
         auto srcgrid = source->m_grid->deepCopy();
+        target->detach();
         openvdb::tools::compReplace(*(target->m_grid), *(srcgrid));
         set_output("FieldOut", get_input("FieldA"));
       }
@@ -206,6 +215,7 @@ struct VDBDeactivate : zeno::INode
     auto mType = get_input("Mask")->as<VDBGrid>()->getType();
     if(gType == mType && gType==std::string("FloatGrid"))
     {
+      get_input<VDBFloatGrid>("Field")->detach();
       auto const &grid = get_input<VDBFloatGrid>("Field")->m_grid;
       auto const &mask = get_input<VDBFloatGrid>("Mask")->m_grid;
       auto modifier = [&](auto &leaf, openvdb::Index leafpos) {
@@ -228,6 +238,7 @@ struct VDBDeactivate : zeno::INode
     }
     if(gType == mType && gType==std::string("Vec3fGrid"))
     {
+      get_input<VDBFloat3Grid>("Field")->detach();
       auto const &grid = get_input<VDBFloat3Grid>("Field")->m_grid;
       auto const &mask = get_input<VDBFloat3Grid>("Mask")->m_grid;
       auto modifier = [&](auto &leaf, openvdb::Index leafpos) {
@@ -131,6 +131,8 @@ struct SDFToFog : INode
         auto sdf = get_input<VDBFloatGrid>("SDF");
         if (!has_input("inplace") || !get_input2<bool>("inplace")) {
             sdf = std::make_shared<VDBFloatGrid>(sdf->m_grid->deepCopy());
+        } else {
+            sdf->detach();
         }
         //auto dx = sdf->m_grid->voxelSize()[0];
         openvdb::tools::sdfToFogVolume(*(sdf->m_grid));
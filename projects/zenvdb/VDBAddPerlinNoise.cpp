@@ -29,6 +29,7 @@ struct fuck_openvdb_vec<openvdb::Vec3f> {
 struct VDBPerlinNoise : INode {
   virtual void apply() override {
     auto inoutSDF = get_input<VDBFloatGrid>("inoutSDF");
+    inoutSDF->detach();
         auto scale = get_input2<float>("scale");
         auto scale3d = get_input2<vec3f>("scale3d");
         auto detail = get_input2<float>("detail");
@@ -110,6 +110,7 @@ static float perlin(float x, float y, float z) {
 struct VDBAddPerlinNoise : INode {
   virtual void apply() override {
     auto inoutSDF = get_input<VDBFloatGrid>("inoutSDF");
+    inoutSDF->detach();
     auto strength = get_input<NumericObject>("strength")->get<float>();
     auto scale = get_input<NumericObject>("scale")->get<float>();
     auto scaling = has_input("scaling") ?
@@ -247,6 +248,7 @@ float operator()(float x, float y, float z) {  // https://www.shadertoy.com/view
 struct VDBAddTurbulentNoise : INode {
   virtual void apply() override {
     auto inoutSDF = get_input<VDBFloatGrid>("inoutSDF");
+    inoutSDF->detach();
     auto strength = get_input<NumericObject>("strength")->get<float>();
     auto scale = get_input<NumericObject>("scale")->get<float>();
     auto scaling = has_input("scaling") ?
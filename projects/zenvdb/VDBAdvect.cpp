@@ -11,6 +11,7 @@ namespace zeno {
 struct SDFAdvect : zeno::INode {
     virtual void apply() override {
         auto inSDF = get_input("InoutSDF")->as<VDBFloatGrid>();
+        inSDF->detach();
         auto vecField = get_input("VecField")->as<VDBFloat3Grid>();
         auto grid = inSDF->m_grid;
         auto field = vecField->m_grid;
@@ -108,6 +108,7 @@ float operator()(float x, float y, float z) {  // https://www.shadertoy.com/view
 struct VDBExplosiveTurbulentNoise : INode {
   virtual void apply() override {
     auto inoutSDF = get_input<VDBFloatGrid>("inoutSDF");
+    inoutSDF->detach();
     auto strength = get_input<NumericObject>("strength")->get<float>();
     auto scale = get_input<NumericObject>("scale")->get<float>();
     auto scaling = has_input("scaling") ?
@@ -28,6 +28,7 @@ struct fill_voxels_op {
 struct VDBFillActiveVoxels : INode {
   virtual void apply() override {
     auto grid = get_input<VDBGrid>("grid");
+    grid->detach();
     auto value = get_input<NumericObject>("fillValue")->value;
     if (auto p = std::dynamic_pointer_cast<VDBFloatGrid>(grid); p) {
         auto velman = openvdb::tree::LeafManager
@@ -71,6 +72,7 @@ struct multiply_voxels_op {
 struct VDBMultiplyOperation : INode {
   virtual void apply() override {
     auto grid = get_input<VDBGrid>("grid");
+    grid->detach();
     auto value = get_input<NumericObject>("fillValue")->value;
     if (auto p = std::dynamic_pointer_cast<VDBFloatGrid>(grid); p) {
         auto velman = openvdb::tree::LeafManager
@@ -124,6 +126,7 @@ void touch_aabb_region(GridPtr const &grid, vec3f const &bmin, vec3f const &bmax
 struct VDBTouchAABBRegion : INode {
   virtual void apply() override {
     auto grid = get_input<VDBGrid>("grid");
+    grid->detach();
     auto bmin = get_input<NumericObject>("bmin")->get<vec3f>();
     auto bmax = get_input<NumericObject>("bmax")->get<vec3f>();
     if (auto p = std::dynamic_pointer_cast<VDBFloatGrid>(grid); p) {
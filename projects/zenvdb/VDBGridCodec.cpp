@@ -0,0 +1,81 @@
+#include <openvdb/openvdb.h>
+#include <openvdb/io/Stream.h>
+#include <zeno/funcs/ObjectCodec.h>
+#include <zeno/utils/log.h>
+#include <zeno/VDBGrid.h>
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+
+namespace zeno {
+namespace {
+
+// grids go through OpenVDB's own stream format, which keeps the tree sparse and
+// compresses each leaf, so a level set is sent to the editor and stored in the
+// frame cache at about the size of a .vdb file of it
+
+double mbPerSec(std::size_t bytes, std::chrono::steady_clock::time_point t0) {
+    auto secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return bytes / 1048576.0 / std::max(secs, 1e-9);
+}
+
+template <class GridT>
+bool encodeVDBGrid(VDBGridWrapper<GridT> const *obj, std::vector<char> &buf) {
+    if (!obj->m_grid) {
+        log_error("cannot encode empty VDB grid");
+        return false;
+    }
+    auto t0 = std::chrono::steady_clock::now();
+    std::ostringstream ss(std::ios_base::binary);
+    {
+        openvdb::io::Stream strm(ss);
+        strm.setCompression(openvdb::io::Archive::hasBloscCompression()
+                            ? openvdb::io::COMPRESS_BLOSC | openvdb::io::COMPRESS_ACTIVE_MASK
+                            : openvdb::io::COMPRESS_ZIP | openvdb::io::COMPRESS_ACTIVE_MASK);
+        strm.setGridStatsMetadataEnabled(false);
+        strm.write(openvdb::GridCPtrVec{obj->m_grid});
+    }
+    auto data = ss.str();
+    buf.insert(buf.end(), data.begin(), data.end());
+    auto memBytes = obj->m_grid->memUsage();
+    log_debug("encoded VDB grid of {} MB into {} MB at {} MB/s", memBytes >> 20, data.size() >> 20,
+              mbPerSec(memBytes, t0));
+    return true;
+}
+
+template <class GridT>
+std::shared_ptr<VDBGridWrapper<GridT>> decodeVDBGrid(const char *buf, size_t len) {
+    auto t0 = std::chrono::steady_clock::now();
+    std::istringstream ss(std::string(buf, len), std::ios_base::binary);
+    openvdb::io::Stream strm(ss, /*delayLoad=*/false);
+    auto grids = strm.getGrids();
+    if (!grids || grids->empty()) {
+        log_error("VDB stream holds no grid");
+        return nullptr;
+    }
+    auto grid = openvdb::gridPtrCast<GridT>(grids->front());
+    if (!grid) {
+        log_error("VDB stream holds a grid of type {}, expected {}", grids->front()->type(), GridT::gridType());
+        return nullptr;
+    }
+    auto memBytes = grid->memUsage();
+    auto obj = std::make_shared<VDBGridWrapper<GridT>>(std::move(grid));
+    log_debug("decoded VDB grid of {} MB from {} MB at {} MB/s", memBytes >> 20, len >> 20,
+              mbPerSec(memBytes, t0));
+    return obj;
+}
+
+template <class GridT>
+int defVDBGridCodec(std::string const &name) {
+    return registerObjectCodec<VDBGridWrapper<GridT>>(name, encodeVDBGrid<GridT>, decodeVDBGrid<GridT>);
+}
+
+}
+
+static int defVDBFloatGridCodec = defVDBGridCodec<openvdb::FloatGrid>("VDBFloatGrid");
+static int defVDBIntGridCodec = defVDBGridCodec<openvdb::Int32Grid>("VDBIntGrid");
+static int defVDBFloat3GridCodec = defVDBGridCodec<openvdb::Vec3fGrid>("VDBFloat3Grid");
+static int defVDBInt3GridCodec = defVDBGridCodec<openvdb::Vec3IGrid>("VDBInt3Grid");
+static int defVDBPointsGridCodec = defVDBGridCodec<openvdb::points::PointDataGrid>("VDBPointsGrid");
+
+}
@@ -12,6 +12,7 @@ namespace {
 struct VDBChangeBackground : INode{
   virtual void apply() override {
     auto grid = get_input<VDBGrid>("grid");
+    grid->detach();
     if (auto p = std::dynamic_pointer_cast<VDBFloatGrid>(grid); p) {
         openvdb::tools::changeBackground(p->m_grid->tree(), get_input2<float>("background"));
     } else if (auto p = std::dynamic_pointer_cast<VDBFloat3Grid>(grid); p) {
@@ -56,6 +57,7 @@ ZENO_DEFNODE(VDBGetBackground)(
 struct VDBInvertSDF : INode{
   virtual void apply() override {
     auto grid = get_input<VDBGrid>("grid");
+    grid->detach();
 
     auto visitor = [&] (auto &grid) {
         auto wrangler = [&](auto &leaf, openvdb::Index leafpos) {
@@ -93,6 +95,7 @@ ZENO_DEFNODE(VDBInvertSDF)(
 struct VDBPruneFootprint : INode{
   virtual void apply() override {
     auto grid = get_input<VDBGrid>("grid");
+    grid->detach();
 
     auto visitor = [&] (auto &grid) {
         openvdb::tools::prune(grid->tree());
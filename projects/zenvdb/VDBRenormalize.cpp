@@ -19,6 +19,7 @@ namespace zeno {
   virtual void apply() override {
 
     auto inoutSDF = get_input("inoutSDF")->as<VDBFloatGrid>();
+    inoutSDF->detach();
     int normIter = get_param<int>(("iterations"));
     int dilateIter = get_param<int>(("dilateIters"));
     auto lstracker = openvdb::tools::LevelSetTracker<openvdb::FloatGrid>(*(inoutSDF->m_grid));
@@ -59,6 +60,7 @@ struct VDBSmooth : zeno::INode {
         auto type = get_input<zeno::StringObject>("type")->value;
         if (inoutVDBtype == std::string("FloatGrid")) {
             auto inoutVDB = get_input("inoutVDB")->as<VDBFloatGrid>();
+            inoutVDB->detach();
             auto lsf = openvdb::tools::Filter<openvdb::FloatGrid>(*(inoutVDB->m_grid));
             lsf.setGrainSize(1);
             if(type == "Gaussian")
@@ -72,6 +74,7 @@ struct VDBSmooth : zeno::INode {
         }
         else if (inoutVDBtype == std::string("Vec3fGrid")) {
             auto inoutVDB = get_input("inoutVDB")->as<VDBFloat3Grid>();
+            inoutVDB->detach();
             auto lsf = openvdb::tools::Filter<openvdb::Vec3fGrid>(*(inoutVDB->m_grid));
             lsf.setGrainSize(1);
             if(type == "Gaussian")
@@ -102,6 +105,7 @@ struct  VDBSmoothSDF : zeno::INode { /* cihou old graph */
   virtual void apply() override {
 
     auto inoutSDF = get_input("inoutSDF")->as<VDBFloatGrid>();
+    inoutSDF->detach();
     int width = get_param<int>(("width"));
     int iterations = get_param<int>(("iterations"));
     auto lsf = openvdb::tools::Filter<openvdb::FloatGrid>(*(inoutSDF->m_grid));
@@ -149,6 +153,7 @@ static int defVDBDilateTopo = zeno::defNodeClass<VDBDilateTopo>("VDBDilateTopo",
 struct VDBErodeSDF : zeno::INode {
   virtual void apply() override {
     auto inoutSDF = get_input("inoutSDF")->as<VDBFloatGrid>();
+    inoutSDF->detach();
     auto grid = inoutSDF->m_grid;
     auto depth = get_input("depth")->as<zeno::NumericObject>()->get<float>();
     auto wrangler = [&](auto &leaf, openvdb::Index leafpos) {
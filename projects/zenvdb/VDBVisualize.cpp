@@ -19,6 +19,7 @@ struct ParticleAsVoxels : INode{
         
         if(type=="FloatGrid"){
             auto ingrid = get_input<VDBFloatGrid>("vdbGrid");
+            ingrid->detach();
             auto const &grid = ingrid->m_grid;
             auto inparticles = get_input<PrimitiveObject>("particles");
             auto attrName = get_input<StringObject>("Attr")->value;
@@ -39,6 +40,7 @@ struct ParticleAsVoxels : INode{
         }
         if(type=="Vec3fGrid") {
             auto ingrid = get_input<VDBFloat3Grid>("vdbGrid");
+            ingrid->detach();
             auto const &grid = ingrid->m_grid;
             auto inparticles = get_input<PrimitiveObject>("particles");
             auto attrName = get_input<StringObject>("Attr")->value;
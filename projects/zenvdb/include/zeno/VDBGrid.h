@@ -1,6 +1,8 @@
 #pragma once
 
 #include <vector>
+#include <atomic>
+#include <cassert>
 #include <zeno/zeno.h>
 
 #include <openvdb/points/PointCount.h>
@@ -47,6 +49,24 @@ void writeFloatGrid(const std::string &fn, typename GridT::Ptr grid) {
 
 // match([](auto &gridPtr) {...})(someGeneralVdbGrid);
 
+// bytes of trees shared by copied grids instead of deep copied, and how many
+// of those had to be deep copied later on because a copy got modified; the
+// sizes are estimated from the leaf count, which doesn't touch the voxels
+struct VDBGridCopyStats {
+  inline static std::atomic<std::size_t> sharedBytes{0};
+  inline static std::atomic<std::size_t> detachedBytes{0};
+
+  static std::size_t avoidedBytes() {
+    return sharedBytes - detachedBytes;
+  }
+
+  template <typename GridT>
+  static std::size_t estimateBytes(GridT const &grid) {
+    using LeafT = typename GridT::TreeType::LeafNodeType;
+    return grid.tree().leafCount() * (sizeof(LeafT) + LeafT::SIZE * sizeof(typename GridT::ValueType));
+  }
+};
+
 struct VDBGrid : zeno::IObject {
   virtual void output(std::string path) = 0;
   virtual void input(std::string path) = 0;
@@ -67,6 +87,9 @@ struct VDBGrid : zeno::IObject {
   virtual std::string getType() const =0;
   virtual zeno::vec3f getVoxelSize() const=0;
   virtual void dilateTopo(int l) =0;
+  // a copied grid shares its tree with the source until either calls this,
+  // nodes that modify an input grid in place must call it first
+  virtual void detach() =0;
 
   virtual ~VDBGrid() override = default;
 };
@@ -75,7 +98,13 @@ template <typename GridT>
 struct VDBGridWrapper : zeno::IObjectClone<VDBGridWrapper<GridT>, VDBGrid> {
   typename GridT::Ptr m_grid;
 
+#ifdef NDEBUG
   virtual ~VDBGridWrapper() override = default;
+#else
+  virtual ~VDBGridWrapper() override {
+      checkShared();
+  }
+#endif
 
   VDBGridWrapper() { m_grid = GridT::create(); }
 
@@ -83,17 +112,72 @@ struct VDBGridWrapper : zeno::IObjectClone<VDBGridWrapper<GridT>, VDBGrid> {
 
   VDBGridWrapper(VDBGridWrapper const &other) {
       if (other.m_grid)
-          m_grid = other.m_grid->deepCopy();
+          m_grid = shallowCopy(other);
   }
 
   VDBGridWrapper &operator=(VDBGridWrapper const &other) {
       if (other.m_grid)
-          m_grid = other.m_grid->deepCopy();
+          m_grid = shallowCopy(other);
       else
           m_grid = nullptr;
       return *this;
   }
 
+  // new grid sharing the tree, the metadata and transform are copied
+  typename GridT::Ptr shallowCopy(VDBGridWrapper const &other) {
+      auto const &grid = other.m_grid;
+      auto copied = grid->copy();
+      copied->setTransform(grid->transform().copy());
+      VDBGridCopyStats::sharedBytes += VDBGridCopyStats::estimateBytes(*grid);
+#ifndef NDEBUG
+      other.checkShared();
+      m_sharedPrint = other.m_sharedPrint = fingerprint(*grid);
+      m_sharedTree = other.m_sharedTree = &grid->constTree();
+#endif
+      return copied;
+  }
+
+  virtual void detach() override {
+      if (!m_grid || m_grid->isTreeUnique())
+          return;
+#ifndef NDEBUG
+      checkShared();
+#endif
+      m_grid->setTree(std::make_shared<typename GridT::TreeType>(m_grid->tree()));
+      VDBGridCopyStats::detachedBytes += VDBGridCopyStats::estimateBytes(*m_grid);
+  }
+
+#ifndef NDEBUG
+  // debug builds fingerprint a tree when it gets shared, and check it when
+  // one of the sharers lets go of it: a change means some node modified a
+  // shared grid in place without calling detach() first
+  mutable std::size_t m_sharedPrint = 0;
+  mutable void const *m_sharedTree = nullptr;
+
+  static std::size_t fingerprint(GridT const &grid) {
+      using LeafT = typename GridT::TreeType::LeafNodeType;
+      std::size_t h = 14695981039346656037ull;
+      auto mix = [&] (void const *p, std::size_t n) {
+          for (std::size_t i = 0; i < n; i++)
+              h = (h ^ static_cast<unsigned char const *>(p)[i]) * 1099511628211ull;
+      };
+      for (auto leaf = grid.tree().cbeginLeaf(); leaf; ++leaf) {
+          auto origin = leaf->origin();
+          mix(&origin, sizeof(origin));
+          mix(leaf->buffer().data(), LeafT::SIZE * sizeof(typename GridT::ValueType));
+          mix(&leaf->getValueMask(), sizeof(leaf->getValueMask()));
+      }
+      auto tiles = grid.tree().activeTileCount();
+      mix(&tiles, sizeof(tiles));
+      return h;
+  }
+
+  void checkShared() const {
+      if (m_grid && !m_grid->isTreeUnique() && &m_grid->constTree() == m_sharedTree)
+          assert(fingerprint(*m_grid) == m_sharedPrint && "VDB grid modified while its tree was shared, missing detach()");
+  }
+#endif
+
   // using VDBGrid::GeneralVdbGrid;
   // GeneralVdbGrid getGrid() override {
   //   return m_grid;
@@ -123,6 +207,7 @@ struct VDBGridWrapper : zeno::IObjectClone<VDBGridWrapper<GridT>, VDBGrid> {
   }
   virtual void
   dilateTopo(int l) override {
+    detach();
     openvdb::tools::dilateActiveValues(
       m_grid->tree(), l,
       openvdb::tools::NearestNeighbors::NN_FACE_EDGE_VERTEX, openvdb::tools::TilePolicy::EXPAND_TILES);
@@ -9,6 +9,7 @@
 #include <zeno/extra/GlobalComm.h>
 #include <zeno/extra/GlobalStatus.h>
 #include <zeno/extra/GlobalState.h>
+#include <zeno/extra/GlobalProfiler.h>
 #include <zeno/utils/logger.h>
 #include <zeno/core/Graph.h>
 
@@ -47,6 +48,9 @@ static int offline_start(const char *progJson) {
         }
         session->globalState->frameEnd();
         session->globalComm->finishFrame();
+        if (session->globalProfiler->enabled)
+            zeno::log_info("profile of frame {}:\n{}", frame,
+                           zeno::GlobalProfiler::summary(session->globalProfiler->collectFrame(), 5));
         zeno::log_debug("end frame {}", frame);
         if (chkfail()) return 1;
     }
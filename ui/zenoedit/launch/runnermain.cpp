@@ -3,15 +3,19 @@
 #include <cstring>
 #include <iostream>
 #include <zeno/utils/log.h>
-#include <zeno/utils/Timer.h>
 #include <zeno/core/Graph.h>
 #include <zeno/extra/GlobalState.h>
 #include <zeno/extra/GlobalComm.h>
 #include <zeno/extra/GlobalStatus.h>
+#include <zeno/extra/GlobalProfiler.h>
 #include <zeno/extra/GraphException.h>
 #include <zeno/funcs/ObjectCodec.h>
+#include <zeno/utils/envconfig.h>
 #include <zeno/zeno.h>
+#include <rapidjson/document.h>
 #include <string>
+#include <QCoreApplication>
+#include <QProcess>
 #ifdef ZENO_IPC_USE_TCP
 #include <QTcpServer>
 #include <QtWidgets>
@@ -26,10 +30,8 @@ namespace {
 
 #ifdef ZENO_IPC_USE_TCP
 static std::unique_ptr<QTcpSocket> clientSocket;
-#else
-static FILE *ourfp;
-static char ourbuf[1 << 20]; // 1MB
 #endif
+static FILE *ourfp;  // frame workers always talk to their parent runner through the pipe
 
 struct Header { // sync with viewdecode.cpp
     size_t total_size;
@@ -41,6 +43,11 @@ struct Header { // sync with viewdecode.cpp
         magicnum = 314159265;
         checksum = total_size ^ info_size ^ magicnum;
     }
+
+    bool isValid() const {
+        if (magicnum != 314159265) return false;
+        return (total_size ^ info_size ^ magicnum ^ checksum) == 0;
+    }
 };
 
 static void send_packet(std::string_view info, const char *buf, size_t len) {
@@ -59,14 +66,17 @@ static void send_packet(std::string_view info, const char *buf, size_t len) {
 
     zeno::log_debug("runner tx head-buffer {} data-buffer {}", headbuffer.size(), len);
 #ifdef ZENO_IPC_USE_TCP
-    for (char c: headbuffer) {
-        clientSocket->write(&c, 1);
-    }
-    clientSocket->write(buf, len);
-    while (clientSocket->bytesToWrite() > 0) {
-        clientSocket->waitForBytesWritten();
+    if (clientSocket) {
+        for (char c: headbuffer) {
+            clientSocket->write(&c, 1);
+        }
+        clientSocket->write(buf, len);
+        while (clientSocket->bytesToWrite() > 0) {
+            clientSocket->waitForBytesWritten();
+        }
+        return;
     }
-#else
+#endif
     for (char c : headbuffer) {
         fputc(c, ourfp);
     }
@@ -74,10 +84,130 @@ static void send_packet(std::string_view info, const char *buf, size_t len) {
         fputc(buf[i], ourfp);
     }
     fflush(ourfp);
-#endif
 }
 
-static int runner_start(std::string const &progJson, int sessionid) {
+// splits what a frame worker writes into packets and the log text in between,
+// the text is passed on to our own log
+struct WorkerOutput {
+    std::string pending;
+
+    template <class F>
+    void append(const char *buf, size_t n, F const &onPacket) {
+        pending.append(buf, n);
+        size_t pos = 0;
+        while (pos < pending.size()) {
+            size_t mark = pending.find("\a\b\r\t", pos, 4);
+            size_t text = mark;
+            if (mark == std::string::npos) {
+                // keep what may be the start of a marker cut by the read
+                text = pending.find('\a', std::max(pos, pending.size() - std::min<size_t>(pending.size(), 3)));
+                if (text == std::string::npos)
+                    text = pending.size();
+            }
+            std::cout << std::string_view(pending).substr(pos, text - pos);
+            pos = text;
+            if (mark == std::string::npos)
+                break;
+
+            if (pending.size() - pos < 4 + sizeof(Header))
+                break;
+            Header header;
+            std::memcpy(&header, pending.data() + pos + 4, sizeof(Header));
+            if (!header.isValid() || header.total_size < header.info_size) {
+                std::cout << std::string_view(pending).substr(pos, 4);
+                pos += 4;
+                continue;
+            }
+            if (pending.size() - pos < 4 + sizeof(Header) + header.total_size)
+                break;
+            const char *info = pending.data() + pos + 4 + sizeof(Header);
+            onPacket(std::string_view(info, header.info_size), info + header.info_size,
+                     header.total_size - header.info_size);
+            pos += 4 + sizeof(Header) + header.total_size;
+        }
+        pending.erase(0, pos);
+        std::cout.flush();
+    }
+};
+
+// computes the frames on nworkers child runners at once, each taking every
+// nworkers-th frame and writing it to the disk cache; frames are announced to
+// the editor in order as soon as all frames before them are done too
+static int runner_parallel(std::string const &progJson, int sessionid, int beginFrame, int endFrame, int nworkers) {
+    zeno::log_info("computing frames {} to {} on {} worker processes", beginFrame, endFrame, nworkers);
+
+    std::vector<std::unique_ptr<QProcess>> procs;
+    for (int i = 0; i < nworkers; i++) {
+        auto proc = std::make_unique<QProcess>();
+        proc->setReadChannel(QProcess::ProcessChannel::StandardOutput);
+        proc->setProcessChannelMode(QProcess::ProcessChannelMode::ForwardedErrorChannel);
+        proc->start(QCoreApplication::applicationFilePath(), QStringList({"-runner", QString::number(sessionid),
+                    "-frameworker", QString::number(i), QString::number(nworkers)}));
+        if (!proc->waitForStarted(-1)) {
+            zeno::log_error("frame worker {} failed to get started", i);
+            return 1;  // workers already started are killed along with their QProcess
+        }
+        proc->write(progJson.data(), progJson.size());
+        proc->closeWriteChannel();
+        procs.push_back(std::move(proc));
+    }
+
+    std::vector<char> done(endFrame - beginFrame + 1);
+    int nextFrame = beginFrame;
+    bool failed = false;
+    auto onPacket = [&] (std::string_view info, const char *buf, size_t len) {
+        rapidjson::Document doc;
+        doc.Parse(info.data(), info.size());
+        std::string action, key;
+        if (doc.IsObject()) {
+            if (auto it = doc.FindMember("action"); it != doc.MemberEnd() && it->value.IsString())
+                action = it->value.GetString();
+            if (auto it = doc.FindMember("key"); it != doc.MemberEnd() && it->value.IsString())
+                key = it->value.GetString();
+        }
+        if (action == "frameDone") {
+            int frame = std::stoi(key);
+            if (frame >= beginFrame && frame <= endFrame)
+                done[frame - beginFrame] = 1;
+            return;
+        }
+        if (action == "reportStatus")
+            failed = true;
+        send_packet(info, buf, len);
+    };
+
+    std::vector<WorkerOutput> outputs(nworkers);
+    std::vector<char> buf(1 << 20); // 1MB
+    for (bool running = true; running && !failed;) {
+        running = false;
+        for (int i = 0; i < nworkers; i++) {
+            auto &proc = procs[i];
+            if (proc->state() == QProcess::NotRunning && proc->bytesAvailable() == 0)
+                continue;
+            running = true;
+            proc->waitForReadyRead(10);
+            while (proc->bytesAvailable() > 0) {
+                qint64 redSize = proc->read(buf.data(), buf.size());
+                if (redSize <= 0)
+                    break;
+                outputs[i].append(buf.data(), redSize, onPacket);
+            }
+        }
+        for (; nextFrame <= endFrame && done[nextFrame - beginFrame]; nextFrame++) {
+            send_packet("{\"action\":\"newFrame\"}", "", 0);
+            send_packet("{\"action\":\"finishFrame\"}", "", 0);
+        }
+    }
+    if (failed)
+        return 1;
+    if (nextFrame <= endFrame) {
+        zeno::log_error("frame workers exited before computing frame {}", nextFrame);
+        return 1;
+    }
+    return 0;
+}
+
+static int runner_start(std::string const &progJson, int sessionid, int worker, int nworkers) {
     zeno::log_trace("runner got program JSON: {}", progJson);
     //MessageBox(0, "runner", "runner", MB_OK);           //convient to attach process by debugger, at windows.
     zeno::scope_exit sp([=]() { std::cout.flush(); });
@@ -88,6 +218,7 @@ static int runner_start(std::string const &progJson, int sessionid) {
     session->globalState->clearState();
     session->globalComm->clearState();
     session->globalStatus->clearState();
+    session->globalProfiler->clearState();
     auto graph = session->createGraph();
 
     auto onfail = [&] {
@@ -107,10 +238,24 @@ static int runner_start(std::string const &progJson, int sessionid) {
     std::vector<char> buffer;
 
     session->globalComm->frameRange(graph->beginFrameNumber, graph->endFrameNumber);
-    send_packet("{\"action\":\"frameRange\",\"key\":\""
-                + std::to_string(graph->beginFrameNumber)
-                + ":" + std::to_string(graph->endFrameNumber)
-                + "\"}", "", 0);
+    if (!nworkers) {
+        send_packet("{\"action\":\"frameRange\",\"key\":\""
+                    + std::to_string(graph->beginFrameNumber)
+                    + ":" + std::to_string(graph->endFrameNumber)
+                    + "\"}", "", 0);
+
+        // ZENO_PARALLEL_FRAMES=n asserts that no node keeps state across frames
+        int nparallel = std::min(zeno::envconfig::getInt("PARALLEL_FRAMES"),
+                                 graph->endFrameNumber - graph->beginFrameNumber + 1);
+        if (nparallel > 1) {
+            if (!bZenCache)
+                zeno::log_warn("parallel frames need the disk cache, computing frames in order");
+            else if (!graph->isFrameIndependent())
+                zeno::log_warn("graph carries objects across frames, computing frames in order");
+            else
+                return runner_parallel(progJson, sessionid, graph->beginFrameNumber, graph->endFrameNumber, nparallel);
+        }
+    }
 
     for (int frame = graph->beginFrameNumber; frame <= graph->endFrameNumber; frame++)
     {
@@ -119,6 +264,10 @@ static int runner_start(std::string const &progJson, int sessionid) {
 
         session->globalState->frameid = frame;
         session->globalComm->newFrame();
+        if (nworkers && (frame - graph->beginFrameNumber) % nworkers != worker) {
+            session->globalComm->finishFrame();  // other workers' frame, keeps m_frames indexed by frame
+            continue;
+        }
         session->globalState->frameBegin();
 
         while (session->globalState->substepBegin())
@@ -134,7 +283,14 @@ static int runner_start(std::string const &progJson, int sessionid) {
 
         zeno::log_debug("end frame {}", frame);
 
-        send_packet("{\"action\":\"newFrame\"}", "", 0);
+        if (!nworkers)
+            send_packet("{\"action\":\"newFrame\"}", "", 0);
+
+        if (session->globalProfiler->enabled) {
+            auto traceJson = zeno::GlobalProfiler::toChromeTrace(session->globalProfiler->collectFrame());
+            send_packet("{\"action\":\"profileFrame\",\"key\":\"" + std::to_string(frame) + "\"}",
+                traceJson.data(), traceJson.size());
+        }
 
         if (bZenCache) {
             session->globalComm->dumpFrameCache(frame);
@@ -149,7 +305,10 @@ static int runner_start(std::string const &progJson, int sessionid) {
             }
         }
 
-        send_packet("{\"action\":\"finishFrame\"}", "", 0);
+        if (nworkers)
+            send_packet("{\"action\":\"frameDone\",\"key\":\"" + std::to_string(frame) + "\"}", "", 0);
+        else
+            send_packet("{\"action\":\"finishFrame\"}", "", 0);
 
         if (session->globalStatus->failed())
             return onfail();
@@ -159,8 +318,8 @@ static int runner_start(std::string const &progJson, int sessionid) {
 
 }
 
-int runner_main(int sessionid, int port);
-int runner_main(int sessionid, int port) {
+int runner_main(int sessionid, int port, int worker, int nworkers);
+int runner_main(int sessionid, int port, int worker, int nworkers) {
 #ifdef __linux__
     stderr = freopen("/dev/stdout", "w", stderr);
 #endif
@@ -169,20 +328,24 @@ int runner_main(int sessionid, int port) {
 
     zeno::set_log_stream(std::clog);
 
+    ourfp = stdout;
 #ifdef ZENO_IPC_USE_TCP
-    zeno::log_debug("connecting to port {}", port);
-    clientSocket = std::make_unique<QTcpSocket>();
-    clientSocket->connectToHost(QHostAddress::LocalHost, port);
-    if (!clientSocket->waitForConnected(10000)) {
-        zeno::log_error("tcp client connection fail");
-        return 0;
-    } else {
-        zeno::log_info("tcp connection succeed");
+    if (!nworkers) {
+        zeno::log_debug("connecting to port {}", port);
+        clientSocket = std::make_unique<QTcpSocket>();
+        clientSocket->connectToHost(QHostAddress::LocalHost, port);
+        if (!clientSocket->waitForConnected(10000)) {
+            zeno::log_error("tcp client connection fail");
+            return 0;
+        } else {
+            zeno::log_info("tcp connection succeed");
+        }
     }
 #else
     zeno::log_debug("started IPC in pipe mode");
-    ourfp = stdout;
 #endif
+    if (nworkers)
+        zeno::log_debug("started as frame worker {} of {}", worker, nworkers);
 
     zeno::log_debug("runner started on sessionid={}", sessionid);
 
@@ -191,6 +354,6 @@ int runner_main(int sessionid, int port) {
     std::back_insert_iterator<std::string> sit(progJson);
     std::copy(iit, eiit, sit);
 
-    return runner_start(progJson, sessionid);
+    return runner_start(progJson, sessionid, worker, nworkers);
 }
 #endif
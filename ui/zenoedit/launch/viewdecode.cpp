@@ -9,10 +9,13 @@
 #include <zeno/extra/GlobalState.h>
 #include <zeno/extra/GlobalComm.h>
 #include <zeno/extra/GlobalStatus.h>
+#include <zeno/extra/GlobalProfiler.h>
+#include <zeno/utils/envconfig.h>
 #include <zeno/funcs/ObjectCodec.h>
 #include <rapidjson/document.h>
 #include <type_traits>
 #include <iostream>
+#include <fstream>
 #include <cassert>
 #include <vector>
 #include <string>
@@ -38,17 +41,32 @@ struct PacketProc {
     std::string fcPath = {};
     int fcMax = 0;
 
+    std::vector<zeno::GlobalProfiler::Record> profileRecords;
+
     void onStart() {
         globalCommNeedClean = 1;
         globalCommNeedNewFrame = 0;
         zeno::getSession().globalState->clearState();
         zeno::getSession().globalStatus->clearState();
         zeno::getSession().globalState->working = true;
+        profileRecords.clear();
     }
 
     void onFinish() {
         clearGlobalIfNeeded();
         zeno::getSession().globalState->working = false;
+        dumpProfileIfNeeded();
+    }
+
+    void dumpProfileIfNeeded() {
+        if (profileRecords.empty())
+            return;
+        if (auto path = zeno::envconfig::get("PROFILE_TRACE")) {
+            zeno::log_info("dumping chrome trace of {} node records to {}", profileRecords.size(), path);
+            std::ofstream ofs(path, std::ios::binary);
+            ofs << zeno::GlobalProfiler::toChromeTrace(profileRecords);
+        }
+        profileRecords.clear();
     }
 
     void clearGlobalIfNeeded() {
@@ -105,6 +123,11 @@ struct PacketProc {
                 zeno::getSession().globalState->frameid = beg;
             }
 
+        } else if (action == "profileFrame") {
+            auto records = zeno::GlobalProfiler::fromChromeTrace({buf, len});
+            zeno::log_info("profile of frame {}:\n{}", objKey, zeno::GlobalProfiler::summary(records, 5));
+            std::move(records.begin(), records.end(), std::back_inserter(profileRecords));
+
         } else if (action == "reportStatus") {
             std::string statJson{buf, len};
             zeno::getSession().globalStatus->fromJson(statJson);
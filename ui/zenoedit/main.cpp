@@ -15,12 +15,17 @@ int main(int argc, char *argv[])
 
 #ifdef ZENO_MULTIPROCESS
     if (argc >= 3 && !strcmp(argv[1], "-runner")) {
-        extern int runner_main(int sessionid, int port);
+        extern int runner_main(int sessionid, int port, int worker, int nworkers);
         int sessionid = atoi(argv[2]);
         int port = -1;
         if (argc >= 5 && !strcmp(argv[3], "-port"))
             port = atoi(argv[4]);
-        return runner_main(sessionid, port);
+        int worker = -1, nworkers = 0;
+        if (argc >= 6 && !strcmp(argv[3], "-frameworker")) {
+            worker = atoi(argv[4]);
+            nworkers = atoi(argv[5]);
+        }
+        return runner_main(sessionid, port, worker, nworkers);
     }
 #endif
 
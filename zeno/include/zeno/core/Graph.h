@@ -42,6 +42,7 @@ struct Graph : std::enable_shared_from_this<Graph> {
     std::map<std::string, zany> portals;
     std::map<std::string, std::string> subInputNodes;
     std::map<std::string, std::string> subOutputNodes;
+    std::map<std::string, std::string> flattenedIds;  // inlined node id -> id in its subnet
 
     std::unique_ptr<Context> ctx;
 
@@ -68,6 +69,9 @@ struct Graph : std::enable_shared_from_this<Graph> {
     ZENO_API void addNodeOutput(std::string const &id, std::string const &par);
     ZENO_API zany const &getNodeOutput(std::string const &sn, std::string const &ss) const;
     ZENO_API void loadGraph(const char *json);
+    ZENO_API void flattenSubnets();
+    ZENO_API std::string const &originalNodeId(std::string const &id) const;
+    ZENO_API bool isFrameIndependent() const;
     ZENO_API void setNodeParam(std::string const &id, std::string const &par,
         std::variant<int, float, std::string, zany> const &val);  /* to be deprecated */
     ZENO_API std::map<std::string, zany> callTempNode(std::string const &id,
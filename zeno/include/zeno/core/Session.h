@@ -25,6 +25,7 @@ struct IObject;
 struct GlobalState;
 struct GlobalComm;
 struct GlobalStatus;
+struct GlobalProfiler;
 struct EventCallbacks;
 struct UserData;
 
@@ -34,6 +35,7 @@ struct Session {
     std::unique_ptr<GlobalState> const globalState;
     std::unique_ptr<GlobalComm> const globalComm;
     std::unique_ptr<GlobalStatus> const globalStatus;
+    std::unique_ptr<GlobalProfiler> const globalProfiler;
     std::unique_ptr<EventCallbacks> const eventCallbacks;
     std::unique_ptr<UserData> const m_userData;
 
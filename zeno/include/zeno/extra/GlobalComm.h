@@ -6,6 +6,11 @@
 #include <string>
 #include <vector>
 #include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <climits>
+#include <deque>
+#include <list>
 #include <map>
 #include <set>
 
@@ -17,17 +22,48 @@ struct GlobalComm {
     struct FrameData {
         ViewObjects view_objects;
         bool b_frame_completed = false;
+        std::size_t cache_bytes = 0;  // memory taken by the objects loaded from disk, while in m_inCacheFrames
     };
+
+    // time spent in getViewObjects on disk cached frames, a step of one frame
+    // counts as playback, anything else as scrubbing; logged when the cache is reset
+    struct CacheStats {
+        struct Latency {
+            std::size_t hits = 0, misses = 0;
+            double hitMs = 0, missMs = 0, maxMissMs = 0;
+        };
+        Latency playback, scrub;
+        std::size_t prefetched = 0, evicted = 0;
+    };
+
     std::vector<FrameData> m_frames;
     int m_maxPlayFrame = 0;
     std::set<int> m_inCacheFrames;
+    std::list<int> m_lruFrames;  // frames in m_inCacheFrames, most recently used first
+    std::size_t m_cacheBytes = 0;
+    CacheStats m_cacheStats;
     mutable std::mutex m_mtx;
 
+    // frames after the requested one in the play direction are loaded ahead on a worker thread
+    int m_lastRequested = INT_MIN;
+    int m_playDirection = 1;
+    unsigned m_cacheEpoch = 0;  // bumped when the cache is reset, drops loads still in flight
+    std::set<int> m_loadingFrames;
+    std::deque<int> m_prefetchQueue;
+    std::condition_variable m_prefetchCv, m_loadedCv;
+    std::thread m_prefetchThread;
+    bool m_prefetchStop = false;
+
     int beginFrameNumber = 0;
     int endFrameNumber = 0;
-    int maxCachedFrames = 1;
+    int maxCachedFrames = 1;        // 0 disables the disk cache, else the least number of frames kept loaded
+    std::size_t maxCacheBytes = 0;  // loaded frames outside the prefetch window are evicted above this
+    int prefetchFrames = 0;
     std::string cacheFramePath;
 
+    ZENO_API GlobalComm();
+    ZENO_API ~GlobalComm();
+
     ZENO_API void frameCache(std::string const &path, int gcmax);
     ZENO_API void frameRange(int beg, int end);
     ZENO_API void newFrame();
@@ -39,6 +75,13 @@ struct GlobalComm {
     ZENO_API ViewObjects const *getViewObjects(const int frameid);
     ZENO_API ViewObjects const &getViewObjects();
     ZENO_API bool isFrameCompleted(int frameid) const;
+
+private:
+    bool loadFrame(std::unique_lock<std::mutex> &lck, int frameid);
+    void evictFrames();
+    void schedulePrefetch(int frameid);
+    void prefetchWorker();
+    void logCacheStats() const;
 };
 
 }
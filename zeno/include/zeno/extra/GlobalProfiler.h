@@ -0,0 +1,75 @@
+#pragma once
+
+#include <zeno/utils/api.h>
+#include <string_view>
+#include <cstdint>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+
+namespace zeno {
+
+struct INode;
+struct IObject;
+
+struct GlobalProfiler {
+    struct Record {
+        std::string name;
+        int frameid = 0;
+        int substepid = 0;
+        int depth = 0;
+        uint32_t tid = 0;
+        int64_t beg_us = 0;
+        int64_t dur_us = 0;
+        int64_t self_us = 0;
+        size_t alloc_bytes = 0;
+        size_t output_bytes = 0;
+    };
+
+    struct ThreadBuffer {
+        uint32_t tid = 0;
+        std::vector<Record> records;
+    };
+
+    // RAII timer wrapping one INode::apply, nested scopes are subtracted from self time
+    struct Scope {
+        GlobalProfiler *prof = nullptr;
+        INode *node = nullptr;
+        Scope *parent = nullptr;
+        int64_t beg_ns = 0;
+        int64_t child_ns = 0;
+
+        ZENO_API Scope(GlobalProfiler *prof, INode *node);
+        ZENO_API ~Scope();
+
+        Scope(Scope const &) = delete;
+        Scope &operator=(Scope const &) = delete;
+    };
+
+    std::atomic<bool> enabled{false};
+
+    ZENO_API GlobalProfiler();
+    ZENO_API ~GlobalProfiler();
+
+    // move records of all threads out, must not overlap with running nodes (e.g. call after frame end)
+    ZENO_API std::vector<Record> collectFrame();
+    ZENO_API void clearState();
+
+    ZENO_API static size_t objectByteSize(IObject const *obj);
+    ZENO_API static std::string toChromeTrace(std::vector<Record> const &records);
+    ZENO_API static std::vector<Record> fromChromeTrace(std::string_view json);
+    ZENO_API static std::string summary(std::vector<Record> const &records, size_t topn = 10);
+
+private:
+    uint64_t m_instanceid;
+    int64_t m_epoch_ns;
+    std::mutex m_mtx;  // only guards registration of thread buffers, one per thread
+    std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+
+    ThreadBuffer *threadBuffer();
+    int64_t nowNs() const;
+};
+
+}
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <zeno/core/IObject.h>
+#include <functional>
+#include <typeindex>
 #include <vector>
 #include <string>
 #include <memory>
@@ -10,4 +12,25 @@ namespace zeno {
 ZENO_API std::shared_ptr<IObject> decodeObject(const char *buf, size_t len);
 ZENO_API bool encodeObject(IObject const *object, std::vector<char> &buf);
 
+// codecs for object types living outside of the core (e.g. VDB grids in zenvdb),
+// looked up by the exact dynamic type when encoding and by name when decoding,
+// so the name is what ends up in the stream and must stay stable
+using ObjectEncoder = std::function<bool(IObject const *object, std::vector<char> &buf)>;
+using ObjectDecoder = std::function<std::shared_ptr<IObject>(const char *buf, size_t len)>;
+
+ZENO_API int registerObjectCodec(std::type_index type, std::string const &name,
+                                 ObjectEncoder encoder, ObjectDecoder decoder);
+
+// static int defFooCodec = registerObjectCodec<FooObject>("FooObject", encodeFoo, decodeFoo);
+template <class T, class Encoder, class Decoder>
+int registerObjectCodec(std::string const &name, Encoder encoder, Decoder decoder) {
+    return registerObjectCodec(typeid(T), name,
+        [encoder] (IObject const *object, std::vector<char> &buf) -> bool {
+            return encoder(static_cast<T const *>(object), buf);
+        },
+        [decoder] (const char *buf, size_t len) -> std::shared_ptr<IObject> {
+            return decoder(buf, len);
+        });
+}
+
 }
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <zeno/utils/api.h>
+#include <zeno/types/PrimitiveObject.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace zeno {
+
+// CSR topology lookup tables of a primitive, faces are numbered as all tris
+// first, then quads, then polys; a corner is one vertex slot of one face
+struct PrimitiveAdjacency {
+    uint64_t topoHash = 0;
+    int numVerts = 0;
+    int numTris = 0;
+    int numQuads = 0;
+    int numPolys = 0;
+
+    std::vector<int> faceStart;     // face -> corners, size numFaces() + 1
+    std::vector<int> corners;       // vertex of each corner, in winding order
+    std::vector<int> cornerFace;    // face of each corner
+
+    std::vector<int> vertStart;     // vertex -> corners, size numVerts + 1
+    std::vector<int> vertCorners;   // sorted by corner id (hence by face id)
+
+    bool hasEdges = false;          // the tables below are only built on request
+    std::vector<int> cornerEdge;    // edge from this corner to the next one of its face, -1 if degenerate
+    std::vector<vec2i> edges;       // unique edges of faces and lines, x < y, sorted
+    std::vector<int> edgeStart;     // edge -> corners, size edges.size() + 1
+    std::vector<int> edgeCorners;   // corners whose outgoing edge is this one, their faces are the neighbours
+
+    int numFaces() const {
+        return numTris + numQuads + numPolys;
+    }
+};
+
+// hash of the vertex count and every index of lines, tris, quads, polys and
+// loops, one parallel pass over the topology; it catches indices rewritten in
+// place as well as arrays replaced or resized
+ZENO_API uint64_t primTopologyHash(PrimitiveObject const *prim);
+// returns prim->adjacency, rebuilt only if the topology hash changed since it was cached
+ZENO_API std::shared_ptr<PrimitiveAdjacency const> primAdjacency(PrimitiveObject *prim, bool withEdges = true);
+
+}
@@ -43,9 +43,16 @@ ZENO_API void primScale(PrimitiveObject *prim, vec3f const &scale);
 
 ZENO_API std::pair<vec3f, vec3f> primBoundingBox(PrimitiveObject *prim);
 
+ZENO_API std::vector<int> primMortonOrder(PrimitiveObject *prim);
+ZENO_API void primReorderVerts(PrimitiveObject *prim, std::vector<int> const &order, std::string revampAttrO = {});
+
 ZENO_API void primRandomize(PrimitiveObject *prim, std::string attr, std::string dirAttr, std::string seedAttr, std::string randType, float base, float scale, int seed);
 ZENO_API void primPerlinNoise(PrimitiveObject *prim, std::string inAttr, std::string outAttr, std::string outType, float scale, float detail, float roughness, float disortion, vec3f offset, float average, float strength);
 
+// minRadius > 0 thins the points to a maximal Poisson-disk set: no two kept points are
+// closer than minRadius, and every dropped point has a kept one within it; the filter
+// used before also dropped points for neighbours it dropped later, and so kept only
+// about half as many points for the same radius
 ZENO_API std::shared_ptr<PrimitiveObject> primScatter(
     PrimitiveObject *prim, std::string type, std::string denAttr, float density, float minRadius, bool interpAttrs, int seed);
 
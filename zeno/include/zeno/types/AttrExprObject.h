@@ -0,0 +1,58 @@
+#pragma once
+
+#include <zeno/core/IObject.h>
+#include <zeno/types/PrimitiveObject.h>
+#include <zeno/utils/api.h>
+#include <zeno/utils/vec.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace zeno {
+
+// per-vertex expression over float, int and vec3f attributes, built up by the
+// AttrExpr nodes without touching any array and run only by eval, which takes
+// each block of vertices through all instructions while it stays in cache, so
+// a chain of ops reads its inputs and writes its output once; attributes are
+// read when eval runs, not when the expression is built
+struct AttrExprObject : IObjectClone<AttrExprObject> {
+    enum Op : unsigned char {
+        Load, Const,
+        Neg, Abs, Sqrt, Sin, Cos, Tan, Asin, Acos, Atan, Exp, Log, Floor, Ceil,
+        Add, Sub, Mul, Div, Pow, Atan2, Min, Max,
+    };
+
+    // instruction i writes register i, its operands are earlier registers, a
+    // float operand of a vec3f op is used for all three components
+    struct Inst {
+        Op op;
+        int dim;            // 1 for float, 3 for vec3f
+        int a = -1, b = -1;
+        int load = -1;      // for Load, index into loads
+        vec3f value{0};     // for Const
+    };
+
+    struct Source {
+        std::shared_ptr<PrimitiveObject> prim;
+        std::string attr;
+    };
+
+    std::vector<Inst> code;
+    std::vector<Source> loads;
+
+    int dim() const {
+        return code.back().dim;
+    }
+
+    ZENO_API static std::shared_ptr<AttrExprObject> attr(std::shared_ptr<PrimitiveObject> prim, std::string const &name);
+    ZENO_API static std::shared_ptr<AttrExprObject> constant(vec3f const &value, int dim);
+    ZENO_API static std::shared_ptr<AttrExprObject> unary(Op op, AttrExprObject const &a);
+    ZENO_API static std::shared_ptr<AttrExprObject> binary(Op op, AttrExprObject const &a, AttrExprObject const &b);
+
+    // writes the expression into a vertex attribute of prim, adding it as float or
+    // vec3f when missing, over the vertices that every attribute involved has;
+    // the output may be one of the inputs
+    ZENO_API void eval(PrimitiveObject *prim, std::string const &name) const;
+};
+
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <zeno/core/IObject.h>
+#include <zeno/types/PrimitiveObject.h>
+#include <zeno/utils/api.h>
+#include <zeno/utils/vec.h>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace zeno {
+
+// 4-wide bounding volume hierarchy over the triangles of a primitive, answers
+// ray casts and closest point queries, the child boxes of each node are stored
+// as structure of arrays so that the four slab tests compile to vector code
+struct BvhObject : IObjectClone<BvhObject> {
+    struct Node {
+        float bmin[3][4];
+        float bmax[3][4];
+        int child[4];   // inner node index if count is 0, else first triangle
+        int count[4];   // number of triangles in a leaf, 0 for inner, -1 for an empty slot
+    };
+
+    struct RayHit {
+        float t = std::numeric_limits<float>::infinity();
+        int primId = -1;    // index into prim->tris, -1 when nothing is hit
+        float u = 0, v = 0; // barycentric coordinates of the hit point
+    };
+
+    struct NearestHit {
+        float dist = std::numeric_limits<float>::infinity();
+        int primId = -1;
+        vec3f pos{0, 0, 0};
+        vec3f bary{0, 0, 0};  // weights of the three triangle vertices
+    };
+
+    std::vector<Node> nodes;
+    std::vector<vec3f> triV0, triE1, triE2;  // triangles in leaf order, v0, v1 - v0, v2 - v0
+    std::vector<int> triIds;                 // leaf order -> index into prim->tris
+    std::vector<int> triOrder;               // index into prim->tris -> leaf order
+    int depth = 0;                           // levels of nodes, bounds the traversal stack
+
+    ZENO_API void build(PrimitiveObject const *prim);
+
+    // closest hit with t in [tmin, tmax], rd needs not be normalized
+    ZENO_API RayHit intersect(vec3f const &ro, vec3f const &rd,
+                              float tmin = 0, float tmax = std::numeric_limits<float>::infinity()) const;
+    ZENO_API NearestHit nearest(vec3f const &pos, float maxDist = std::numeric_limits<float>::infinity()) const;
+
+    // query many rays or points at once, spread over threads
+    ZENO_API void intersectBatch(vec3f const *ro, vec3f const *rd, RayHit *hits, std::size_t n,
+                                 float tmin = 0, float tmax = std::numeric_limits<float>::infinity()) const;
+    ZENO_API void nearestBatch(vec3f const *pos, NearestHit *hits, std::size_t n,
+                               float maxDist = std::numeric_limits<float>::infinity()) const;
+
+    std::size_t numTris() const {
+        return triIds.size();
+    }
+};
+
+}
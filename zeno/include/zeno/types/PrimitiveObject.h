@@ -15,6 +15,7 @@ namespace zeno {
 
 struct MaterialObject;
 struct InstancingObject;
+struct PrimitiveAdjacency;
 
 struct PrimitiveObject : IObjectClone<PrimitiveObject> {
     AttrVector<vec3f> verts;
@@ -33,6 +34,19 @@ struct PrimitiveObject : IObjectClone<PrimitiveObject> {
     std::shared_ptr<MaterialObject> mtl;
     std::shared_ptr<InstancingObject> inst;
 
+    // cached topology lookup tables, see zeno/funcs/PrimitiveAdjacency.h;
+    // copies of the prim start without them, as their topology may be edited apart
+    struct AdjacencyCache {
+        std::shared_ptr<PrimitiveAdjacency const> ptr;
+
+        AdjacencyCache() = default;
+        AdjacencyCache(AdjacencyCache const &) noexcept {}
+        AdjacencyCache &operator=(AdjacencyCache const &) noexcept {
+            ptr = nullptr;
+            return *this;
+        }
+    } adjacency;
+
     // deprecated:
     template <class Accept = std::variant<vec3f, float>, class F>
     void foreach_attr(F &&f) {
@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <tuple>
+#include <zeno/utils/api.h>
 #include <zeno/utils/vec.h>
 
 namespace zeno {
@@ -104,6 +105,13 @@ static float perlin(float x, float y, float z) {
     return mix (y1, y2, w);
 }
 
+// most points one perlin_batch call takes, the lanes of an AVX-512 register
+static inline constexpr int batch = 16;
+
+// perlin() at n <= batch points given as separate coordinate arrays, the points
+// are evaluated together in vector registers
+ZENO_API static void perlin_batch(int n, float const *x, float const *y, float const *z, float *out);
+
 };
 
 struct PerlinNoise {
@@ -159,6 +167,12 @@ struct PerlinNoise {
 
         return total;
     }
+
+    static inline constexpr int batch = 16;
+
+    // perlin() at n <= batch points, as PerlinNoise1::perlin_batch
+    ZENO_API static void perlin_batch(int n, float const *x, float const *y, float const *z,
+                                      float power, float depth, float *out);
 };
 
 }
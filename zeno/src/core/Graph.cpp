@@ -7,13 +7,16 @@
 #include <zeno/core/Descriptor.h>
 #include <zeno/types/NumericObject.h>
 #include <zeno/types/StringObject.h>
+#include <zeno/types/DummyObject.h>
 #include <zeno/extra/GraphException.h>
 #include <zeno/funcs/LiterialConverter.h>
 #include <zeno/extra/GlobalStatus.h>
 #include <zeno/extra/SubnetNode.h>
 #include <zeno/utils/Error.h>
 #include <zeno/utils/log.h>
+#include <optional>
 #include <iostream>
+#include <vector>
 
 namespace zeno {
 
@@ -37,6 +40,7 @@ ZENO_API zany const &Graph::getNodeOutput(
 
 ZENO_API void Graph::clearNodes() {
     nodes.clear();
+    flattenedIds.clear();
 }
 
 ZENO_API void Graph::addNode(std::string const &cls, std::string const &id) {
@@ -79,7 +83,7 @@ ZENO_API void Graph::applyNode(std::string const &id) {
     auto node = safe_at(nodes, id, "node name").get();
     GraphException::translated([&] {
         node->doApply();
-    }, node->myname);
+    }, originalNodeId(id));
 }
 
 ZENO_API void Graph::applyNodes(std::set<std::string> const &ids) {
@@ -119,6 +123,163 @@ ZENO_API std::map<std::string, zany> Graph::callTempNode(std::string const &id,
     return std::move(se->outputs);
 }
 
+namespace {
+
+// where an input socket gets its value from after a subnet is inlined: either
+// an output socket of some node in the parent graph, or a constant value
+struct InlineSource {
+    std::string sn, ss;
+    zany value;
+};
+
+struct SubnetInliner {
+    Graph *graph;
+    std::string id;
+    SubnetNode *subnode;
+    Graph *sub;
+    std::map<std::string, std::string> inputKeys;  // SubInput node id -> subnet input key
+    std::set<std::string> outputNodes;
+
+    std::optional<InlineSource> resolveSubInput(std::string const &key, std::string const &socket) const {
+        bool hasBound = subnode->inputBounds.count(key);
+        bool hasValue = hasBound || subnode->inputs.count(key);
+        if (socket == "port") {
+            if (hasBound) {
+                auto const &[sn, ss] = subnode->inputBounds.at(key);
+                return InlineSource{sn, ss, nullptr};
+            }
+            if (hasValue)
+                return InlineSource{{}, {}, subnode->inputs.at(key)};
+            return InlineSource{{}, {}, std::make_shared<DummyObject>()};
+        } else if (socket == "hasValue") {
+            return InlineSource{{}, {}, std::make_shared<NumericObject>(hasValue)};
+        }
+        return std::nullopt;
+    }
+
+    std::optional<InlineSource> resolveInner(std::string const &sn, std::string const &ss) const {
+        if (auto it = inputKeys.find(sn); it != inputKeys.end())
+            return resolveSubInput(it->second, ss);
+        if (outputNodes.count(sn))
+            return std::nullopt;
+        return InlineSource{id + '/' + sn, ss, nullptr};
+    }
+
+    std::optional<InlineSource> resolveOuter(std::string const &key) const {
+        auto it = sub->subOutputNodes.find(key);
+        if (it == sub->subOutputNodes.end())
+            return std::nullopt;
+        auto node = safe_at(sub->nodes, it->second, "node name").get();
+        if (auto bit = node->inputBounds.find("port"); bit != node->inputBounds.end())
+            return resolveInner(bit->second.first, bit->second.second);
+        if (auto vit = node->inputs.find("port"); vit != node->inputs.end())
+            return InlineSource{{}, {}, vit->second};
+        return std::nullopt;
+    }
+
+    // all rewirings are planned before anything is touched, so that a subnet
+    // which cannot be inlined is left intact
+    bool run() {
+        if (!sub->portalIns.empty() || graph->nodesToExec.count(id))
+            return false;  // portal names and view nodes are scoped to their own graph
+        for (auto const &[key, nodeid]: sub->subInputNodes)
+            inputKeys[nodeid] = key;
+        for (auto const &[key, nodeid]: sub->subOutputNodes)
+            outputNodes.insert(nodeid);
+
+        std::vector<std::tuple<INode *, std::string, InlineSource>> plan;
+        for (auto const &[nodeid, node]: sub->nodes) {
+            if (inputKeys.count(nodeid) || outputNodes.count(nodeid))
+                continue;
+            for (auto const &[ds, bound]: node->inputBounds) {
+                auto src = resolveInner(bound.first, bound.second);
+                if (!src)
+                    return false;
+                plan.emplace_back(node.get(), ds, std::move(*src));
+            }
+        }
+        for (auto const &[nodeid, node]: graph->nodes) {
+            for (auto const &[ds, bound]: node->inputBounds) {
+                if (bound.first != id)
+                    continue;
+                auto src = resolveOuter(bound.second);
+                if (!src)
+                    return false;
+                plan.emplace_back(node.get(), ds, std::move(*src));
+            }
+        }
+
+        for (auto &[node, ds, src]: plan) {
+            if (!src.sn.empty()) {
+                node->inputBounds[ds] = std::pair(std::move(src.sn), std::move(src.ss));
+            } else {
+                node->inputBounds.erase(ds);
+                node->inputs[ds] = std::move(src.value);
+            }
+        }
+        for (auto &[nodeid, node]: sub->nodes) {
+            if (inputKeys.count(nodeid) || outputNodes.count(nodeid))
+                continue;
+            auto newid = id + '/' + nodeid;
+            graph->flattenedIds[newid] = sub->originalNodeId(nodeid);
+            node->graph = graph;
+            node->myname = newid;
+            graph->nodes[newid] = std::move(node);
+        }
+        graph->nodes.erase(id);
+        return true;
+    }
+};
+
+}
+
+// inline all subnet nodes (recursively) into this graph, so that executing them
+// no longer goes through SubnetNode::apply and a separate Graph; the inner nodes
+// are renamed to "<subnet id>/<inner id>", must not be called while executing
+ZENO_API void Graph::flattenSubnets() {
+    std::vector<std::string> subnetIds;
+    for (auto const &[id, node]: nodes) {
+        if (dynamic_cast<SubnetNode *>(node.get()))
+            subnetIds.push_back(id);
+    }
+    size_t count = 0;
+    for (auto const &id: subnetIds) {
+        auto subnode = static_cast<SubnetNode *>(nodes.at(id).get());
+        subnode->subgraph->flattenSubnets();
+        SubnetInliner inliner{this, id, subnode, subnode->subgraph.get()};
+        if (inliner.run())
+            count++;
+        else
+            log_debug("subnet {} cannot be flattened, keeping it as is", id);
+    }
+    log_debug("flattened {} of {} subnets", count, subnetIds.size());
+}
+
+// whether no node passes objects from one frame to the next, so that frames
+// may be computed out of order by separate sessions; nodes keeping solver
+// state in members can't be seen from here, the caller has to vouch for those
+ZENO_API bool Graph::isFrameIndependent() const {
+    static const char *const carriers[] = {"CacheLastFrameBegin", "CacheLastFrameEnd"};
+    for (auto const &[id, node]: nodes) {
+        for (auto name: carriers) {
+            auto it = session->nodeClasses.find(name);
+            if (it != session->nodeClasses.end() && node->nodeClass == it->second.get())
+                return false;
+        }
+        if (auto subnode = dynamic_cast<SubnetNode *>(node.get()))
+            if (subnode->subgraph && !subnode->subgraph->isFrameIndependent())
+                return false;
+    }
+    return true;
+}
+
+// the id the editor knows a node by, inlined nodes are reported under the id
+// they have in their subnet rather than the "<subnet id>/<inner id>" they run as
+ZENO_API std::string const &Graph::originalNodeId(std::string const &id) const {
+    auto it = flattenedIds.find(id);
+    return it != flattenedIds.end() ? it->second : id;
+}
+
 ZENO_API void Graph::addNodeOutput(std::string const& id, std::string const& par) {
     // add "dynamic" output which is not descriped by core.
     safe_at(nodes, id, "node name")->outputs[par] = nullptr;
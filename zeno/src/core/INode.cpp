@@ -6,11 +6,9 @@
 #include <zeno/types/NumericObject.h>
 #include <zeno/types/StringObject.h>
 #include <zeno/extra/GlobalState.h>
+#include <zeno/extra/GlobalProfiler.h>
 #include <zeno/extra/TempNode.h>
 #include <zeno/utils/Error.h>
-#ifdef ZENO_BENCHMARKING
-#include <zeno/utils/Timer.h>
-#endif
 #include <zeno/utils/safe_at.h>
 #include <zeno/utils/logger.h>
 
@@ -73,9 +71,7 @@ ZENO_API void INode::preApply() {
 
     log_debug("==> enter {}", myname);
     {
-#ifdef ZENO_BENCHMARKING
-        Timer _(myname);
-#endif
+        GlobalProfiler::Scope _(getThisSession()->globalProfiler.get(), this);
         apply();
     }
     log_debug("==> leave {}", myname);
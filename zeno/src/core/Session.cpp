@@ -3,6 +3,7 @@
 #include <zeno/extra/GlobalState.h>
 #include <zeno/extra/GlobalComm.h>
 #include <zeno/extra/GlobalStatus.h>
+#include <zeno/extra/GlobalProfiler.h>
 #include <zeno/extra/EventCallbacks.h>
 #include <zeno/types/UserData.h>
 #include <zeno/core/Graph.h>
@@ -32,6 +33,7 @@ ZENO_API Session::Session()
     : globalState(std::make_unique<GlobalState>())
     , globalComm(std::make_unique<GlobalComm>())
     , globalStatus(std::make_unique<GlobalStatus>())
+    , globalProfiler(std::make_unique<GlobalProfiler>())
     , eventCallbacks(std::make_unique<EventCallbacks>())
     , m_userData(std::make_unique<UserData>())
     {
@@ -5,6 +5,7 @@
 #include <zeno/funcs/ParseObjectFromUi.h>
 #include <zeno/extra/GraphException.h>
 #include <zeno/utils/logger.h>
+#include <zeno/utils/envconfig.h>
 #include <zeno/utils/vec.h>
 #include <zeno/utils/zeno_p.h>
 #include <zeno/zeno.h>
@@ -106,6 +107,8 @@ ZENO_API void Graph::loadGraph(const char *json) {
                 this->beginFrameNumber = di[1].GetInt();
             } else if (cmd == "setEndFrameNumber") {
                 this->endFrameNumber = di[1].GetInt();
+            } else if (cmd == "flattenSubnets") {
+                g->flattenSubnets();
             } else if (cmd == "setNodeOption") {
                 // skip this for compatibility
             } else {
@@ -113,6 +116,9 @@ ZENO_API void Graph::loadGraph(const char *json) {
             }
         }, maybeNodeName);
     }
+
+    if (envconfig::getBool("FLATTEN_SUBNETS"))
+        flattenSubnets();
 }
 
 }
@@ -11,6 +11,7 @@
 #include <zeno/core/Session.h>
 #include <zeno/core/Graph.h>
 #include <set>
+#include <atomic>
 #include <stdexcept>
 #include <memory>
 #include <cstring>
@@ -19,33 +20,128 @@ using namespace zeno;
 
 namespace {
 
+    // slot/generation handle table: handle = (generation << 32) | (slot index + 1)
+    // slots never move once allocated, so lookups only touch atomics and take no lock
     template <class T>
     class LUT {
-        std::map<std::shared_ptr<T>, uint32_t> lut;
+        static constexpr uint32_t kChunkBits = 12;
+        static constexpr uint32_t kChunkSize = 1u << kChunkBits;
+        static constexpr uint32_t kMaxChunks = 1u << 14;
+
+        struct Slot {
+            std::atomic<uint32_t> generation{1};
+            std::atomic<uint32_t> refcount{0};
+            std::atomic<uint32_t> nextFree{0};
+            std::shared_ptr<T> ptr;
+        };
+
+        std::unique_ptr<std::atomic<Slot *>[]> chunks{new std::atomic<Slot *>[kMaxChunks]{}};
+        std::atomic<uint32_t> numSlots{0};
+        std::atomic<uint64_t> freeHead{0};  // (aba tag << 32) | (slot index + 1)
+
+        Slot &slotAt(uint32_t index) const {
+            return chunks[index >> kChunkBits].load(std::memory_order_acquire)[index & (kChunkSize - 1)];
+        }
+
+        Slot *findSlot(uint32_t index) const {
+            if (ZENO_UNLIKELY(index >= numSlots.load(std::memory_order_acquire)))
+                return nullptr;
+            auto chunk = chunks[index >> kChunkBits].load(std::memory_order_acquire);
+            if (ZENO_UNLIKELY(!chunk))
+                return nullptr;
+            return &chunk[index & (kChunkSize - 1)];
+        }
+
+        uint32_t allocSlot() {
+            uint64_t head = freeHead.load(std::memory_order_acquire);
+            while (uint32_t top = static_cast<uint32_t>(head)) {
+                uint32_t next = slotAt(top - 1).nextFree.load(std::memory_order_relaxed);
+                uint64_t newHead = ((head >> 32) + 1) << 32 | next;
+                if (freeHead.compare_exchange_weak(head, newHead, std::memory_order_acq_rel))
+                    return top - 1;
+            }
+            uint32_t index = numSlots.load(std::memory_order_relaxed);
+            while (true) {
+                if (ZENO_UNLIKELY(index >= kChunkSize * kMaxChunks))
+                    throw makeError("too many zeno handles of type " + cppdemangle(typeid(T)));
+                auto &chunk = chunks[index >> kChunkBits];
+                if (!chunk.load(std::memory_order_acquire)) {
+                    auto newChunk = new Slot[kChunkSize];
+                    Slot *expected = nullptr;
+                    if (!chunk.compare_exchange_strong(expected, newChunk, std::memory_order_acq_rel))
+                        delete[] newChunk;
+                }
+                if (numSlots.compare_exchange_weak(index, index + 1, std::memory_order_acq_rel))
+                    return index;
+            }
+        }
+
+        void freeSlot(uint32_t index) {
+            auto &slot = slotAt(index);
+            slot.ptr = nullptr;
+            slot.generation.fetch_add(1, std::memory_order_release);
+            uint64_t head = freeHead.load(std::memory_order_acquire);
+            do {
+                slot.nextFree.store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+            } while (!freeHead.compare_exchange_weak(head, ((head >> 32) + 1) << 32 | (index + 1),
+                                                     std::memory_order_acq_rel));
+        }
+
+        void release(Slot &slot, uint32_t index) {
+            if (slot.refcount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                freeSlot(index);
+        }
+
+        // pins the slot by taking one reference, so that its ptr can't be freed while reading
+        Slot &acquire(uint64_t key) const {
+            uint32_t index = static_cast<uint32_t>(key) - 1;
+            uint32_t gen = static_cast<uint32_t>(key >> 32);
+            Slot *slot = static_cast<uint32_t>(key) ? findSlot(index) : nullptr;
+            if (ZENO_UNLIKELY(!slot))
+                throw makeError<KeyError>(std::to_string(key), cppdemangle(typeid(T)));
+            uint32_t rc = slot->refcount.load(std::memory_order_relaxed);
+            do {
+                if (ZENO_UNLIKELY(rc == 0))
+                    throw makeError<KeyError>(std::to_string(key), cppdemangle(typeid(T)));
+            } while (!slot->refcount.compare_exchange_weak(rc, rc + 1, std::memory_order_acquire));
+            if (ZENO_UNLIKELY(slot->generation.load(std::memory_order_acquire) != gen)) {
+                const_cast<LUT *>(this)->release(*slot, index);
+                throw makeError<KeyError>(std::to_string(key), cppdemangle(typeid(T)));
+            }
+            return *slot;
+        }
 
     public:
+        ~LUT() {
+            for (uint32_t i = 0; i < kMaxChunks; i++)
+                delete[] chunks[i].load(std::memory_order_relaxed);
+        }
+
         uint64_t create(std::shared_ptr<T> p) {
-            T *raw_p = p.get();
-            auto [it, succ] = lut.emplace(std::move(p), 0);
-            ++it->second;
-            return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(raw_p));
+            uint32_t index = allocSlot();
+            auto &slot = slotAt(index);
+            slot.ptr = std::move(p);
+            uint32_t gen = slot.generation.load(std::memory_order_relaxed);
+            slot.refcount.store(1, std::memory_order_release);
+            return static_cast<uint64_t>(gen) << 32 | (index + 1);
         }
 
-        std::shared_ptr<T> const &access(uint64_t key) const {
-            T *raw_p = reinterpret_cast<T *>(static_cast<uint64_t>(key));
-            auto it = lut.find(make_stale_shared(raw_p));
-            if (ZENO_UNLIKELY(it == lut.end()))
-                throw makeError<KeyError>(std::to_string(key), cppdemangle(typeid(T)));
-            return it->first;
+        void incref(uint64_t key) {
+            acquire(key);
+        }
+
+        std::shared_ptr<T> access(uint64_t key) const {
+            auto &slot = acquire(key);
+            auto ptr = slot.ptr;
+            const_cast<LUT *>(this)->release(slot, static_cast<uint32_t>(key) - 1);
+            return ptr;
         }
 
         void destroy(uint64_t key) {
-            T *raw_p = reinterpret_cast<T *>(static_cast<uint64_t>(key));
-            auto it = lut.find(make_stale_shared(raw_p));
-            if (ZENO_UNLIKELY(it == lut.end()))
-                throw makeError<KeyError>(std::to_string(key), cppdemangle(typeid(T)));
-            if (--it->second <= 0)
-                lut.erase(it);
+            auto &slot = acquire(key);
+            uint32_t index = static_cast<uint32_t>(key) - 1;
+            release(slot, index);
+            release(slot, index);
         }
     };
 
@@ -84,8 +180,8 @@ namespace {
     LUT<Session> lutSession;
     LUT<Graph> lutGraph;
     LUT<IObject> lutObject;
-    LastError lastError;
-    std::map<std::string, std::shared_ptr<IObject>> tempNodeRes;
+    thread_local LastError lastError;
+    thread_local std::map<std::string, std::shared_ptr<IObject>> tempNodeRes;
     std::shared_ptr<Graph> currentGraph;
 
     static auto &getObjFactory() {
@@ -126,7 +222,7 @@ ZENO_CAPI Zeno_Error Zeno_DestroyGraph(Zeno_Graph graph_) ZENO_CAPI_NOEXCEPT {
 
 ZENO_CAPI Zeno_Error Zeno_GraphIncReference(Zeno_Graph graph_) ZENO_CAPI_NOEXCEPT {
     return lastError.catched([=] {
-        lutGraph.create(lutGraph.access(graph_));
+        lutGraph.incref(graph_);
     });
 }
 
@@ -202,16 +298,33 @@ ZENO_CAPI Zeno_Error Zeno_DestroyObject(Zeno_Object object_) ZENO_CAPI_NOEXCEPT
     });
 }
 
+ZENO_CAPI Zeno_Error Zeno_CreateObjectPrimitives(Zeno_Object *objectsRet_, size_t count_) ZENO_CAPI_NOEXCEPT {
+    return lastError.catched([=] {
+        for (size_t i = 0; i < count_; i++) {
+            objectsRet_[i] = lutObject.create(std::make_shared<PrimitiveObject>());
+        }
+    });
+}
+
+ZENO_CAPI Zeno_Error Zeno_DestroyObjects(const Zeno_Object *objects_, size_t count_) ZENO_CAPI_NOEXCEPT {
+    return lastError.catched([=] {
+        for (size_t i = 0; i < count_; i++) {
+            lutObject.destroy(objects_[i]);
+        }
+    });
+}
+
 ZENO_CAPI Zeno_Error Zeno_ObjectIncReference(Zeno_Object object_) ZENO_CAPI_NOEXCEPT {
     return lastError.catched([=] {
-        lutObject.create(lutObject.access(object_));
+        lutObject.incref(object_);
     });
 }
 
 ZENO_CAPI Zeno_Error Zeno_GetObjectLiterialType(Zeno_Object object_, int *typeRet_) ZENO_CAPI_NOEXCEPT {
     return lastError.catched([=] {
         *typeRet_ = [&] {
-            auto optr = lutObject.access(object_).get();
+            auto objPtr = lutObject.access(object_);
+            auto optr = objPtr.get();
             if (auto strptr = dynamic_cast<StringObject *>(optr)) {
                 return 1;
             }
@@ -240,7 +353,8 @@ ZENO_CAPI Zeno_Error Zeno_GetObjectLiterialType(Zeno_Object object_, int *typeRe
 
 ZENO_CAPI Zeno_Error Zeno_GetObjectInt(Zeno_Object object_, int *value_, size_t dim_) ZENO_CAPI_NOEXCEPT {
     return lastError.catched([=] {
-        auto optr = lutObject.access(object_).get();
+        auto objPtr = lutObject.access(object_);
+        auto optr = objPtr.get();
         auto ptr = dynamic_cast<NumericObject *>(optr);
         if (ZENO_UNLIKELY(ptr == nullptr))
             throw makeError<TypeError>(typeid(NumericObject), typeid(*optr), "get object as numeric");
@@ -268,7 +382,8 @@ ZENO_CAPI Zeno_Error Zeno_GetObjectInt(Zeno_Object object_, int *value_, size_t
 
 ZENO_CAPI Zeno_Error Zeno_GetObjectFloat(Zeno_Object object_, float *value_, size_t dim_) ZENO_CAPI_NOEXCEPT {
     return lastError.catched([=] {
-        auto optr = lutObject.access(object_).get();
+        auto objPtr = lutObject.access(object_);
+        auto optr = objPtr.get();
         auto ptr = dynamic_cast<NumericObject *>(optr);
         if (ZENO_UNLIKELY(ptr == nullptr))
             throw makeError<TypeError>(typeid(NumericObject), typeid(*optr), "get object as numeric");
@@ -296,7 +411,8 @@ ZENO_CAPI Zeno_Error Zeno_GetObjectFloat(Zeno_Object object_, float *value_, siz
 
 ZENO_CAPI Zeno_Error Zeno_GetObjectString(Zeno_Object object_, char *strBuf_, size_t *strLenRet_) ZENO_CAPI_NOEXCEPT {
     return lastError.catched([=] {
-        auto optr = lutObject.access(object_).get();
+        auto objPtr = lutObject.access(object_);
+        auto optr = objPtr.get();
         auto ptr = dynamic_cast<StringObject *>(optr);
         if (ZENO_UNLIKELY(ptr == nullptr))
             throw makeError<TypeError>(typeid(StringObject), typeid(*optr), "get object as string");
@@ -309,7 +425,8 @@ ZENO_CAPI Zeno_Error Zeno_GetObjectString(Zeno_Object object_, char *strBuf_, si
 
 ZENO_CAPI Zeno_Error Zeno_GetObjectPrimData(Zeno_Object object_, Zeno_PrimMembType primArrType_, const char *attrName_, void **ptrRet_, size_t *lenRet_, Zeno_PrimDataType *typeRet_) ZENO_CAPI_NOEXCEPT {
     return lastError.catched([=] {
-        auto optr = lutObject.access(object_).get();
+        auto objPtr = lutObject.access(object_);
+        auto optr = objPtr.get();
         auto prim = dynamic_cast<PrimitiveObject *>(optr);
         if (ZENO_UNLIKELY(prim == nullptr))
             throw makeError<TypeError>(typeid(PrimitiveObject), typeid(*optr), "get object as primitive");
@@ -336,9 +453,41 @@ ZENO_CAPI Zeno_Error Zeno_GetObjectPrimData(Zeno_Object object_, Zeno_PrimMembTy
     });
 }
 
+ZENO_CAPI Zeno_Error Zeno_GetObjectsPrimData(const Zeno_Object *objects_, size_t count_, Zeno_PrimMembType primArrType_, const char *attrName_, void **ptrsRet_, size_t *lensRet_, Zeno_PrimDataType *typesRet_) ZENO_CAPI_NOEXCEPT {
+    return lastError.catched([=] {
+        auto memb = invoker_variant(static_cast<size_t>(primArrType_),
+            &PrimitiveObject::verts,
+            &PrimitiveObject::points,
+            &PrimitiveObject::lines,
+            &PrimitiveObject::tris,
+            &PrimitiveObject::quads,
+            &PrimitiveObject::loops,
+            &PrimitiveObject::polys,
+            &PrimitiveObject::uvs,
+            &PrimitiveObject::loop_uvs);
+        std::string attrName = attrName_;
+        std::visit([&] (auto const &memb) {
+            for (size_t i = 0; i < count_; i++) {
+                auto objPtr = lutObject.access(objects_[i]);
+                auto optr = objPtr.get();
+                auto prim = dynamic_cast<PrimitiveObject *>(optr);
+                if (ZENO_UNLIKELY(prim == nullptr))
+                    throw makeError<TypeError>(typeid(PrimitiveObject), typeid(*optr), "get object as primitive");
+                memb(*prim).template attr_visit<AttrAcceptAll>(attrName, [&] (auto &arr) {
+                    ptrsRet_[i] = reinterpret_cast<void *>(arr.data());
+                    lensRet_[i] = arr.size();
+                    using T = std::decay_t<decltype(arr[0])>;
+                    typesRet_[i] = static_cast<Zeno_PrimDataType>(variant_index<AttrAcceptAll, T>::value);
+                });
+            }
+        }, memb);
+    });
+}
+
 ZENO_CAPI Zeno_Error Zeno_AddObjectPrimAttr(Zeno_Object object_, Zeno_PrimMembType primArrType_, const char *attrName_, Zeno_PrimDataType dataType_) ZENO_CAPI_NOEXCEPT {
     return lastError.catched([=] {
-        auto optr = lutObject.access(object_).get();
+        auto objPtr = lutObject.access(object_);
+        auto optr = objPtr.get();
         auto prim = dynamic_cast<PrimitiveObject *>(optr);
         if (ZENO_UNLIKELY(prim == nullptr))
             throw makeError<TypeError>(typeid(PrimitiveObject), typeid(*optr), "get object as primitive");
@@ -364,7 +513,8 @@ ZENO_CAPI Zeno_Error Zeno_AddObjectPrimAttr(Zeno_Object object_, Zeno_PrimMembTy
 
 ZENO_CAPI Zeno_Error Zeno_GetObjectPrimDataKeys(Zeno_Object object_, Zeno_PrimMembType primArrType_, size_t *lenRet_, const char **keysRet_) ZENO_CAPI_NOEXCEPT {
     return lastError.catched([=] {
-        auto optr = lutObject.access(object_).get();
+        auto objPtr = lutObject.access(object_);
+        auto optr = objPtr.get();
         auto prim = dynamic_cast<PrimitiveObject *>(optr);
         if (ZENO_UNLIKELY(prim == nullptr))
             throw makeError<TypeError>(typeid(PrimitiveObject), typeid(*optr), "get object as primitive");
@@ -393,7 +543,8 @@ ZENO_CAPI Zeno_Error Zeno_GetObjectPrimDataKeys(Zeno_Object object_, Zeno_PrimMe
 
 ZENO_CAPI Zeno_Error Zeno_ResizeObjectPrimData(Zeno_Object object_, Zeno_PrimMembType primArrType_, size_t newSize_) ZENO_CAPI_NOEXCEPT {
     return lastError.catched([=] {
-        auto optr = lutObject.access(object_).get();
+        auto objPtr = lutObject.access(object_);
+        auto optr = objPtr.get();
         auto prim = dynamic_cast<PrimitiveObject *>(optr);
         if (ZENO_UNLIKELY(prim == nullptr))
             throw makeError<TypeError>(typeid(PrimitiveObject), typeid(*optr), "get object as primitive");
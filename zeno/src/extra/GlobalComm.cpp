@@ -1,9 +1,12 @@
 #include <zeno/extra/GlobalComm.h>
 #include <zeno/extra/GlobalState.h>
+#include <zeno/extra/GlobalProfiler.h>
 #include <zeno/funcs/ObjectCodec.h>
+#include <zeno/utils/envconfig.h>
 #include <zeno/utils/log.h>
 #include <filesystem>
 #include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <cassert>
 
@@ -34,13 +37,18 @@ static void toDisk(std::string cachedir, int frameid, GlobalComm::ViewObjects &o
     objs.clear();
 }
 
-static bool fromDisk(std::string cachedir, int frameid, GlobalComm::ViewObjects &objs) {
+static bool fromDisk(std::string cachedir, int frameid, GlobalComm::ViewObjects &objs, std::size_t &bytes) {
     if (cachedir.empty()) return false;
     objs.clear();
     auto path = std::filesystem::u8path(cachedir) / (std::to_string(1000000 + frameid).substr(1) + ".zencache");
     log_critical("load cache from disk {}", path);
 
-    auto szBuffer = std::filesystem::file_size(path);
+    std::error_code ec;
+    auto szBuffer = std::filesystem::file_size(path, ec);
+    if (ec) {
+        log_error("zeno cache file does not exist");
+        return false;
+    }
     std::vector<char> dat(szBuffer);
     FILE* fp = fopen(path.string().c_str(), "rb");
     if (!fp) {
@@ -77,17 +85,38 @@ static bool fromDisk(std::string cachedir, int frameid, GlobalComm::ViewObjects
     std::vector<size_t> poses(keyscount + 1);
     std::copy_n(dat.data() + pos, (keyscount + 1) * sizeof(size_t), (char *)poses.data());
     pos += (keyscount + 1) * sizeof(size_t);
+    bytes = 0;
     for (int k = 0; k < keyscount; k++) {
         if (poses[k] > dat.size() - pos || poses[k + 1] < poses[k]) {
             log_error("zeno cache file broken (4.{})", k);
             return true;
         }
         const char *p = dat.data() + pos + poses[k];
-        objs.try_emplace(keys[k], decodeObject(p, poses[k + 1] - poses[k]));
+        auto obj = decodeObject(p, poses[k + 1] - poses[k]);
+        // what the object takes in memory, its encoded size for types that can't be measured
+        auto nbytes = GlobalProfiler::objectByteSize(obj.get());
+        bytes += nbytes ? nbytes : poses[k + 1] - poses[k];
+        objs.try_emplace(keys[k], std::move(obj));
     }
     return true;
 }
 
+ZENO_API GlobalComm::GlobalComm()
+    : maxCacheBytes(envconfig::getUint64("FRAME_CACHE_MB", 2048) << 20)
+    , prefetchFrames(envconfig::getInt("FRAME_PREFETCH", 4)) {
+}
+
+ZENO_API GlobalComm::~GlobalComm() {
+    logCacheStats();
+    {
+        std::lock_guard lck(m_mtx);
+        m_prefetchStop = true;
+    }
+    m_prefetchCv.notify_all();
+    if (m_prefetchThread.joinable())
+        m_prefetchThread.join();
+}
+
 ZENO_API void GlobalComm::newFrame() {
     std::lock_guard lck(m_mtx);
     log_debug("GlobalComm::newFrame {}", m_frames.size());
@@ -120,14 +149,22 @@ ZENO_API void GlobalComm::addViewObject(std::string const &key, std::shared_ptr<
 
 ZENO_API void GlobalComm::clearState() {
     std::lock_guard lck(m_mtx);
+    logCacheStats();
     m_frames.clear();
     m_inCacheFrames.clear();
+    m_lruFrames.clear();
+    m_cacheBytes = 0;
+    m_cacheStats = {};
+    m_prefetchQueue.clear();
+    m_lastRequested = INT_MIN;
+    m_cacheEpoch++;
     m_maxPlayFrame = 0;
     maxCachedFrames = 1;
     cacheFramePath = {};
 }
 
 ZENO_API void GlobalComm::frameCache(std::string const &path, int gcmax) {
+    std::lock_guard lck(m_mtx);
     cacheFramePath = path;
     maxCachedFrames = gcmax;
 }
@@ -142,30 +179,131 @@ ZENO_API int GlobalComm::maxPlayFrames() {
     return m_maxPlayFrame + beginFrameNumber; // m_frames.size();
 }
 
+// loads the frame from disk with the lock released, or waits for the prefetcher
+// if it is already loading it, false when it couldn't be loaded or the cache was
+// reset meanwhile
+bool GlobalComm::loadFrame(std::unique_lock<std::mutex> &lck, int frameid) {
+    while (m_loadingFrames.count(frameid))
+        m_loadedCv.wait(lck);
+    if (m_inCacheFrames.count(frameid))
+        return true;
+
+    unsigned epoch = m_cacheEpoch;
+    auto path = cacheFramePath;
+    m_loadingFrames.insert(frameid);
+    lck.unlock();
+    ViewObjects objs;
+    std::size_t bytes = 0;
+    bool ret = fromDisk(path, frameid, objs, bytes);
+    lck.lock();
+    m_loadingFrames.erase(frameid);
+    m_loadedCv.notify_all();
+
+    int frameIdx = frameid - beginFrameNumber;
+    if (!ret || epoch != m_cacheEpoch || frameIdx < 0 || frameIdx >= m_frames.size())
+        return false;
+    auto &frame = m_frames[frameIdx];
+    frame.view_objects = std::move(objs);
+    frame.cache_bytes = bytes;
+    m_cacheBytes += bytes;
+    m_inCacheFrames.insert(frameid);
+    m_lruFrames.push_front(frameid);
+    return true;
+}
+
+// drops the least recently used frames outside the prefetch window until the
+// loaded frames fit in maxCacheBytes, keeping at least maxCachedFrames of them
+void GlobalComm::evictFrames() {
+    auto inWindow = [&] (int frameid) {
+        long long ahead = ((long long)frameid - m_lastRequested) * m_playDirection;
+        return ahead >= 0 && ahead <= prefetchFrames;
+    };
+    auto it = m_lruFrames.end();
+    while (m_cacheBytes > maxCacheBytes && m_lruFrames.size() > (std::size_t)std::max(maxCachedFrames, 1)
+           && it != m_lruFrames.begin()) {
+        --it;
+        if (inWindow(*it))
+            continue;
+        // the objects stay alive in the viewport as long as it holds them
+        auto &frame = m_frames[*it - beginFrameNumber];
+        frame.view_objects.clear();
+        m_cacheBytes -= frame.cache_bytes;
+        frame.cache_bytes = 0;
+        m_inCacheFrames.erase(*it);
+        it = m_lruFrames.erase(it);
+        m_cacheStats.evicted++;
+    }
+}
+
+void GlobalComm::schedulePrefetch(int frameid) {
+    m_prefetchQueue.clear();
+    if (prefetchFrames <= 0 || cacheFramePath.empty())
+        return;
+    for (int k = 1; k <= prefetchFrames; k++) {
+        int next = frameid + k * m_playDirection;
+        int frameIdx = next - beginFrameNumber;
+        // only finished frames have been dumped to disk
+        if (frameIdx < 0 || frameIdx >= m_maxPlayFrame || frameIdx >= m_frames.size())
+            break;
+        if (!m_inCacheFrames.count(next) && !m_loadingFrames.count(next))
+            m_prefetchQueue.push_back(next);
+    }
+    if (m_prefetchQueue.empty())
+        return;
+    if (!m_prefetchThread.joinable())
+        m_prefetchThread = std::thread([this] { prefetchWorker(); });
+    m_prefetchCv.notify_one();
+}
+
+void GlobalComm::prefetchWorker() {
+    std::unique_lock lck(m_mtx);
+    while (true) {
+        m_prefetchCv.wait(lck, [this] { return m_prefetchStop || !m_prefetchQueue.empty(); });
+        if (m_prefetchStop)
+            return;
+        int frameid = m_prefetchQueue.front();
+        m_prefetchQueue.pop_front();
+        if (m_inCacheFrames.count(frameid) || m_loadingFrames.count(frameid))
+            continue;
+        if (loadFrame(lck, frameid)) {
+            log_debug("prefetched frame {}", frameid);
+            m_cacheStats.prefetched++;
+            evictFrames();
+        }
+    }
+}
+
 ZENO_API GlobalComm::ViewObjects const *GlobalComm::getViewObjects(const int frameid) {
+    auto t0 = std::chrono::steady_clock::now();
     int frameIdx = frameid - beginFrameNumber;
-    std::lock_guard lck(m_mtx);
+    std::unique_lock lck(m_mtx);
     if (frameIdx < 0 || frameIdx >= m_frames.size())
         return nullptr;
     if (maxCachedFrames != 0) {
-        // load back one gc:
-        if (!m_inCacheFrames.count(frameid)) {  // notinmem then cacheit
-            bool ret = fromDisk(cacheFramePath, frameid, m_frames[frameIdx].view_objects);
-            if (!ret)
-                return nullptr;
-            m_inCacheFrames.insert(frameid);
-            // and dump one as balance:
-            if (m_inCacheFrames.size() && m_inCacheFrames.size() > maxCachedFrames) { // notindisk then dumpit
-                for (int i: m_inCacheFrames) {
-                    if (i != frameid) {
-                        // seems that objs will not be modified when load_objects called later.
-                        // so, there is no need to dump.
-                        //toDisk(cacheFramePath, i, m_frames[i - beginFrameNumber].view_objects);
-                        m_inCacheFrames.erase(i);
-                        break;
-                    }
-                }
-            }
+        long long step = (long long)frameid - m_lastRequested;
+        bool playback = step == 1 || step == -1;
+        if (playback)
+            m_playDirection = (int)step;
+        m_lastRequested = frameid;
+
+        bool hit = m_inCacheFrames.count(frameid);
+        if (!hit && !loadFrame(lck, frameid))
+            return nullptr;
+        m_lruFrames.remove(frameid);
+        m_lruFrames.push_front(frameid);
+        evictFrames();
+        schedulePrefetch(frameid);
+
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        auto &lat = playback ? m_cacheStats.playback : m_cacheStats.scrub;
+        if (hit) {
+            lat.hits++;
+            lat.hitMs += ms;
+        } else {
+            lat.misses++;
+            lat.missMs += ms;
+            lat.maxMissMs = std::max(lat.maxMissMs, ms);
+            log_debug("frame {} missed the cache, loaded in {} ms", frameid, ms);
         }
     }
     return &m_frames[frameIdx].view_objects;
@@ -176,6 +314,24 @@ ZENO_API GlobalComm::ViewObjects const &GlobalComm::getViewObjects() {
     return m_frames.back().view_objects;
 }
 
+// summary of the disk cache for the run that is over, nothing if it wasn't used
+void GlobalComm::logCacheStats() const {
+    auto const &st = m_cacheStats;
+    auto avg = [] (double ms, std::size_t n) {
+        return n ? ms / n : 0.0;
+    };
+    if (!st.playback.hits && !st.playback.misses && !st.scrub.hits && !st.scrub.misses)
+        return;
+    log_info("frame cache: playback {} hits ({:.3} ms avg) {} misses ({:.3} ms avg, {:.3} ms max), "
+             "scrub {} hits ({:.3} ms avg) {} misses ({:.3} ms avg, {:.3} ms max), "
+             "{} prefetched, {} evicted, {} MB resident",
+             st.playback.hits, avg(st.playback.hitMs, st.playback.hits),
+             st.playback.misses, avg(st.playback.missMs, st.playback.misses), st.playback.maxMissMs,
+             st.scrub.hits, avg(st.scrub.hitMs, st.scrub.hits),
+             st.scrub.misses, avg(st.scrub.missMs, st.scrub.misses), st.scrub.maxMissMs,
+             st.prefetched, st.evicted, m_cacheBytes >> 20);
+}
+
 ZENO_API bool GlobalComm::isFrameCompleted(int frameid) const {
     frameid -= beginFrameNumber;
     if (frameid < 0 || frameid >= m_frames.size())
@@ -0,0 +1,305 @@
+#include <zeno/extra/GlobalProfiler.h>
+#include <zeno/core/INode.h>
+#include <zeno/core/Graph.h>
+#include <zeno/core/Session.h>
+#include <zeno/extra/GlobalState.h>
+#include <zeno/types/PrimitiveObject.h>
+#include <zeno/types/ListObject.h>
+#include <zeno/types/DictObject.h>
+#include <zeno/types/StringObject.h>
+#include <zeno/types/NumericObject.h>
+#include <zeno/utils/envconfig.h>
+#include <zeno/utils/cformat.h>
+#include <zeno/utils/log.h>
+#include <rapidjson/document.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <set>
+
+namespace zeno {
+
+namespace {
+
+std::atomic<uint64_t> g_instanceCounter{0};
+std::atomic<uint32_t> g_threadCounter{0};
+
+struct ThreadLocalState {
+    uint64_t instanceid = 0;
+    GlobalProfiler::ThreadBuffer *buffer = nullptr;
+    GlobalProfiler::Scope *current = nullptr;
+    int depth = 0;
+    uint32_t tid = g_threadCounter++;
+};
+
+thread_local ThreadLocalState tls;
+
+template <class T>
+size_t attrVectorByteSize(AttrVector<T> const &av) {
+    size_t res = av.values.size() * sizeof(T);
+    for (auto const &[key, arr]: av.attrs) {
+        std::visit([&] (auto const &arr) {
+            res += arr.size() * sizeof(arr[0]);
+        }, arr);
+    }
+    return res;
+}
+
+}
+
+ZENO_API GlobalProfiler::GlobalProfiler()
+    : m_instanceid(++g_instanceCounter)
+    , m_epoch_ns(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count())
+{
+    enabled = envconfig::getBool("PROFILE");
+}
+
+ZENO_API GlobalProfiler::~GlobalProfiler() = default;
+
+int64_t GlobalProfiler::nowNs() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count() - m_epoch_ns;
+}
+
+GlobalProfiler::ThreadBuffer *GlobalProfiler::threadBuffer() {
+    if (tls.instanceid == m_instanceid)
+        return tls.buffer;
+    // the thread may have recorded into this profiler before switching to another
+    // session, reuse the buffer it registered then instead of adding one per switch
+    std::lock_guard lck(m_mtx);
+    auto it = std::find_if(m_buffers.begin(), m_buffers.end(), [] (auto const &buf) {
+        return buf->tid == tls.tid;
+    });
+    if (it == m_buffers.end()) {
+        it = m_buffers.insert(m_buffers.end(), std::make_unique<ThreadBuffer>());
+        (*it)->tid = tls.tid;
+    }
+    tls.instanceid = m_instanceid;
+    tls.buffer = it->get();
+    return tls.buffer;
+}
+
+ZENO_API GlobalProfiler::Scope::Scope(GlobalProfiler *prof_, INode *node_) {
+    if (!prof_ || !prof_->enabled.load(std::memory_order_relaxed))
+        return;
+    prof = prof_;
+    node = node_;
+    parent = tls.current;
+    tls.current = this;
+    tls.depth++;
+    beg_ns = prof->nowNs();
+}
+
+ZENO_API GlobalProfiler::Scope::~Scope() {
+    if (!prof)
+        return;
+    int64_t end_ns = prof->nowNs();
+    int64_t dur_ns = end_ns - beg_ns;
+    tls.current = parent;
+    tls.depth--;
+    if (parent)
+        parent->child_ns += dur_ns;
+
+    std::set<IObject const *> inputObjs;
+    for (auto const &[key, obj]: node->inputs) {
+        inputObjs.insert(obj.get());
+    }
+    size_t outputBytes = 0, allocBytes = 0;
+    for (auto const &[key, obj]: node->outputs) {
+        size_t nbytes = objectByteSize(obj.get());
+        outputBytes += nbytes;
+        // outputs that are not passed-through inputs are new allocations of this node
+        if (!inputObjs.count(obj.get()))
+            allocBytes += nbytes;
+    }
+
+    auto &rec = prof->threadBuffer()->records.emplace_back();
+    rec.name = node->graph ? node->graph->originalNodeId(node->myname) : node->myname;
+    if (auto state = node->graph ? node->graph->session->globalState.get() : nullptr) {
+        rec.frameid = state->frameid;
+        rec.substepid = state->substepid;
+    }
+    rec.depth = tls.depth;
+    rec.tid = tls.tid;
+    rec.beg_us = beg_ns / 1000;
+    rec.dur_us = dur_ns / 1000;
+    rec.self_us = (dur_ns - child_ns) / 1000;
+    rec.alloc_bytes = allocBytes;
+    rec.output_bytes = outputBytes;
+}
+
+ZENO_API std::vector<GlobalProfiler::Record> GlobalProfiler::collectFrame() {
+    std::vector<Record> res;
+    std::lock_guard lck(m_mtx);
+    for (auto const &buf: m_buffers) {
+        std::move(buf->records.begin(), buf->records.end(), std::back_inserter(res));
+        buf->records.clear();
+    }
+    std::sort(res.begin(), res.end(), [] (Record const &lhs, Record const &rhs) {
+        return lhs.beg_us < rhs.beg_us;
+    });
+    return res;
+}
+
+ZENO_API void GlobalProfiler::clearState() {
+    std::lock_guard lck(m_mtx);
+    for (auto const &buf: m_buffers) {
+        buf->records.clear();
+    }
+}
+
+ZENO_API size_t GlobalProfiler::objectByteSize(IObject const *obj) {
+    if (!obj)
+        return 0;
+    if (auto prim = dynamic_cast<PrimitiveObject const *>(obj)) {
+        return attrVectorByteSize(prim->verts) + attrVectorByteSize(prim->points)
+            + attrVectorByteSize(prim->lines) + attrVectorByteSize(prim->tris)
+            + attrVectorByteSize(prim->quads) + attrVectorByteSize(prim->loops)
+            + attrVectorByteSize(prim->polys) + attrVectorByteSize(prim->edges)
+            + attrVectorByteSize(prim->uvs) + attrVectorByteSize(prim->loop_uvs);
+    }
+    if (auto lst = dynamic_cast<ListObject const *>(obj)) {
+        size_t res = 0;
+        for (auto const &elm: lst->arr)
+            res += objectByteSize(elm.get());
+        return res;
+    }
+    if (auto dct = dynamic_cast<DictObject const *>(obj)) {
+        size_t res = 0;
+        for (auto const &[key, elm]: dct->lut)
+            res += objectByteSize(elm.get());
+        return res;
+    }
+    if (auto str = dynamic_cast<StringObject const *>(obj)) {
+        return str->value.size();
+    }
+    if (dynamic_cast<NumericObject const *>(obj)) {
+        return sizeof(NumericValue);
+    }
+    return 0;
+}
+
+ZENO_API std::string GlobalProfiler::toChromeTrace(std::vector<Record> const &records) {
+    rapidjson::StringBuffer buf;
+    rapidjson::Writer writer(buf);
+    writer.StartObject();
+    writer.Key("traceEvents");
+    writer.StartArray();
+    for (auto const &rec: records) {
+        writer.StartObject();
+        writer.Key("name");
+        writer.String(rec.name.data(), rec.name.size());
+        writer.Key("cat");
+        writer.String("node");
+        writer.Key("ph");
+        writer.String("X");
+        writer.Key("ts");
+        writer.Int64(rec.beg_us);
+        writer.Key("dur");
+        writer.Int64(rec.dur_us);
+        writer.Key("pid");
+        writer.Int(0);
+        writer.Key("tid");
+        writer.Uint(rec.tid);
+        writer.Key("args");
+        writer.StartObject();
+        writer.Key("frame");
+        writer.Int(rec.frameid);
+        writer.Key("substep");
+        writer.Int(rec.substepid);
+        writer.Key("depth");
+        writer.Int(rec.depth);
+        writer.Key("self_us");
+        writer.Int64(rec.self_us);
+        writer.Key("alloc_bytes");
+        writer.Uint64(rec.alloc_bytes);
+        writer.Key("output_bytes");
+        writer.Uint64(rec.output_bytes);
+        writer.EndObject();
+        writer.EndObject();
+    }
+    writer.EndArray();
+    writer.EndObject();
+    return {buf.GetString(), buf.GetLength()};
+}
+
+ZENO_API std::vector<GlobalProfiler::Record> GlobalProfiler::fromChromeTrace(std::string_view json) {
+    std::vector<Record> res;
+    rapidjson::Document doc;
+    doc.Parse(json.data(), json.size());
+    if (!doc.IsObject()) {
+        log_warn("profiler trace document root not object");
+        return res;
+    }
+    auto it = doc.FindMember("traceEvents");
+    if (it == doc.MemberEnd() || !it->value.IsArray()) {
+        log_warn("profiler trace has no traceEvents array");
+        return res;
+    }
+    // events from other tools or edited by hand may lack any of the members or
+    // hold them with another type, those are skipped instead of read
+    using Value = rapidjson::Value;
+    auto has = [] (Value const &obj, const char *key, bool (Value::*is)() const) {
+        auto m = obj.FindMember(key);
+        return m != obj.MemberEnd() && (m->value.*is)();
+    };
+    for (auto const &ev: it->value.GetArray()) {
+        if (!ev.IsObject())
+            continue;
+        if (!has(ev, "name", &Value::IsString) || !has(ev, "args", &Value::IsObject)
+            || !has(ev, "ts", &Value::IsInt64) || !has(ev, "dur", &Value::IsInt64) || !has(ev, "tid", &Value::IsUint))
+            continue;
+        auto const &arg = ev["args"];
+        if (!has(arg, "frame", &Value::IsInt) || !has(arg, "substep", &Value::IsInt) || !has(arg, "depth", &Value::IsInt)
+            || !has(arg, "self_us", &Value::IsInt64) || !has(arg, "alloc_bytes", &Value::IsUint64)
+            || !has(arg, "output_bytes", &Value::IsUint64))
+            continue;
+        auto &rec = res.emplace_back();
+        rec.name.assign(ev["name"].GetString(), ev["name"].GetStringLength());
+        rec.beg_us = ev["ts"].GetInt64();
+        rec.dur_us = ev["dur"].GetInt64();
+        rec.tid = ev["tid"].GetUint();
+        rec.frameid = arg["frame"].GetInt();
+        rec.substepid = arg["substep"].GetInt();
+        rec.depth = arg["depth"].GetInt();
+        rec.self_us = arg["self_us"].GetInt64();
+        rec.alloc_bytes = arg["alloc_bytes"].GetUint64();
+        rec.output_bytes = arg["output_bytes"].GetUint64();
+    }
+    return res;
+}
+
+ZENO_API std::string GlobalProfiler::summary(std::vector<Record> const &records, size_t topn) {
+    struct Statistic {
+        int64_t self_us = 0;
+        int64_t total_us = 0;
+        size_t alloc_bytes = 0;
+        int count = 0;
+    };
+    std::map<std::string, Statistic> stats;
+    for (auto const &rec: records) {
+        auto &stat = stats[rec.name];
+        stat.self_us += rec.self_us;
+        stat.total_us += rec.dur_us;
+        stat.alloc_bytes += rec.alloc_bytes;
+        stat.count++;
+    }
+    std::vector<std::pair<std::string, Statistic>> sortstats(stats.begin(), stats.end());
+    std::sort(sortstats.begin(), sortstats.end(), [] (auto const &lhs, auto const &rhs) {
+        return lhs.second.self_us > rhs.second.self_us;
+    });
+    if (sortstats.size() > topn)
+        sortstats.resize(topn);
+
+    std::string res = "   self  |  total  |   alloc    | cnt | node\n";
+    for (auto const &[name, stat]: sortstats) {
+        res += cformat("%9lld|%9lld|%12llu|%5d| %s\n", (long long)stat.self_us, (long long)stat.total_us,
+                       (unsigned long long)stat.alloc_bytes, stat.count, name.c_str());
+    }
+    return res;
+}
+
+}
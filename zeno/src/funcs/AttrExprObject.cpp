@@ -0,0 +1,240 @@
+#include <zeno/types/AttrExprObject.h>
+#include <zeno/utils/Error.h>
+#include <algorithm>
+#include <cmath>
+
+namespace zeno {
+
+namespace {
+
+// vertices taken through the instructions at a time, small enough for the
+// registers of a typical chain to stay in L1/L2
+constexpr int kBlock = 256;
+
+int attrDim(PrimitiveObject const *prim, std::string const &name) {
+    if (prim->verts.attr_is<vec3f>(name))
+        return 3;
+    if (prim->verts.attr_is<float>(name) || prim->verts.attr_is<int>(name))
+        return 1;
+    if (!prim->verts.has_attr(name))
+        throw makeError<KeyError>(name, "attribute name of primitive");
+    throw makeError<TypeError>(typeid(vec3f), typeid(void), "type of attribute " + name + " in AttrExpr, float, int or vec3f");
+}
+
+// an attribute array bound for one eval, exactly one of the pointers is set
+struct Bound {
+    float const *f = nullptr;
+    int const *i = nullptr;
+    vec3f const *v = nullptr;
+    std::size_t size = 0;
+};
+
+template <class F>
+void lanes(float *__restrict d, float const *__restrict a, int m, F f) {
+#pragma omp simd
+    for (int l = 0; l < m; l++)
+        d[l] = f(a[l]);
+}
+
+template <class F>
+void lanes(float *__restrict d, float const *__restrict a, float const *__restrict b, int m, F f) {
+#pragma omp simd
+    for (int l = 0; l < m; l++)
+        d[l] = f(a[l], b[l]);
+}
+
+}
+
+std::shared_ptr<AttrExprObject> AttrExprObject::attr(std::shared_ptr<PrimitiveObject> prim, std::string const &name) {
+    auto e = std::make_shared<AttrExprObject>();
+    Inst in{Load, attrDim(prim.get(), name)};
+    in.load = 0;
+    e->code.push_back(in);
+    e->loads.push_back({std::move(prim), name});
+    return e;
+}
+
+std::shared_ptr<AttrExprObject> AttrExprObject::constant(vec3f const &value, int dim) {
+    auto e = std::make_shared<AttrExprObject>();
+    Inst in{Const, dim};
+    in.value = dim == 1 ? vec3f(value[0]) : value;
+    e->code.push_back(in);
+    return e;
+}
+
+std::shared_ptr<AttrExprObject> AttrExprObject::unary(Op op, AttrExprObject const &a) {
+    auto e = std::make_shared<AttrExprObject>(a);
+    Inst in{op, a.dim()};
+    in.a = (int)a.code.size() - 1;
+    e->code.push_back(in);
+    return e;
+}
+
+std::shared_ptr<AttrExprObject> AttrExprObject::binary(Op op, AttrExprObject const &a, AttrExprObject const &b) {
+    auto e = std::make_shared<AttrExprObject>(a);
+    // append b renumbered, loading each attribute once
+    std::vector<int> remap(b.code.size());
+    for (std::size_t j = 0; j < b.code.size(); j++) {
+        auto in = b.code[j];
+        if (in.op == Load) {
+            auto const &src = b.loads[in.load];
+            auto it = std::find_if(e->loads.begin(), e->loads.end(), [&] (Source const &s) {
+                return s.prim == src.prim && s.attr == src.attr;
+            });
+            in.load = (int)(it - e->loads.begin());
+            if (it == e->loads.end()) {
+                e->loads.push_back(src);
+            } else {
+                auto reg = std::find_if(e->code.begin(), e->code.end(), [&] (Inst const &c) {
+                    return c.op == Load && c.load == in.load;
+                });
+                remap[j] = (int)(reg - e->code.begin());
+                continue;
+            }
+        }
+        if (in.a != -1)
+            in.a = remap[in.a];
+        if (in.b != -1)
+            in.b = remap[in.b];
+        remap[j] = (int)e->code.size();
+        e->code.push_back(in);
+    }
+    Inst in{op, std::max(a.dim(), b.dim())};
+    in.a = (int)a.code.size() - 1;
+    in.b = remap.back();
+    e->code.push_back(in);
+    return e;
+}
+
+void AttrExprObject::eval(PrimitiveObject *prim, std::string const &name) const {
+    int outDim = dim();
+    if (!prim->verts.has_attr(name)) {
+        if (outDim == 3)
+            prim->verts.add_attr<vec3f>(name);
+        else
+            prim->verts.add_attr<float>(name);
+    }
+    if (outDim == 3 && !prim->verts.attr_is<vec3f>(name))
+        throw makeError<TypeError>(typeid(vec3f), typeid(float), "type of attribute " + name + " for a vec3f AttrExpr");
+
+    std::size_t n = prim->verts.size();
+    std::vector<Bound> bound(loads.size());
+    for (std::size_t k = 0; k < loads.size(); k++) {
+        auto const &src = loads[k];
+        auto &b = bound[k];
+        src.prim->verts.attr_visit<std::variant<float, int, vec3f>>(src.attr, [&] (auto const &arr) {
+            using T = std::decay_t<decltype(arr[0])>;
+            if constexpr (std::is_same_v<T, float>)
+                b.f = arr.data();
+            else if constexpr (std::is_same_v<T, int>)
+                b.i = arr.data();
+            else
+                b.v = arr.data();
+            b.size = arr.size();
+        });
+        if (!b.f && !b.i && !b.v)
+            throw makeError<TypeError>(typeid(vec3f), typeid(void), "type of attribute " + src.attr + " in AttrExpr, float, int or vec3f");
+        for (auto const &in: code) {
+            if (in.op == Load && in.load == (int)k && (b.v ? 3 : 1) != in.dim)
+                throw makeError<TypeError>(b.v ? typeid(float) : typeid(vec3f), b.v ? typeid(vec3f) : typeid(float),
+                                           "type of attribute " + src.attr + " changed since the AttrExpr was built");
+        }
+        n = std::min(n, b.size);
+    }
+
+    prim->verts.attr_visit<std::variant<float, int, vec3f>>(name, [&] (auto &outArr) {
+        using OutT = std::decay_t<decltype(outArr[0])>;
+        n = std::min(n, outArr.size());
+        auto *out = outArr.data();
+        std::size_t nregs = code.size();
+
+#pragma omp parallel
+        {
+            // operands are read through ptrs, which point float attributes and
+            // constants in place and everything else at the thread's registers
+            std::vector<float> regs(nregs * 3 * kBlock);
+            std::vector<float const *> ptrs(nregs * 3);
+            auto reg = [&] (int r, int c) {
+                return regs.data() + ((std::size_t)r * 3 + c) * kBlock;
+            };
+            for (std::size_t r = 0; r < nregs; r++) {
+                for (int c = 0; c < 3; c++) {
+                    ptrs[r * 3 + c] = reg(r, c);
+                    if (code[r].op == Const)
+                        std::fill_n(reg(r, c), kBlock, code[r].value[c]);
+                }
+            }
+            auto arg = [&] (int r, int c) {
+                return ptrs[(std::size_t)r * 3 + (code[r].dim == 1 ? 0 : c)];
+            };
+#pragma omp for
+            for (std::ptrdiff_t base = 0; base < (std::ptrdiff_t)n; base += kBlock) {
+                int m = (int)std::min<std::size_t>(kBlock, n - base);
+                for (std::size_t r = 0; r < nregs; r++) {
+                    auto const &in = code[r];
+                    if (in.op == Const)
+                        continue;
+                    if (in.op == Load) {
+                        auto const &b = bound[in.load];
+                        if (b.f) {
+                            ptrs[r * 3] = b.f + base;
+                        } else if (b.v) {
+                            float *d0 = reg(r, 0), *d1 = reg(r, 1), *d2 = reg(r, 2);
+                            for (int l = 0; l < m; l++) {
+                                d0[l] = b.v[base + l][0];
+                                d1[l] = b.v[base + l][1];
+                                d2[l] = b.v[base + l][2];
+                            }
+                        } else {
+                            float *d = reg(r, 0);
+                            for (int l = 0; l < m; l++)
+                                d[l] = (float)b.i[base + l];
+                        }
+                        continue;
+                    }
+                    for (int c = 0; c < in.dim; c++) {
+                        float *d = reg(r, c);
+                        float const *a = arg(in.a, c);
+                        float const *b = in.b != -1 ? arg(in.b, c) : nullptr;
+                        switch (in.op) {
+                        case Neg: lanes(d, a, m, [] (float x) { return -x; }); break;
+                        case Abs: lanes(d, a, m, [] (float x) { return std::abs(x); }); break;
+                        case Sqrt: lanes(d, a, m, [] (float x) { return std::sqrt(x); }); break;
+                        case Sin: lanes(d, a, m, [] (float x) { return std::sin(x); }); break;
+                        case Cos: lanes(d, a, m, [] (float x) { return std::cos(x); }); break;
+                        case Tan: lanes(d, a, m, [] (float x) { return std::tan(x); }); break;
+                        case Asin: lanes(d, a, m, [] (float x) { return std::asin(x); }); break;
+                        case Acos: lanes(d, a, m, [] (float x) { return std::acos(x); }); break;
+                        case Atan: lanes(d, a, m, [] (float x) { return std::atan(x); }); break;
+                        case Exp: lanes(d, a, m, [] (float x) { return std::exp(x); }); break;
+                        case Log: lanes(d, a, m, [] (float x) { return std::log(x); }); break;
+                        case Floor: lanes(d, a, m, [] (float x) { return std::floor(x); }); break;
+                        case Ceil: lanes(d, a, m, [] (float x) { return std::ceil(x); }); break;
+                        case Add: lanes(d, a, b, m, [] (float x, float y) { return x + y; }); break;
+                        case Sub: lanes(d, a, b, m, [] (float x, float y) { return x - y; }); break;
+                        case Mul: lanes(d, a, b, m, [] (float x, float y) { return x * y; }); break;
+                        case Div: lanes(d, a, b, m, [] (float x, float y) { return x / y; }); break;
+                        case Pow: lanes(d, a, b, m, [] (float x, float y) { return std::pow(x, y); }); break;
+                        case Atan2: lanes(d, a, b, m, [] (float x, float y) { return std::atan2(x, y); }); break;
+                        case Min: lanes(d, a, b, m, [] (float x, float y) { return std::min(x, y); }); break;
+                        case Max: lanes(d, a, b, m, [] (float x, float y) { return std::max(x, y); }); break;
+                        default: break;
+                        }
+                    }
+                }
+                int res = (int)nregs - 1;
+                if constexpr (std::is_same_v<OutT, vec3f>) {
+                    float const *s0 = arg(res, 0), *s1 = arg(res, 1), *s2 = arg(res, 2);
+                    for (int l = 0; l < m; l++)
+                        out[base + l] = vec3f(s0[l], s1[l], s2[l]);
+                } else {
+                    float const *s = arg(res, 0);
+                    for (int l = 0; l < m; l++)
+                        out[base + l] = (OutT)s[l];
+                }
+            }
+        }
+    });
+}
+
+}
@@ -0,0 +1,465 @@
+#include <zeno/types/BvhObject.h>
+#include <zeno/utils/log.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace zeno {
+
+namespace {
+
+constexpr int kLeafSize = 4;
+constexpr int kNumBins = 12;
+constexpr int kMaxSahDepth = 48;   // deeper than this, split by count to bound the traversal stack
+constexpr int kStackSize = 512;    // on the stack, deeper trees get a heap allocated one
+
+struct Aabb {
+    vec3f lo{std::numeric_limits<float>::max()};
+    vec3f hi{std::numeric_limits<float>::lowest()};
+
+    void grow(vec3f const &p) {
+        lo = zeno::min(lo, p);
+        hi = zeno::max(hi, p);
+    }
+
+    void grow(Aabb const &b) {
+        lo = zeno::min(lo, b.lo);
+        hi = zeno::max(hi, b.hi);
+    }
+
+    float area() const {
+        auto d = hi - lo;
+        if (d[0] < 0) return 0;
+        return d[0] * d[1] + d[1] * d[2] + d[2] * d[0];
+    }
+};
+
+struct BinaryNode {
+    Aabb box;
+    int left = -1, right = -1;  // children, -1 for a leaf
+    int start = 0, count = 0;   // range of the leaf in the permutation
+};
+
+struct BinaryBuilder {
+    std::vector<Aabb> const &boxes;
+    std::vector<vec3f> const &centers;
+    std::vector<int> &perm;
+    std::vector<BinaryNode> &tree;
+    std::atomic<int> nextNode{1};
+
+    BinaryBuilder(std::vector<Aabb> const &boxes, std::vector<vec3f> const &centers,
+                  std::vector<int> &perm, std::vector<BinaryNode> &tree)
+        : boxes(boxes), centers(centers), perm(perm), tree(tree) {}
+
+    // binned surface area heuristic along the longest axis of the centroids
+    int findSplit(int start, int count, int depth, Aabb const &cbox) {
+        auto ext = cbox.hi - cbox.lo;
+        int axis = ext[0] > ext[1] ? (ext[0] > ext[2] ? 0 : 2) : (ext[1] > ext[2] ? 1 : 2);
+        auto first = perm.begin() + start, last = first + count;
+        auto byAxis = [&] (int a, int b) { return centers[a][axis] < centers[b][axis]; };
+        if (!(ext[axis] > 0) || depth > kMaxSahDepth) {
+            std::nth_element(first, first + count / 2, last, byAxis);
+            return start + count / 2;
+        }
+
+        Aabb binBox[kNumBins];
+        int binCount[kNumBins] = {};
+        float scale = kNumBins / ext[axis];
+        auto binOf = [&] (int t) {
+            return std::min(kNumBins - 1, (int)((centers[t][axis] - cbox.lo[axis]) * scale));
+        };
+        for (auto it = first; it != last; ++it) {
+            int b = binOf(*it);
+            binBox[b].grow(boxes[*it]);
+            binCount[b]++;
+        }
+        float rightArea[kNumBins];
+        int rightCount[kNumBins];
+        Aabb acc;
+        int cnt = 0;
+        for (int b = kNumBins - 1; b > 0; b--) {
+            acc.grow(binBox[b]);
+            cnt += binCount[b];
+            rightArea[b] = acc.area();
+            rightCount[b] = cnt;
+        }
+        float bestCost = std::numeric_limits<float>::max();
+        int bestBin = -1;
+        acc = Aabb();
+        cnt = 0;
+        for (int b = 1; b < kNumBins; b++) {
+            acc.grow(binBox[b - 1]);
+            cnt += binCount[b - 1];
+            if (!cnt || !rightCount[b]) continue;
+            float cost = acc.area() * cnt + rightArea[b] * rightCount[b];
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestBin = b;
+            }
+        }
+        if (bestBin < 0) {
+            std::nth_element(first, first + count / 2, last, byAxis);
+            return start + count / 2;
+        }
+        auto mid = std::partition(first, last, [&] (int t) { return binOf(t) < bestBin; });
+        return start + (int)(mid - perm.begin() - start);
+    }
+
+    void run(int node, int start, int count, int depth) {
+        Aabb box, cbox;
+        for (int i = start; i < start + count; i++) {
+            box.grow(boxes[perm[i]]);
+            cbox.grow(centers[perm[i]]);
+        }
+        auto &n = tree[node];
+        n.box = box;
+        n.start = start;
+        n.count = count;
+        if (count <= kLeafSize)
+            return;
+        int mid = findSplit(start, count, depth, cbox);
+        int left = nextNode.fetch_add(2);
+        n.left = left;
+        n.right = left + 1;
+        if (count > 4096) {
+#pragma omp task
+            run(left, start, mid - start, depth + 1);
+#pragma omp task
+            run(left + 1, mid, start + count - mid, depth + 1);
+#pragma omp taskwait
+        } else {
+            run(left, start, mid - start, depth + 1);
+            run(left + 1, mid, start + count - mid, depth + 1);
+        }
+    }
+};
+
+// open the largest inner children of a binary node until there are four of them
+int collapse(std::vector<BinaryNode> const &tree, int bnode, std::vector<BvhObject::Node> &nodes,
+             int level, int &depth) {
+    depth = std::max(depth, level + 1);
+    int slots[4] = {tree[bnode].left, tree[bnode].right, -1, -1};
+    int nslots = 2;
+    while (nslots < 4) {
+        int best = -1;
+        float bestArea = -1;
+        for (int k = 0; k < nslots; k++) {
+            auto const &c = tree[slots[k]];
+            if (c.left >= 0 && c.box.area() > bestArea) {
+                bestArea = c.box.area();
+                best = k;
+            }
+        }
+        if (best < 0) break;
+        int b = slots[best];
+        slots[best] = tree[b].left;
+        slots[nslots++] = tree[b].right;
+    }
+
+    int id = nodes.size();
+    nodes.emplace_back();
+    for (int k = 0; k < 4; k++) {
+        int child = -1, count = -1;
+        Aabb box;
+        if (k < nslots) {
+            auto const &c = tree[slots[k]];
+            box = c.box;
+            if (c.left >= 0) {
+                child = collapse(tree, slots[k], nodes, level + 1, depth);
+                count = 0;
+            } else {
+                child = c.start;
+                count = c.count;
+            }
+        }
+        auto &n = nodes[id];
+        for (int d = 0; d < 3; d++) {
+            n.bmin[d][k] = box.lo[d];
+            n.bmax[d][k] = box.hi[d];
+        }
+        n.child[k] = child;
+        n.count[k] = count;
+    }
+    return id;
+}
+
+vec3f safeInverse(vec3f const &d) {
+    vec3f r;
+    for (int i = 0; i < 3; i++)
+        r[i] = 1 / (std::abs(d[i]) > 1e-20f ? d[i] : std::copysign(1e-20f, d[i]));
+    return r;
+}
+
+// ref: Real-Time Collision Detection, 5.1.5
+vec3f closestOnTriangle(vec3f const &p, vec3f const &a, vec3f const &ab, vec3f const &ac, vec3f &bary) {
+    vec3f ap = p - a;
+    float d1 = dot(ab, ap), d2 = dot(ac, ap);
+    if (d1 <= 0 && d2 <= 0) {
+        bary = {1, 0, 0};
+        return a;
+    }
+    vec3f bp = ap - ab;
+    float d3 = dot(ab, bp), d4 = dot(ac, bp);
+    if (d3 >= 0 && d4 <= d3) {
+        bary = {0, 1, 0};
+        return a + ab;
+    }
+    float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0 && d1 >= 0 && d3 <= 0) {
+        float v = d1 / (d1 - d3);
+        bary = {1 - v, v, 0};
+        return a + v * ab;
+    }
+    vec3f cp = ap - ac;
+    float d5 = dot(ab, cp), d6 = dot(ac, cp);
+    if (d6 >= 0 && d5 <= d6) {
+        bary = {0, 0, 1};
+        return a + ac;
+    }
+    float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0 && d2 >= 0 && d6 <= 0) {
+        float w = d2 / (d2 - d6);
+        bary = {1 - w, 0, w};
+        return a + w * ac;
+    }
+    float va = d3 * d6 - d5 * d4;
+    if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0) {
+        float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+        bary = {0, 1 - w, w};
+        return a + ab + w * (ac - ab);
+    }
+    float denom = 1 / (va + vb + vc);
+    float v = vb * denom, w = vc * denom;
+    bary = {1 - v - w, v, w};
+    return a + ab * v + ac * w;
+}
+
+// each popped node pushes at most four children, three of which wait on the
+// stack while the nearest one is descended, so depth levels need 3 * depth + 1
+struct TraversalStack {
+    int local[kStackSize];
+    std::vector<int> heap;
+    int *data = local;
+
+    explicit TraversalStack(int depth) {
+        if (3 * depth + 1 > kStackSize) {
+            heap.resize(3 * depth + 1);
+            data = heap.data();
+        }
+    }
+};
+
+}
+
+ZENO_API void BvhObject::build(PrimitiveObject const *prim) {
+    nodes.clear();
+    triV0.clear();
+    triE1.clear();
+    triE2.clear();
+    triIds.clear();
+    triOrder.clear();
+    depth = 0;
+    int ntris = prim->tris.size();
+    if (!ntris)
+        return;
+
+    auto const &pos = prim->verts.values;
+    std::vector<Aabb> boxes(ntris);
+    std::vector<vec3f> centers(ntris);
+    std::vector<int> perm(ntris);
+#pragma omp parallel for
+    for (int i = 0; i < ntris; i++) {
+        auto ind = prim->tris[i];
+        Aabb b;
+        for (int j = 0; j < 3; j++)
+            b.grow(pos[ind[j]]);
+        boxes[i] = b;
+        centers[i] = (b.lo + b.hi) * 0.5f;
+        perm[i] = i;
+    }
+
+    std::vector<BinaryNode> tree(std::max(1, 2 * ntris - 1));
+    {
+        BinaryBuilder builder(boxes, centers, perm, tree);
+#pragma omp parallel
+#pragma omp single
+        builder.run(0, 0, ntris, 0);
+        tree.resize(builder.nextNode.load());
+    }
+
+    if (tree[0].left >= 0) {
+        nodes.reserve(tree.size() / 2 + 1);
+        collapse(tree, 0, nodes, 0, depth);
+    } else {
+        // a single leaf, keep one node so that traversal needs no special case
+        auto &n = nodes.emplace_back();
+        for (int k = 0; k < 4; k++) {
+            for (int d = 0; d < 3; d++) {
+                n.bmin[d][k] = k ? 0 : tree[0].box.lo[d];
+                n.bmax[d][k] = k ? 0 : tree[0].box.hi[d];
+            }
+            n.child[k] = k ? -1 : 0;
+            n.count[k] = k ? -1 : ntris;
+        }
+        depth = 1;
+    }
+
+    triV0.resize(ntris);
+    triE1.resize(ntris);
+    triE2.resize(ntris);
+    triIds = std::move(perm);
+    triOrder.resize(ntris);
+#pragma omp parallel for
+    for (int i = 0; i < ntris; i++) {
+        triOrder[triIds[i]] = i;
+        auto ind = prim->tris[triIds[i]];
+        triV0[i] = pos[ind[0]];
+        triE1[i] = pos[ind[1]] - pos[ind[0]];
+        triE2[i] = pos[ind[2]] - pos[ind[0]];
+    }
+    log_debug("BvhObject: built {} nodes of depth {} over {} triangles", nodes.size(), depth, ntris);
+}
+
+ZENO_API BvhObject::RayHit BvhObject::intersect(vec3f const &ro, vec3f const &rd, float tmin, float tmax) const {
+    RayHit hit;
+    if (nodes.empty())
+        return hit;
+    vec3f inv = safeInverse(rd);
+    float tfar = tmax;
+    const float eps = 1e-6f;
+
+    TraversalStack buf(depth);
+    int *stack = buf.data;
+    int top = 0;
+    stack[top++] = 0;
+    while (top) {
+        auto const &n = nodes[stack[--top]];
+        float tn[4], tf[4];
+        for (int k = 0; k < 4; k++) {
+            float x0 = (n.bmin[0][k] - ro[0]) * inv[0], x1 = (n.bmax[0][k] - ro[0]) * inv[0];
+            float y0 = (n.bmin[1][k] - ro[1]) * inv[1], y1 = (n.bmax[1][k] - ro[1]) * inv[1];
+            float z0 = (n.bmin[2][k] - ro[2]) * inv[2], z1 = (n.bmax[2][k] - ro[2]) * inv[2];
+            tn[k] = std::max(std::max(std::min(x0, x1), std::min(y0, y1)), std::max(std::min(z0, z1), tmin));
+            tf[k] = std::min(std::min(std::max(x0, x1), std::max(y0, y1)), std::min(std::max(z0, z1), tfar));
+        }
+        int mask = 0;
+        for (int k = 0; k < 4; k++)
+            mask |= (n.count[k] >= 0 && tn[k] <= tf[k]) << k;
+        if (!mask)
+            continue;
+
+        int order[4], m = 0;
+        for (int k = 0; k < 4; k++) {
+            if (mask & (1 << k)) {
+                int j = m++;
+                for (; j > 0 && tn[order[j - 1]] < tn[k]; j--)
+                    order[j] = order[j - 1];
+                order[j] = k;
+            }
+        }
+        for (int j = 0; j < m; j++) {
+            int k = order[j];
+            if (n.count[k] == 0) {
+                stack[top++] = n.child[k];
+                continue;
+            }
+            for (int i = n.child[k]; i < n.child[k] + n.count[k]; i++) {
+                auto const &e1 = triE1[i], &e2 = triE2[i];
+                vec3f p = cross(rd, e2);
+                float det = dot(e1, p);
+                if (det == 0) continue;
+                float invdet = 1 / det;
+                vec3f s = ro - triV0[i];
+                float u = dot(s, p) * invdet;
+                if (u < -eps || u > 1 + eps) continue;
+                vec3f q = cross(s, e1);
+                float v = dot(rd, q) * invdet;
+                if (v < -eps || u + v > 1 + eps * 2) continue;
+                float t = dot(e2, q) * invdet;
+                if (t < tmin || t > tfar) continue;
+                tfar = t;
+                hit.t = t;
+                hit.primId = triIds[i];
+                hit.u = u;
+                hit.v = v;
+            }
+        }
+    }
+    return hit;
+}
+
+ZENO_API BvhObject::NearestHit BvhObject::nearest(vec3f const &pos, float maxDist) const {
+    NearestHit hit;
+    if (nodes.empty())
+        return hit;
+    float best2 = maxDist * maxDist;
+
+    TraversalStack buf(depth);
+    int *stack = buf.data;
+    int top = 0;
+    stack[top++] = 0;
+    while (top) {
+        auto const &n = nodes[stack[--top]];
+        float d2[4];
+        for (int k = 0; k < 4; k++) {
+            float dx = std::max(std::max(n.bmin[0][k] - pos[0], pos[0] - n.bmax[0][k]), 0.f);
+            float dy = std::max(std::max(n.bmin[1][k] - pos[1], pos[1] - n.bmax[1][k]), 0.f);
+            float dz = std::max(std::max(n.bmin[2][k] - pos[2], pos[2] - n.bmax[2][k]), 0.f);
+            d2[k] = dx * dx + dy * dy + dz * dz;
+        }
+        int mask = 0;
+        for (int k = 0; k < 4; k++)
+            mask |= (n.count[k] >= 0 && d2[k] <= best2) << k;
+        if (!mask)
+            continue;
+
+        int order[4], m = 0;
+        for (int k = 0; k < 4; k++) {
+            if (mask & (1 << k)) {
+                int j = m++;
+                for (; j > 0 && d2[order[j - 1]] < d2[k]; j--)
+                    order[j] = order[j - 1];
+                order[j] = k;
+            }
+        }
+        for (int j = 0; j < m; j++) {
+            int k = order[j];
+            if (d2[k] > best2) continue;
+            if (n.count[k] == 0) {
+                stack[top++] = n.child[k];
+                continue;
+            }
+            for (int i = n.child[k]; i < n.child[k] + n.count[k]; i++) {
+                vec3f bary;
+                vec3f c = closestOnTriangle(pos, triV0[i], triE1[i], triE2[i], bary);
+                float dd = lengthSquared(c - pos);
+                if (dd < best2) {
+                    best2 = dd;
+                    hit.primId = triIds[i];
+                    hit.pos = c;
+                    hit.bary = bary;
+                }
+            }
+        }
+    }
+    if (hit.primId >= 0)
+        hit.dist = std::sqrt(best2);
+    return hit;
+}
+
+ZENO_API void BvhObject::intersectBatch(vec3f const *ro, vec3f const *rd, RayHit *hits, std::size_t n,
+                                        float tmin, float tmax) const {
+#pragma omp parallel for schedule(dynamic, 256)
+    for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)n; i++) {
+        hits[i] = intersect(ro[i], rd[i], tmin, tmax);
+    }
+}
+
+ZENO_API void BvhObject::nearestBatch(vec3f const *pos, NearestHit *hits, std::size_t n, float maxDist) const {
+#pragma omp parallel for schedule(dynamic, 256)
+    for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)n; i++) {
+        hits[i] = nearest(pos[i], maxDist);
+    }
+}
+
+}
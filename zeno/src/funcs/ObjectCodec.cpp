@@ -12,6 +12,8 @@
 #include <zeno/utils/log.h>
 #include <algorithm>
 #include <cstring>
+#include <mutex>
+#include <map>
 
 namespace zeno {
 
@@ -20,6 +22,7 @@ namespace {
 #define _PER_OBJECT_TYPE(TypeName, ...) TypeName,
 enum class ObjectType : int32_t {
     ZENO_XMACRO_IObject(_PER_OBJECT_TYPE)
+    Registered,  // followed by the codec name, see registerObjectCodec
 };
 #undef _PER_OBJECT_TYPE
 
@@ -32,6 +35,70 @@ struct ObjectHeader {
     size_t beginUserData;
 };
 
+struct ObjectCodecEntry {
+    std::string name;
+    ObjectEncoder encoder;
+    ObjectDecoder decoder;
+};
+
+struct ObjectCodecRegistry {
+    std::mutex mtx;
+    std::map<std::type_index, std::shared_ptr<ObjectCodecEntry>> byType;
+    std::map<std::string, std::shared_ptr<ObjectCodecEntry>> byName;
+
+    static ObjectCodecRegistry &instance() {
+        static ObjectCodecRegistry registry;
+        return registry;
+    }
+
+    std::shared_ptr<ObjectCodecEntry> find(std::type_index type) {
+        std::lock_guard lck(mtx);
+        auto it = byType.find(type);
+        return it == byType.end() ? nullptr : it->second;
+    }
+
+    std::shared_ptr<ObjectCodecEntry> find(std::string const &name) {
+        std::lock_guard lck(mtx);
+        auto it = byName.find(name);
+        return it == byName.end() ? nullptr : it->second;
+    }
+};
+
+}
+
+ZENO_API int registerObjectCodec(std::type_index type, std::string const &name,
+                                 ObjectEncoder encoder, ObjectDecoder decoder) {
+    auto &registry = ObjectCodecRegistry::instance();
+    auto entry = std::make_shared<ObjectCodecEntry>(ObjectCodecEntry{name, std::move(encoder), std::move(decoder)});
+    std::lock_guard lck(registry.mtx);
+    registry.byType[type] = entry;
+    registry.byName[name] = entry;
+    return 1;
+}
+
+static std::shared_ptr<IObject> _decodeRegisteredObject(const char *buf, size_t len) {
+    auto &header = *(ObjectHeader *)buf;
+    auto it = buf + sizeof(ObjectHeader);
+    auto end = buf + std::min(len, header.beginUserData);
+    if (end < it + sizeof(size_t)) {
+        log_error("data too short, giving up");
+        return nullptr;
+    }
+    size_t namesize = *(size_t *)it;
+    it += sizeof(namesize);
+    if ((size_t)(end - it) < namesize) {
+        log_error("data too short, giving up");
+        return nullptr;
+    }
+    std::string name{it, namesize};
+    it += namesize;
+
+    auto codec = ObjectCodecRegistry::instance().find(name);
+    if (!codec) {
+        log_error("no codec registered for object type `{}`", name);
+        return nullptr;
+    }
+    return codec->decoder(it, end - it);
 }
 
 namespace _implObjectCodec {
@@ -63,6 +130,8 @@ static std::shared_ptr<IObject> _decodeObjectImpl(const char *buf, size_t len) {
 ZENO_XMACRO_IObject(_PER_OBJECT_TYPE)
 #undef _PER_OBJECT_TYPE
 
+    } else if (header.type == ObjectType::Registered) {
+        return _decodeRegisteredObject(buf, len);
     } else {
         log_error("invalid object header type {}", (int)header.type);
         return nullptr;
@@ -77,6 +146,8 @@ std::shared_ptr<IObject> decodeObject(const char *buf, size_t len) {
     }
 
     auto object = _decodeObjectImpl(buf, len);
+    if (!object)
+        return nullptr;
 
     auto ptr = buf + header.beginUserData;
     for (int i = 0; i < header.numUserData; i++) {
@@ -115,6 +186,13 @@ static bool _encodeObjectImpl(IObject const *object, std::vector<char> &buf) {
 ZENO_XMACRO_IObject(_PER_OBJECT_TYPE)
 #undef _PER_OBJECT_TYPE
 
+    } else if (auto codec = ObjectCodecRegistry::instance().find(typeid(*object))) {
+        header.type = ObjectType::Registered;
+        it = std::copy_n((char *)&header, sizeof(ObjectHeader), it);
+        size_t namesize = codec->name.size();
+        it = std::copy_n((char *)&namesize, sizeof(namesize), it);
+        it = std::copy(codec->name.begin(), codec->name.end(), it);
+        return codec->encoder(object, buf);
     } else {
         log_error("invalid object type to encode `{}`", cppdemangle(typeid(*object)));
         return false;
@@ -123,8 +201,10 @@ ZENO_XMACRO_IObject(_PER_OBJECT_TYPE)
 
 bool encodeObject(IObject const *object, std::vector<char> &buf) {
     auto oldsize = buf.size();
-    if (!_encodeObjectImpl(object, buf))
+    if (!_encodeObjectImpl(object, buf)) {
+        buf.resize(oldsize);
         return false;
+    }
 
     std::vector<std::vector<char>> valbufs;
     for (auto const &[key, val]: object->userData()) {
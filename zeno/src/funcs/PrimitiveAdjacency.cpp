@@ -0,0 +1,212 @@
+#include <zeno/funcs/PrimitiveAdjacency.h>
+#include <zeno/types/PrimitiveObject.h>
+#include <zeno/utils/log.h>
+#include <algorithm>
+#include <utility>
+
+namespace zeno {
+
+namespace {
+
+// FNV-1a on four interleaved lanes per chunk, so that the multiplies of one
+// lane don't wait for those of another; chunks are hashed in parallel
+uint64_t hashWords(void const *data, size_t nbytes, uint64_t h) {
+    constexpr size_t kChunk = 1 << 16;
+    auto p = static_cast<uint32_t const *>(data);
+    size_t n = nbytes / sizeof(uint32_t);
+    size_t nchunks = (n + kChunk - 1) / kChunk;
+    std::vector<uint64_t> chunkHash(nchunks);
+#pragma omp parallel for
+    for (size_t c = 0; c < nchunks; c++) {
+        uint64_t lane[4] = {0xcbf29ce484222325ull, 0x84222325cbf29ce4ull, 0x9e3779b97f4a7c15ull, 0x7f4a7c159e3779b9ull};
+        size_t i = c * kChunk, end = std::min(n, (c + 1) * kChunk);
+        for (; i + 4 <= end; i += 4) {
+            for (int l = 0; l < 4; l++)
+                lane[l] = (lane[l] ^ p[i + l]) * 0x100000001b3ull;
+        }
+        for (; i < end; i++)
+            lane[0] = (lane[0] ^ p[i]) * 0x100000001b3ull;
+        uint64_t ch = lane[0];
+        for (int l = 1; l < 4; l++)
+            ch ^= lane[l] + 0x9e3779b97f4a7c15ull + (ch << 6) + (ch >> 2);
+        chunkHash[c] = ch;
+    }
+    h = (h ^ n) * 0x100000001b3ull;
+    for (auto ch: chunkHash) {
+        h ^= ch + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+    }
+    return h;
+}
+
+template <class T>
+uint64_t hashArray(std::vector<T> const &arr, uint64_t h) {
+    static_assert(sizeof(T) % sizeof(uint32_t) == 0);
+    return hashWords(arr.data(), arr.size() * sizeof(T), h);
+}
+
+// turn per-bucket counts into CSR offsets, returns the total count
+int exclusiveScan(std::vector<int> &start) {
+    int sum = 0;
+    for (auto &x: start) {
+        int cnt = x;
+        x = sum;
+        sum += cnt;
+    }
+    return sum;
+}
+
+void buildAdjacency(PrimitiveObject const *prim, PrimitiveAdjacency &adj, bool withEdges) {
+    adj.numVerts = prim->verts.size();
+    adj.numTris = prim->tris.size();
+    adj.numQuads = prim->quads.size();
+    adj.numPolys = prim->polys.size();
+    int nfaces = adj.numFaces();
+
+    adj.faceStart.resize(nfaces + 1);
+    for (int f = 0; f < adj.numTris; f++)
+        adj.faceStart[f] = 3;
+    for (int f = 0; f < adj.numQuads; f++)
+        adj.faceStart[adj.numTris + f] = 4;
+    for (int f = 0; f < adj.numPolys; f++)
+        adj.faceStart[adj.numTris + adj.numQuads + f] = prim->polys[f][1];
+    int ncorners = exclusiveScan(adj.faceStart);
+
+    adj.corners.resize(ncorners);
+    adj.cornerFace.resize(ncorners);
+#pragma omp parallel for
+    for (int f = 0; f < nfaces; f++) {
+        int base = adj.faceStart[f];
+        int len = adj.faceStart[f + 1] - base;
+        if (f < adj.numTris) {
+            auto ind = prim->tris[f];
+            for (int j = 0; j < 3; j++) adj.corners[base + j] = ind[j];
+        } else if (f < adj.numTris + adj.numQuads) {
+            auto ind = prim->quads[f - adj.numTris];
+            for (int j = 0; j < 4; j++) adj.corners[base + j] = ind[j];
+        } else {
+            int start = prim->polys[f - adj.numTris - adj.numQuads][0];
+            for (int j = 0; j < len; j++) adj.corners[base + j] = prim->loops[start + j];
+        }
+        for (int j = 0; j < len; j++) adj.cornerFace[base + j] = f;
+    }
+
+    // vertex -> corners, a counting sort keeps the corners of each vertex in ascending order
+    adj.vertStart.assign(adj.numVerts + 1, 0);
+    for (int c = 0; c < ncorners; c++)
+        adj.vertStart[adj.corners[c]]++;
+    exclusiveScan(adj.vertStart);
+    adj.vertCorners.resize(ncorners);
+    {
+        std::vector<int> cursor(adj.vertStart.begin(), adj.vertStart.end() - 1);
+        for (int c = 0; c < ncorners; c++)
+            adj.vertCorners[cursor[adj.corners[c]]++] = c;
+    }
+
+    adj.hasEdges = withEdges;
+    if (!withEdges)
+        return;
+
+    // edges are bucketed by their lower vertex, so no global sort or hash map is needed,
+    // line segments are bucketed too with negative ids so that they get an edge id
+    auto nextCorner = [&] (int c) {
+        int f = adj.cornerFace[c];
+        return c + 1 == adj.faceStart[f + 1] ? adj.faceStart[f] : c + 1;
+    };
+    int nlines = prim->lines.size();
+    std::vector<int> loStart(adj.numVerts + 1, 0);
+    auto edgeOf = [&] (int id) -> std::pair<int, int> {
+        if (id < 0) {
+            auto ind = prim->lines[-1 - id];
+            return {ind[0], ind[1]};
+        }
+        return {adj.corners[id], adj.corners[nextCorner(id)]};
+    };
+    for (int id = -nlines; id < ncorners; id++) {
+        auto [a, b] = edgeOf(id);
+        if (a != b)
+            loStart[std::min(a, b)]++;
+    }
+    int nentries = exclusiveScan(loStart);
+    std::vector<std::pair<int, int>> bucket(nentries);  // (hi, id)
+    {
+        std::vector<int> cursor(loStart.begin(), loStart.end() - 1);
+        for (int id = -nlines; id < ncorners; id++) {
+            auto [a, b] = edgeOf(id);
+            if (a != b)
+                bucket[cursor[std::min(a, b)]++] = {std::max(a, b), id};
+        }
+    }
+    std::vector<int> edgeBase(adj.numVerts + 1), cornBase(adj.numVerts + 1);
+#pragma omp parallel for
+    for (int lo = 0; lo < adj.numVerts; lo++) {
+        auto first = bucket.begin() + loStart[lo], last = bucket.begin() + loStart[lo + 1];
+        // buckets are tiny, insertion sort by hi keeps the ids ascending
+        for (auto it = first; it != last; ++it) {
+            for (auto jt = it; jt != first && std::prev(jt)->first > jt->first; --jt)
+                std::iter_swap(jt, std::prev(jt));
+        }
+        int nedges = 0, ncorns = 0, prevhi = -1;
+        for (auto it = first; it != last; ++it) {
+            if (it->first != prevhi) {
+                prevhi = it->first;
+                nedges++;
+            }
+            if (it->second >= 0)
+                ncorns++;
+        }
+        edgeBase[lo] = nedges;
+        cornBase[lo] = ncorns;
+    }
+    int nedges = exclusiveScan(edgeBase);
+    int nedgecorns = exclusiveScan(cornBase);
+    adj.edges.resize(nedges);
+    adj.edgeStart.resize(nedges + 1);
+    adj.edgeStart[nedges] = nedgecorns;
+    adj.edgeCorners.resize(nedgecorns);
+    adj.cornerEdge.assign(ncorners, -1);
+#pragma omp parallel for
+    for (int lo = 0; lo < adj.numVerts; lo++) {
+        int e = edgeBase[lo] - 1, k = cornBase[lo], prevhi = -1;
+        for (int i = loStart[lo]; i < loStart[lo + 1]; i++) {
+            auto [hi, id] = bucket[i];
+            if (hi != prevhi) {
+                prevhi = hi;
+                ++e;
+                adj.edges[e] = {lo, hi};
+                adj.edgeStart[e] = k;
+            }
+            if (id >= 0) {
+                adj.edgeCorners[k++] = id;
+                adj.cornerEdge[id] = e;
+            }
+        }
+    }
+
+}
+
+}
+
+ZENO_API uint64_t primTopologyHash(PrimitiveObject const *prim) {
+    uint64_t h = prim->verts.size();
+    h = hashArray(prim->lines.values, h);
+    h = hashArray(prim->tris.values, h);
+    h = hashArray(prim->quads.values, h);
+    h = hashArray(prim->polys.values, h);
+    h = hashArray(prim->loops.values, h);
+    return h;
+}
+
+ZENO_API std::shared_ptr<PrimitiveAdjacency const> primAdjacency(PrimitiveObject *prim, bool withEdges) {
+    auto hash = primTopologyHash(prim);
+    auto const &cached = prim->adjacency.ptr;
+    if (cached && cached->topoHash == hash && (cached->hasEdges || !withEdges))
+        return cached;
+    auto adj = std::make_shared<PrimitiveAdjacency>();
+    adj->topoHash = hash;
+    buildAdjacency(prim, *adj, withEdges);
+    log_debug("built adjacency: {} faces, {} edges", adj->numFaces(), adj->edges.size());
+    prim->adjacency.ptr = adj;
+    return adj;
+}
+
+}
@@ -0,0 +1,139 @@
+#include <zeno/zeno.h>
+#include <zeno/types/PrimitiveObject.h>
+#include <zeno/types/AttrExprObject.h>
+#include <zeno/types/NumericObject.h>
+#include <zeno/utils/Error.h>
+#include <map>
+
+namespace zeno {
+namespace {
+
+// the AttrExpr nodes only record what to compute, PrimAttrExprEval runs the
+// whole chain in one pass over the vertices
+
+struct AttrExprNode : INode {
+    // an operand is either an expression or a number used for every vertex
+    std::shared_ptr<AttrExprObject> exprInput(std::string const &id) const {
+        if (has_input<AttrExprObject>(id))
+            return get_input<AttrExprObject>(id);
+        auto num = get_input<NumericObject>(id);
+        if (num->is<float>() || num->is<int>())
+            return AttrExprObject::constant(vec3f(num->get<float>()), 1);
+        return AttrExprObject::constant(num->get<vec3f>(), 3);
+    }
+};
+
+struct AttrExprFromPrim : INode {
+    virtual void apply() override {
+        auto prim = get_input<PrimitiveObject>("prim");
+        auto attr = get_input2<std::string>("attr");
+        set_output("expr", AttrExprObject::attr(std::move(prim), attr));
+    }
+};
+
+ZENDEFNODE(AttrExprFromPrim, {
+    {
+    {"PrimitiveObject", "prim"},
+    {"string", "attr", "pos"},
+    },
+    {
+    {"AttrExprObject", "expr"},
+    },
+    {
+    },
+    {"primitive"},
+});
+
+struct AttrExprUnary : AttrExprNode {
+    virtual void apply() override {
+        static const std::map<std::string, AttrExprObject::Op> ops = {
+            {"neg", AttrExprObject::Neg}, {"abs", AttrExprObject::Abs}, {"sqrt", AttrExprObject::Sqrt},
+            {"sin", AttrExprObject::Sin}, {"cos", AttrExprObject::Cos}, {"tan", AttrExprObject::Tan},
+            {"asin", AttrExprObject::Asin}, {"acos", AttrExprObject::Acos}, {"atan", AttrExprObject::Atan},
+            {"exp", AttrExprObject::Exp}, {"log", AttrExprObject::Log},
+            {"floor", AttrExprObject::Floor}, {"ceil", AttrExprObject::Ceil},
+        };
+        auto a = exprInput("a");
+        auto op = get_input2<std::string>("op");
+        auto it = ops.find(op);
+        if (it == ops.end())
+            throw makeError<KeyError>(op, "op of AttrExprUnary");
+        set_output("expr", AttrExprObject::unary(it->second, *a));
+    }
+};
+
+ZENDEFNODE(AttrExprUnary, {
+    {
+    {"AttrExprObject", "a"},
+    {"enum neg abs sqrt sin cos tan asin acos atan exp log floor ceil", "op", "neg"},
+    },
+    {
+    {"AttrExprObject", "expr"},
+    },
+    {
+    },
+    {"primitive"},
+});
+
+struct AttrExprBinary : AttrExprNode {
+    virtual void apply() override {
+        // the r-prefixed ops take their operands the other way round
+        static const std::map<std::string, AttrExprObject::Op> ops = {
+            {"add", AttrExprObject::Add}, {"sub", AttrExprObject::Sub}, {"mul", AttrExprObject::Mul},
+            {"div", AttrExprObject::Div}, {"pow", AttrExprObject::Pow}, {"atan2", AttrExprObject::Atan2},
+            {"min", AttrExprObject::Min}, {"max", AttrExprObject::Max},
+        };
+        auto a = exprInput("a");
+        auto b = exprInput("b");
+        auto op = get_input2<std::string>("op");
+        if (op.size() > 1 && op[0] == 'r' && ops.count(op.substr(1))) {
+            op = op.substr(1);
+            std::swap(a, b);
+        }
+        auto it = ops.find(op);
+        if (it == ops.end())
+            throw makeError<KeyError>(op, "op of AttrExprBinary");
+        set_output("expr", AttrExprObject::binary(it->second, *a, *b));
+    }
+};
+
+ZENDEFNODE(AttrExprBinary, {
+    {
+    {"AttrExprObject", "a"},
+    {"AttrExprObject", "b"},
+    {"enum add sub rsub mul div rdiv pow rpow atan2 ratan2 min max", "op", "add"},
+    },
+    {
+    {"AttrExprObject", "expr"},
+    },
+    {
+    },
+    {"primitive"},
+});
+
+struct PrimAttrExprEval : INode {
+    virtual void apply() override {
+        auto prim = get_input<PrimitiveObject>("prim");
+        auto expr = get_input<AttrExprObject>("expr");
+        auto attr = get_input2<std::string>("attr");
+        expr->eval(prim.get(), attr);
+        set_output("prim", std::move(prim));
+    }
+};
+
+ZENDEFNODE(PrimAttrExprEval, {
+    {
+    {"PrimitiveObject", "prim"},
+    {"AttrExprObject", "expr"},
+    {"string", "attr", "tmp"},
+    },
+    {
+    {"PrimitiveObject", "prim"},
+    },
+    {
+    },
+    {"primitive"},
+});
+
+}
+}
@@ -2,6 +2,7 @@
 #include <zeno/types/StringObject.h>
 #include <zeno/types/PrimitiveObject.h>
 #include <zeno/funcs/PrimitiveUtils.h>
+#include <zeno/funcs/PrimitiveAdjacency.h>
 #include <zeno/utils/variantswitch.h>
 #include <zeno/utils/arrayindex.h>
 #include <zeno/utils/scope_exit.h>
@@ -102,57 +103,66 @@ struct PrimDualMesh : INode {
             primPolygonate(prim.get());
         }
 
+        auto adj = primAdjacency(prim.get(), keepBounds);
+        int polybase = adj->numTris + adj->numQuads;
+        auto oldpolysize = prim->polys.size();
+
+        // faces around each vertex, in ascending order as the polys are
+        auto facesOfVert = [&] (int v) {
+            std::vector<int> faceids;
+            for (int k = adj->vertStart[v]; k < adj->vertStart[v + 1]; k++) {
+                int f = adj->cornerFace[adj->vertCorners[k]];
+                if (f >= polybase)
+                    faceids.push_back(f - polybase);
+            }
+            return faceids;
+        };
+
         scope_exit<> revertoldpolysize;
+        std::map<int, std::vector<int>> boundv2f;
         if (keepBounds) {
-            std::map<std::pair<int, int>, int> bounde2f;
-            {
-                std::vector<std::pair<int, int>> notbound;
-                for (int f = 0; f < prim->polys.size(); f++) {
-                    auto each_edge = [&] (int v1, int v2) {
-                        std::pair<int, int> key(std::min(v1, v2), std::max(v1, v2));
-                        auto [it, succ] = bounde2f.try_emplace(key, f);
-                        if (!succ) {
-                            notbound.push_back(key);
-                            it->second = -1;
-                        }
-                    };
-                    auto [start, len] = prim->polys[f];
-                    if (len >= 1) {
-                        for (int l = start; l < start + len - 1; l++) {
-                            each_edge(prim->loops[l], prim->loops[l + 1]);
-                        }
-                        each_edge(prim->loops[start + len - 1], prim->loops[start]);
-                    }
-                }
-                for (auto const &nbk: notbound)
-                    bounde2f.erase(nbk);
-            }
-            auto oldpolysize = prim->polys.size();
             revertoldpolysize = scope_exit<>([prim, oldpolysize] {
                 prim->polys.resize(oldpolysize);
             });
-            for (auto const &[ev, f]: bounde2f) {
-                auto [v1, v2] = ev;
+            // boundary edges are the ones used by exactly one poly corner
+            for (int e = 0; e < adj->edges.size(); e++) {
+                int npolycorns = 0;
+                for (int k = adj->edgeStart[e]; k < adj->edgeStart[e + 1]; k++) {
+                    if (adj->cornerFace[adj->edgeCorners[k]] >= polybase)
+                        npolycorns++;
+                }
+                if (npolycorns != 1)
+                    continue;
+                auto [v1, v2] = adj->edges[e];
                 int loopbase = prim->loops.size();
                 prim->loops.push_back(v1);
                 prim->loops.push_back(v2);
+                boundv2f[v1].push_back(prim->polys.size());
+                boundv2f[v2].push_back(prim->polys.size());
                 prim->polys.emplace_back(loopbase, 2);
             }
         }
 
-        std::map<int, std::vector<int>> v2f;
         outprim->verts.resize(prim->polys.size());
+#pragma omp parallel for
         for (int f = 0; f < prim->polys.size(); f++) {
             meth_average<vec3f> reducer;
             auto [start, len] = prim->polys[f];
             for (int l = start; l < start + len; l++) {
-                int v = prim->loops[l];
-                reducer.add(prim->verts[v]);
-                v2f[v].push_back(f);
+                reducer.add(prim->verts[prim->loops[l]]);
             }
             outprim->verts[f] = reducer.get();
         }
 
+        std::vector<std::pair<int, std::vector<int>>> v2f;
+        for (int v = 0; v < adj->numVerts; v++) {
+            auto faceids = facesOfVert(v);
+            if (auto it = boundv2f.find(v); it != boundv2f.end())
+                faceids.insert(faceids.end(), it->second.begin(), it->second.end());
+            if (!faceids.empty())
+                v2f.emplace_back(v, std::move(faceids));
+        }
+
         std::for_each(v2f.begin(), v2f.end(), [&] (auto const &v2fent) {
             auto const &[vid, faceids] = v2fent;
             int loopbase = outprim->loops.size();
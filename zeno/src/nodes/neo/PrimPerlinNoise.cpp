@@ -5,10 +5,10 @@
 #include <zeno/types/NumericObject.h>
 #include <zeno/utils/variantswitch.h>
 #include <zeno/utils/arrayindex.h>
-#include <zeno/para/parallel_for.h>
 #include <zeno/utils/perlin.h>
 #include <zeno/utils/vec.h>
 #include <zeno/utils/log.h>
+#include <algorithm>
 #include <cstring>
 #include <cstdlib>
 #ifndef M_PI
@@ -22,39 +22,56 @@ ZENO_API void primPerlinNoise(PrimitiveObject *prim, std::string inAttr, std::st
         std::visit([&] (auto outTypeId) {
             using InT = std::decay_t<decltype(inArr[0])>;
             using OutT = decltype(outTypeId);
-            auto &outArr = prim->add_attr<OutT>(outAttr);
-            parallel_for((size_t)0, inArr.size(), [&] (size_t i) {
-                vec3f p;
-                InT inp = inArr[i];
-                if constexpr (std::is_same_v<InT, float>) {
-                    p = {inp, 0, 0};
-                } else if constexpr (std::is_same_v<InT, int>) {
-                    p = {(float)inp, 0, 0};
-                } else if constexpr (std::is_same_v<InT, vec2f>) {
-                    p = {inp[0], inp[1], 0};
-                } else if constexpr (std::is_same_v<InT, vec3f>) {
-                    p = inp;
-                } else if constexpr (std::is_same_v<InT, vec4f>) {
-                    p = {inp[0], inp[1], inp[2]};
-                } else {
-                    throw makeError<TypeError>(typeid(vec3f), typeid(InT), "input type");
+            if constexpr (!(std::is_same_v<InT, float> || std::is_same_v<InT, int> || std::is_same_v<InT, vec2f>
+                            || std::is_same_v<InT, vec3f> || std::is_same_v<InT, vec4f>)) {
+                throw makeError<TypeError>(typeid(vec3f), typeid(InT), "input type");
+            } else if constexpr (!(std::is_same_v<OutT, float> || std::is_same_v<OutT, vec3f>)) {
+                throw makeError<TypeError>(typeid(vec3f), typeid(OutT), "outType");
+            } else {
+                auto &outArr = prim->add_attr<OutT>(outAttr);
+                // points go through the noise a batch at a time, in parallel over batches
+                constexpr int B = PerlinNoise::batch;
+                std::size_t size = inArr.size();
+#pragma omp parallel for
+                for (std::ptrdiff_t base = 0; base < (std::ptrdiff_t)size; base += B) {
+                    int n = (int)std::min<std::size_t>(B, size - base);
+                    float px[B], py[B], pz[B];
+                    for (int l = 0; l < n; l++) {
+                        vec3f p;
+                        InT inp = inArr[base + l];
+                        if constexpr (std::is_same_v<InT, float>) {
+                            p = {inp, 0, 0};
+                        } else if constexpr (std::is_same_v<InT, int>) {
+                            p = {(float)inp, 0, 0};
+                        } else if constexpr (std::is_same_v<InT, vec2f>) {
+                            p = {inp[0], inp[1], 0};
+                        } else if constexpr (std::is_same_v<InT, vec3f>) {
+                            p = inp;
+                        } else {
+                            p = {inp[0], inp[1], inp[2]};
+                        }
+                        p = scale * (p - offset);
+                        px[l] = p[0];
+                        py[l] = p[1];
+                        pz[l] = p[2];
+                    }
+                    float o[3][B];
+                    PerlinNoise::perlin_batch(n, px, py, pz, roughness, detail, o[0]);
+                    if constexpr (std::is_same_v<OutT, vec3f>) {
+                        PerlinNoise::perlin_batch(n, py, pz, px, roughness, detail, o[1]);
+                        PerlinNoise::perlin_batch(n, pz, px, py, roughness, detail, o[2]);
+                    }
+                    for (int l = 0; l < n; l++) {
+                        OutT v;
+                        if constexpr (std::is_same_v<OutT, float>) {
+                            v = o[0][l];
+                        } else {
+                            v = {o[0][l], o[1][l], o[2][l]};
+                        }
+                        outArr[base + l] = average + v * strength;
+                    }
                 }
-                p = scale * (p - offset);
-                OutT o;
-                if constexpr (std::is_same_v<OutT, float>) {
-                    o = PerlinNoise::perlin(p, roughness, detail);
-                } else if constexpr (std::is_same_v<OutT, vec3f>) {
-                    o = {
-                        PerlinNoise::perlin(vec3f(p[0], p[1], p[2]), roughness, detail),
-                        PerlinNoise::perlin(vec3f(p[1], p[2], p[0]), roughness, detail),
-                        PerlinNoise::perlin(vec3f(p[2], p[0], p[1]), roughness, detail),
-                    };
-                } else {
-                    throw makeError<TypeError>(typeid(vec3f), typeid(OutT), "outType");
-                }
-                o = average + o * strength;
-                outArr[i] = o;
-            });
+            }
         }, enum_variant<std::variant<float, vec3f>>(array_index_safe({"float", "vec3f"}, outType, "outType")));
     });
 }
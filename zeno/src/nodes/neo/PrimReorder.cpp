@@ -0,0 +1,164 @@
+#include <zeno/zeno.h>
+#include <zeno/types/PrimitiveObject.h>
+#include <zeno/funcs/PrimitiveUtils.h>
+#include <zeno/extra/GlobalState.h>
+#include <zeno/utils/morton.h>
+#include <zeno/utils/Error.h>
+#include <algorithm>
+#include <cstdint>
+
+namespace zeno {
+
+namespace {
+
+// stable lsd radix sort on bits [32, 64) of the keys, each pass histograms and
+// scatters fixed chunks in parallel so the result does not depend on the thread count
+void radixSortHigh32(std::vector<uint64_t> &keys) {
+    constexpr std::ptrdiff_t kChunk = 1 << 16;
+    std::ptrdiff_t n = keys.size();
+    std::ptrdiff_t nchunks = (n + kChunk - 1) / kChunk;
+    std::vector<uint64_t> tmp(n);
+    std::vector<std::ptrdiff_t> offs(nchunks * 256);
+    for (int shift = 32; shift < 64; shift += 8) {
+#pragma omp parallel for
+        for (std::ptrdiff_t c = 0; c < nchunks; c++) {
+            std::ptrdiff_t *hist = offs.data() + c * 256;
+            std::fill_n(hist, 256, 0);
+            for (std::ptrdiff_t i = c * kChunk; i < std::min(n, (c + 1) * kChunk); i++)
+                hist[keys[i] >> shift & 255]++;
+        }
+        // every key has the same digit here, the pass would not move anything
+        bool same = false;
+        for (int d = 0; d < 256 && !same; d++) {
+            std::ptrdiff_t cnt = 0;
+            for (std::ptrdiff_t c = 0; c < nchunks; c++)
+                cnt += offs[c * 256 + d];
+            same = cnt == n;
+        }
+        if (same)
+            continue;
+        std::ptrdiff_t sum = 0;
+        for (int d = 0; d < 256; d++) {
+            for (std::ptrdiff_t c = 0; c < nchunks; c++) {
+                auto cnt = offs[c * 256 + d];
+                offs[c * 256 + d] = sum;
+                sum += cnt;
+            }
+        }
+#pragma omp parallel for
+        for (std::ptrdiff_t c = 0; c < nchunks; c++) {
+            std::ptrdiff_t *dst = offs.data() + c * 256;
+            for (std::ptrdiff_t i = c * kChunk; i < std::min(n, (c + 1) * kChunk); i++)
+                tmp[dst[keys[i] >> shift & 255]++] = keys[i];
+        }
+        std::swap(keys, tmp);
+    }
+}
+
+template <class T>
+void gatherVector(std::vector<T> &arr, std::vector<int> const &order) {
+    std::vector<T> newarr(order.size());
+#pragma omp parallel for
+    for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)order.size(); i++) {
+        newarr[i] = arr[order[i]];
+    }
+    std::swap(arr, newarr);
+}
+
+template <class T>
+void remapIndices(std::vector<T> &arr, std::vector<int> const &unorder) {
+#pragma omp parallel for
+    for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)arr.size(); i++) {
+        if constexpr (std::is_same_v<T, int>) {
+            arr[i] = unorder[arr[i]];
+        } else {
+            for (std::size_t j = 0; j < std::tuple_size_v<T>; j++)
+                arr[i][j] = unorder[arr[i][j]];
+        }
+    }
+}
+
+}
+
+// vertex order along a z-curve through the bounding box, so verts close in space
+// end up close in memory; order[i] is the old index of the new vertex i
+ZENO_API std::vector<int> primMortonOrder(PrimitiveObject *prim) {
+    std::ptrdiff_t n = prim->verts.size();
+    auto [bmin, bmax] = primBoundingBox(prim);
+    // 10 bits per axis like LBvh, finer cells would hardly ever hold two verts
+    auto scale = 1023.f / zeno::max(bmax - bmin, vec3f(1e-20f));
+    std::vector<uint64_t> keys(n);
+#pragma omp parallel for
+    for (std::ptrdiff_t i = 0; i < n; i++) {
+        auto c = zeno::clamp((prim->verts[i] - bmin) * scale, 0.f, 1023.f);
+        uint64_t code = morton3d::encode((uint64_t)c[0], (uint64_t)c[1], (uint64_t)c[2]);
+        keys[i] = code << 32 | (uint64_t)i;
+    }
+    radixSortHigh32(keys);
+    std::vector<int> order(n);
+#pragma omp parallel for
+    for (std::ptrdiff_t i = 0; i < n; i++) {
+        order[i] = (int)(keys[i] & 0xffffffffu);
+    }
+    return order;
+}
+
+ZENO_API void primReorderVerts(PrimitiveObject *prim, std::vector<int> const &order, std::string revampAttrO) {
+    if (order.size() != prim->verts.size())
+        throw makeError("vertex order of size " + std::to_string(order.size())
+                        + " for a primitive of " + std::to_string(prim->verts.size()) + " verts");
+    prim->verts.forall_attr<AttrAcceptAll>([&] (auto const &key, auto &arr) {
+        gatherVector(arr, order);
+    });
+    std::vector<int> unorder(order.size());
+#pragma omp parallel for
+    for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)order.size(); i++) {
+        unorder[order[i]] = (int)i;
+    }
+    remapIndices(prim->points.values, unorder);
+    remapIndices(prim->lines.values, unorder);
+    remapIndices(prim->tris.values, unorder);
+    remapIndices(prim->quads.values, unorder);
+    remapIndices(prim->loops.values, unorder);
+    remapIndices(prim->edges.values, unorder);
+    if (!revampAttrO.empty()) {
+        prim->verts.add_attr<int>(revampAttrO) = order;
+    }
+}
+
+namespace {
+
+struct PrimReorder : INode {
+    std::vector<int> m_order;
+
+    virtual void apply() override {
+        auto prim = get_input<PrimitiveObject>("prim");
+        auto interval = get_input2<int>("interval");
+        auto revampAttrO = get_input2<std::string>("revampAttrO");
+        // in between the frames that sort, the last order is used again as long
+        // as the vertex count is the same, which keeps the verts in the same
+        // order from frame to frame and saves the sort
+        int frameid = getGlobalState()->frameid;
+        if (m_order.size() != prim->verts.size() || interval <= 1 || frameid % interval == 0)
+            m_order = primMortonOrder(prim.get());
+        primReorderVerts(prim.get(), m_order, revampAttrO);
+        set_output("prim", std::move(prim));
+    }
+};
+
+ZENDEFNODE(PrimReorder, {
+    {
+    {"PrimitiveObject", "prim"},
+    {"int", "interval", "1"},
+    {"string", "revampAttrO", ""},
+    },
+    {
+    {"PrimitiveObject", "prim"},
+    },
+    {
+    },
+    {"primitive"},
+});
+
+}
+}
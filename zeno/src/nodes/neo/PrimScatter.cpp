@@ -5,13 +5,16 @@
 #include <zeno/types/NumericObject.h>
 #include <zeno/para/parallel_for.h>
 #include <zeno/para/parallel_scan.h>
+#include <zeno/para/parallel_reduce.h>
 #define ZENO_NOTICKTOCK
 #include <zeno/utils/ticktock.h>
 #include <zeno/utils/variantswitch.h>
 #include <zeno/utils/wangsrng.h>
-#include <zeno/utils/tuple_hash.h>
 #include <zeno/utils/log.h>
-#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <tuple>
 #include <random>
 #include <cmath>
 #ifndef M_PI
@@ -29,48 +32,189 @@ static void revamp_vector(std::vector<T> &arr, std::vector<int> const &revamp) {
     std::swap(arr, newarr);
 }
 
-static void primPossionFilter(PrimitiveObject *prim, float minRadius) {
-    if (minRadius <= 0) return;
+static void primPossionFilter(PrimitiveObject *prim, float minRadius, int seed) {
+    if (minRadius <= 0 || prim->verts.size() <= 1) return;
 
     TICK(possion);
-    float invRadius = 1.f / minRadius;
-    std::unordered_map<vec3i, std::vector<int>, tuple_hash, tuple_equal> lut;
-    for (int i = 0; i < prim->verts.size(); i++) {
-        vec3i ipos(prim->verts[i] * invRadius);
-        lut[ipos].push_back(i);
+    // cells are minRadius/sqrt(3) wide, so two points in one cell are always too
+    // close and each cell keeps at most one; conflicts reach two cells away, so
+    // cells whose coordinates agree modulo 3 (one of 27 phase groups) never see
+    // each other and a whole group can be decided in parallel
+    float cellSize = minRadius * 0.577f;
+    float invCell = 1.f / cellSize;
+    auto [bmin, bmax] = parallel_reduce_minmax(prim->verts.begin(), prim->verts.end());
+    std::size_t nverts = prim->verts.size();
+
+    std::vector<vec3i> ipos(nverts);
+#pragma omp parallel for
+    for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)nverts; i++) {
+        ipos[i] = vec3i(zeno::floor((prim->verts[i] - bmin) * invCell));
+    }
+
+    // cell coordinates to cell index, through a dense grid over the bounding box
+    // when it has no more cells than a hash table would have slots, through open
+    // addressing otherwise
+    auto dims = vec3i(zeno::floor((bmax - bmin) * invCell)) + 1;
+    std::size_t cap = 16;
+    while (cap < 2 * nverts)
+        cap *= 2;
+    bool dense = (double)dims[0] * dims[1] * dims[2] <= (double)cap;
+    if (dense)
+        cap = (std::size_t)dims[0] * dims[1] * dims[2];
+    std::vector<vec3i> tabKey(dense ? 0 : cap);
+    std::vector<int> tabCell(cap, -1);
+    auto slotOf = [&] (vec3i const &c) -> std::ptrdiff_t {
+        if (dense) {
+            if (anytrue(c < 0) || anytrue(c >= dims))
+                return -1;
+            return ((std::ptrdiff_t)c[2] * dims[1] + c[1]) * dims[0] + c[0];
+        }
+        std::uint64_t k = ((std::uint64_t)(std::uint32_t)c[2] * 0x9e3779b97f4a7c15ull)
+            ^ ((std::uint64_t)(std::uint32_t)c[1] * 0xc2b2ae3d27d4eb4full)
+            ^ ((std::uint64_t)(std::uint32_t)c[0] * 0x165667b19e3779f9ull);
+        std::size_t h = (std::size_t)(k >> 20) & (cap - 1);
+        while (tabCell[h] != -1 && anytrue(tabKey[h] != c))
+            h = (h + 1) & (cap - 1);
+        return h;
+    };
+    // cells are numbered in z, y, x order, so that neighbouring cells are close in memory
+    std::vector<int> cellOf(nverts);
+    std::vector<vec3i> cellPos;
+    if (dense) {
+        for (std::size_t i = 0; i < nverts; i++)
+            tabCell[slotOf(ipos[i])] = 0;
+        for (std::size_t h = 0; h < cap; h++) {
+            if (tabCell[h] == -1)
+                continue;
+            tabCell[h] = (int)cellPos.size();
+            cellPos.emplace_back(h % dims[0], h / dims[0] % dims[1], h / dims[0] / dims[1]);
+        }
+#pragma omp parallel for
+        for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)nverts; i++) {
+            cellOf[i] = tabCell[slotOf(ipos[i])];
+        }
+    } else {
+        for (std::size_t i = 0; i < nverts; i++) {
+            auto h = slotOf(ipos[i]);
+            if (tabCell[h] == -1) {
+                tabKey[h] = ipos[i];
+                tabCell[h] = (int)cellPos.size();
+                cellPos.push_back(ipos[i]);
+            }
+            cellOf[i] = tabCell[h];
+        }
+        std::vector<int> order(cellPos.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&] (int l, int r) {
+            auto const &a = cellPos[l], &b = cellPos[r];
+            return std::tie(a[2], a[1], a[0]) < std::tie(b[2], b[1], b[0]);
+        });
+        std::vector<int> rank(cellPos.size());
+        std::vector<vec3i> sortedPos(cellPos.size());
+        for (std::size_t k = 0; k < order.size(); k++) {
+            rank[order[k]] = (int)k;
+            sortedPos[k] = cellPos[order[k]];
+        }
+        std::swap(cellPos, sortedPos);
+        for (auto &c: tabCell) {
+            if (c != -1)
+                c = rank[c];
+        }
+#pragma omp parallel for
+        for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)nverts; i++) {
+            cellOf[i] = rank[cellOf[i]];
+        }
+    }
+    auto findCell = [&] (vec3i const &c) {
+        auto h = slotOf(c);
+        return h < 0 ? -1 : tabCell[h];
+    };
+
+    // candidates of each cell in index order, the order they are tried in
+    std::size_t ncells = cellPos.size();
+    std::vector<int> cellStart(ncells + 1);
+    for (std::size_t i = 0; i < nverts; i++)
+        cellStart[cellOf[i] + 1]++;
+    for (std::size_t c = 0; c < ncells; c++)
+        cellStart[c + 1] += cellStart[c];
+    std::vector<int> cellNext(cellStart.begin(), cellStart.end() - 1);
+    std::vector<int> cellCands(nverts);
+    for (std::size_t i = 0; i < nverts; i++)
+        cellCands[cellNext[cellOf[i]]++] = (int)i;
+    for (std::size_t c = 0; c < ncells; c++)
+        cellNext[c] = cellStart[c];
+
+    std::vector<int> cellKept(ncells, -1);
+    std::vector<vec3f> cellKeptPos(ncells);
+    std::vector<int> phaseCells[27];
+    for (std::size_t c = 0; c < ncells; c++) {
+        auto p = cellPos[c];
+        phaseCells[(p[2] % 3 * 3 + p[1] % 3) * 3 + p[0] % 3].push_back((int)c);
     }
 
-    std::vector<uint8_t> erased(prim->verts.size());
-    for (int i = 0; i < prim->verts.size(); i++) {
-        if (erased[i])
-            continue;
-        vec3i ipos(prim->verts[i] * invRadius);
-        erased[i] = [&] {
-            for (int dz = -1; dz <= 1; dz++) {
-                for (int dy = -1; dy <= 1; dy++) {
-                    for (int dx = -1; dx <= 1; dx++) {
-                        auto it = lut.find(ipos + vec3i(dx, dy, dz));
-                        if (it != lut.end()) {
-                            for (int j: it->second) {
-                                if (j == i || erased[j])
-                                    continue;
-                                auto dis = prim->verts[i] - prim->verts[j];
-                                if (length(dis) < minRadius)
-                                    return true;
-                            }
-                        }
+    // neighbouring cells nearest first, they are the likeliest to hold a conflict
+    std::vector<vec3i> offsets;
+    for (int dz = -2; dz <= 2; dz++) {
+        for (int dy = -2; dy <= 2; dy++) {
+            for (int dx = -2; dx <= 2; dx++) {
+                if (dx || dy || dz)
+                    offsets.emplace_back(dx, dy, dz);
+            }
+        }
+    }
+    std::stable_sort(offsets.begin(), offsets.end(), [] (vec3i const &l, vec3i const &r) {
+        return dot(l, l) < dot(r, r);
+    });
+
+    // each pass visits the phase groups in a fresh random order, every cell of a
+    // group tries its next candidate against the points kept around it so far,
+    // cells are done once they keep a point or run out of candidates
+    std::mt19937 rng(seed);
+    int phaseOrder[27];
+    for (int p = 0; p < 27; p++)
+        phaseOrder[p] = p;
+    for (bool busy = true; busy;) {
+        busy = false;
+        std::shuffle(phaseOrder, phaseOrder + 27, rng);
+        for (int p: phaseOrder) {
+            auto &cells = phaseCells[p];
+#pragma omp parallel for
+            for (std::ptrdiff_t k = 0; k < (std::ptrdiff_t)cells.size(); k++) {
+                int c = cells[k];
+                int i = cellCands[cellNext[c]++];
+                auto pos = prim->verts[i];
+                bool conflict = false;
+                for (auto const &off: offsets) {
+                    int nc = findCell(cellPos[c] + off);
+                    if (nc == -1 || cellKept[nc] == -1)
+                        continue;
+                    if (length(cellKeptPos[nc] - pos) < minRadius) {
+                        conflict = true;
+                        break;
                     }
                 }
+                if (!conflict) {
+                    cellKept[c] = i;
+                    cellKeptPos[c] = pos;
+                }
             }
-            return false;
-        }();
+            cells.erase(std::remove_if(cells.begin(), cells.end(), [&] (int c) {
+                return cellKept[c] != -1 || cellNext[c] == cellStart[c + 1];
+            }), cells.end());
+            busy = busy || !cells.empty();
+        }
     }
 
-    std::vector<int> revamp(prim->verts.size());
+    std::vector<uint8_t> kept(nverts);
+    for (std::size_t c = 0; c < ncells; c++) {
+        if (cellKept[c] != -1)
+            kept[cellKept[c]] = 1;
+    }
+    std::vector<int> revamp(nverts);
     int nrevamp = 0;
-    for (int i = 0; i < erased.size(); i++) {
-        if (!erased[i])
-            revamp[nrevamp++] = i;
+    for (std::size_t i = 0; i < nverts; i++) {
+        if (kept[i])
+            revamp[nrevamp++] = (int)i;
     }
     revamp.resize(nrevamp);
 
@@ -201,7 +345,7 @@ ZENO_API std::shared_ptr<PrimitiveObject> primScatter(
     }
 
     TOCK(scatter);
-    primPossionFilter(retprim.get(), minRadius);
+    primPossionFilter(retprim.get(), minRadius, seed);
 
     return retprim;
 }
@@ -0,0 +1,139 @@
+#include <zeno/utils/perlin.h>
+#include <cmath>
+
+// the batch kernels are written as loops over the lanes of a batch, which the
+// compiler turns into vector code, and on x86-64 linux they are built once per
+// instruction set so that the widest one the cpu supports is picked at load time,
+// multiply-adds are not fused (see CMakeLists.txt) so every clone matches the scalar code
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__)
+#define ZENO_NOISE_CLONES __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define ZENO_NOISE_CLONES
+#endif
+
+namespace zeno {
+
+namespace {
+
+// std::floor that vectorizes, floats of magnitude 2^23 and above are integral already
+inline float floor_lane(float t) {
+    float f = (float)(int)t;
+    f -= (float)(f > t);
+    return std::abs(t) < 8388608.f ? f : t;
+}
+
+inline float fract_lane(float t) {
+    return t - floor_lane(t);
+}
+
+// PerlinNoise1::grad without the switch, the same sums for every hash
+inline float grad_lane(int hash, float x, float y, float z) {
+    int h = hash & 0xF;
+    float u = h < 8 ? x : y;
+    float v = h < 4 ? y : (h | 2) == 14 ? x : z;
+    return ((h & 1) ? -u : u) + ((h & 2) ? -v : v);
+}
+
+}
+
+ZENO_NOISE_CLONES
+void PerlinNoise1::perlin_batch(int n, float const *x, float const *y, float const *z, float *out) {
+    constexpr auto &P = permutation;
+#pragma omp simd
+    for (int l = 0; l < n; l++) {
+        float xx = fract_lane(x[l] / 256.f) * 256.f;
+        float yy = fract_lane(y[l] / 256.f) * 256.f;
+        float zz = fract_lane(z[l] / 256.f) * 256.f;
+        int xi = (int)xx & 255;
+        int yi = (int)yy & 255;
+        int zi = (int)zz & 255;
+        float xf = xx - (int)xx;
+        float yf = yy - (int)yy;
+        float zf = zz - (int)zz;
+        float u = fade(xf);
+        float v = fade(yf);
+        float w = fade(zf);
+        int aa = P[P[xi] + yi] + zi;
+        int ab = P[P[xi] + yi + 1] + zi;
+        int ba = P[P[xi + 1] + yi] + zi;
+        int bb = P[P[xi + 1] + yi + 1] + zi;
+        float x1 = mix(grad_lane(P[aa], xf, yf, zf), grad_lane(P[ba], xf - 1, yf, zf), u);
+        float x2 = mix(grad_lane(P[ab], xf, yf - 1, zf), grad_lane(P[bb], xf - 1, yf - 1, zf), u);
+        float y1 = mix(x1, x2, v);
+        x1 = mix(grad_lane(P[aa + 1], xf, yf, zf - 1), grad_lane(P[ba + 1], xf - 1, yf, zf - 1), u);
+        x2 = mix(grad_lane(P[ab + 1], xf, yf - 1, zf - 1), grad_lane(P[bb + 1], xf - 1, yf - 1, zf - 1), u);
+        float y2 = mix(x1, x2, v);
+        out[l] = mix(y1, y2, w);
+    }
+}
+
+namespace {
+
+// PerlinNoise::perlin_lev1 at a * frequency, in passes so that only the one
+// taking the sines of the corner hashes runs lane by lane
+ZENO_NOISE_CLONES
+void perlin_lev1_batch(int n, float const *x, float const *y, float const *z, float frequency, float *out) {
+    constexpr int B = PerlinNoise::batch;
+    float pi[3][B], pf[3][B], w[3][B], h[8][3][B];
+#pragma omp simd
+    for (int l = 0; l < n; l++) {
+        float p[3] = {x[l] * frequency, y[l] * frequency, z[l] * frequency};
+        for (int k = 0; k < 3; k++) {
+            pi[k][l] = floor_lane(p[k]);
+            pf[k][l] = p[k] - pi[k][l];
+            w[k][l] = pf[k][l] * pf[k][l] * (3.0f - 2.0f * pf[k][l]);
+        }
+        for (int c = 0; c < 8; c++) {
+            float q0 = pi[0][l] + (float)(c & 1), q1 = pi[1][l] + (float)(c >> 1 & 1), q2 = pi[2][l] + (float)(c >> 2);
+            h[c][0][l] = 0.f + q0 * 127.1f + q1 * 311.7f + q2 * 284.4f;
+            h[c][1][l] = 0.f + q0 * 269.5f + q1 * 183.3f + q2 * 162.2f;
+            h[c][2][l] = 0.f + q0 * 228.3f + q1 * 164.9f + q2 * 126.0f;
+        }
+    }
+    // points next to each other often share a cell, its corner hashes are then taken once
+    for (int l = 0; l < n; l++) {
+        bool same = l && pi[0][l] == pi[0][l - 1] && pi[1][l] == pi[1][l - 1] && pi[2][l] == pi[2][l - 1];
+        for (int c = 0; c < 8; c++) {
+            for (int k = 0; k < 3; k++)
+                h[c][k][l] = same ? h[c][k][l - 1] : std::sin(h[c][k][l]);
+        }
+    }
+    float d[8][B];
+    for (int c = 0; c < 8; c++) {
+        float o0 = (float)(c & 1), o1 = (float)(c >> 1 & 1), o2 = (float)(c >> 2);
+#pragma omp simd
+        for (int l = 0; l < n; l++) {
+            float g0 = -1.0f + 2.0f * fract_lane(h[c][0][l] * 43758.5453123f);
+            float g1 = -1.0f + 2.0f * fract_lane(h[c][1][l] * 43758.5453123f);
+            float g2 = -1.0f + 2.0f * fract_lane(h[c][2][l] * 43758.5453123f);
+            d[c][l] = 0.f + g0 * (pf[0][l] - o0) + g1 * (pf[1][l] - o1) + g2 * (pf[2][l] - o2);
+        }
+    }
+#pragma omp simd
+    for (int l = 0; l < n; l++) {
+        out[l] = 0.08f + 0.8f * mix(
+            mix(mix(d[0][l], d[1][l], w[0][l]), mix(d[2][l], d[3][l], w[0][l]), w[1][l]),
+            mix(mix(d[4][l], d[5][l], w[0][l]), mix(d[6][l], d[7][l], w[0][l]), w[1][l]),
+            w[2][l]);
+    }
+}
+
+}
+
+void PerlinNoise::perlin_batch(int n, float const *x, float const *y, float const *z,
+                               float power, float depth, float *out) {
+    float lev[batch];
+    for (int l = 0; l < n; l++)
+        out[l] = 0;
+    int octaves = (int)ceil(depth);
+    for (int i = 0; i < octaves; i++) {
+        float frequency = 1<<i;
+        float amplitude = pow(power,i);
+        amplitude *= 1.f - max(0.f, i - (depth - 1));
+        perlin_lev1_batch(n, x, y, z, frequency, lev);
+        for (int l = 0; l < n; l++)
+            out[l] += lev[l] * amplitude;
+    }
+}
+
+}
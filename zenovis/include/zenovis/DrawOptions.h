@@ -1,6 +1,7 @@
 #pragma once
 
 #include <zenovis/bate/IGraphic.h>
+#include <zenovis/bate/LevelOfDetail.h>
 
 #include <array>
 #include <set>
@@ -20,6 +21,8 @@ struct DrawOptions {
     bool interactive = false;
     std::shared_ptr<IGraphicHandler> handler;
 
+    LodControl lod;
+
     glm::vec3 bgcolor{0.23f, 0.23f, 0.23f};
 };
 
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <map>
+#include <set>
+#include <string>
 #include <vector>
 #include <zeno/types/UserData.h>
 #include <zeno/utils/MapStablizer.h>
@@ -20,13 +22,37 @@ struct GraphicsManager {
     explicit GraphicsManager(Scene *scene) : scene(scene) {
     }
 
+    // view keys are "<node><postfix>:<frame or static>:<session>", the part
+    // before the frame identifies the same view across frames
+    static std::string view_slot(std::string const &key) {
+        auto p = key.rfind(':');
+        if (p == std::string::npos || p == 0)
+            return key;
+        auto q = key.rfind(':', p - 1);
+        return q == std::string::npos ? key : key.substr(0, q);
+    }
+
     bool load_objects(std::vector<std::pair<std::string, std::shared_ptr<zeno::IObject>>> const &objs) {
+        std::map<std::string, std::string> stale;  // view slot -> key of a graphic about to be dropped
+        {
+            std::set<std::string> keys;
+            for (auto const &[key, obj] : objs)
+                keys.insert(key);
+            for (auto const &[key, ig] : graphics)
+                if (!keys.count(key))
+                    stale.emplace(view_slot(key), key);
+        }
         auto ins = graphics.insertPass();
         for (auto const &[key, obj] : objs) {
             if (ins.may_emplace(key)) {
                 zeno::log_debug("load_object: loading graphics [{}]", key);
                 auto ig = makeGraphic(scene, obj.get());
                 zeno::log_debug("load_object: loaded graphics to {}", ig.get());
+                if (auto it = stale.find(view_slot(key)); it != stale.end()) {
+                    if (auto prev = graphics.find(it->second); prev != graphics.end() && prev->second)
+                        ig->recycle(*prev->second);
+                    stale.erase(it);
+                }
                 ig->nameid = key;
                 ig->objholder = obj;
                 ins.try_emplace(key, std::move(ig));
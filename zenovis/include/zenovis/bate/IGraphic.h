@@ -41,6 +41,10 @@ struct IGraphic {
     std::shared_ptr<zeno::IObject> objholder;
 
     virtual ~IGraphic() = default;
+
+    // called on a new graphic before its first draw with the one it replaces
+    // (same view node, previous frame), to take over GPU data that didn't change
+    virtual void recycle(IGraphic &prev) {}
 };
 
 struct IGraphicDraw : IGraphic {
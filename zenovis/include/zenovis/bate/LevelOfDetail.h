@@ -0,0 +1,87 @@
+#pragma once
+
+#include <zeno/utils/vec.h>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace zeno {
+struct PrimitiveObject;
+}
+
+namespace zenovis {
+
+// viewport level of detail settings, the frame budget feedback and what the
+// last frame actually submitted, kept in DrawOptions
+struct LodControl {
+    bool enable = true;
+    std::size_t min_prims = std::size_t(1) << 21;  // objects with fewer points or triangles are drawn in full
+    float frame_budget_ms = 33.0f;                  // gpu time the viewport may take per frame
+    float prims_per_pixel = 2.0f;                   // points or triangles worth drawing per covered pixel
+
+    float budget_scale = 1.0f;  // scales every object's target count, follows the measured frame time
+    std::size_t submitted_points = 0, full_points = 0;
+    std::size_t submitted_tris = 0, full_tris = 0;
+
+    void begin_frame() {
+        submitted_points = full_points = 0;
+        submitted_tris = full_tris = 0;
+    }
+
+    void update_budget(float frame_ms) {
+        if (frame_ms > frame_budget_ms)
+            budget_scale = std::max(1.0f / 1024, budget_scale * std::max(0.5f, frame_budget_ms / frame_ms));
+        else if (frame_ms < frame_budget_ms * 0.7f)
+            budget_scale = std::min(1.0f, budget_scale * 1.25f);
+    }
+
+    // how many of count primitives to draw for an object covering pixels on screen
+    std::size_t target_count(std::size_t count, float pixels) const {
+        float target = prims_per_pixel * pixels * budget_scale;
+        if (target >= (float)count)
+            return count;
+        return std::min(count, std::max(std::size_t(1024), (std::size_t)target));
+    }
+};
+
+// detail levels of a primitive, built on a worker thread when the object is loaded
+struct PrimitiveLod {
+    zeno::vec3f bmin{0}, bmax{0};
+    std::vector<int> pointOrder;                      // all vertices, any prefix is a stratified subset
+    std::vector<std::vector<zeno::vec3i>> triLevels;  // vertex clustered proxies, coarser along the vector
+};
+
+// orders the points so that each prefix samples every region in proportion to its density
+std::vector<int> stratifiedPointOrder(zeno::vec3f const *pos, std::size_t n,
+                                      zeno::vec3f const &bmin, zeno::vec3f const &bmax);
+
+// merges the vertices sharing a cell of a res^3 grid over the bounding box into
+// one of them, dropping the triangles that collapse and the duplicates
+std::vector<zeno::vec3i> clusterTriangles(zeno::vec3f const *pos, std::size_t nverts,
+                                          zeno::vec3i const *tris, std::size_t ntris,
+                                          zeno::vec3f const &bmin, zeno::vec3f const &bmax, int res);
+
+// point order when points is set, triangle levels down to about a thousand triangles when ntris isn't 0,
+// gives up between the steps once *cancelled is set
+PrimitiveLod buildPrimitiveLod(zeno::vec3f const *pos, std::size_t nverts, bool points,
+                               zeno::vec3i const *tris, std::size_t ntris,
+                               std::atomic<bool> const *cancelled = nullptr);
+
+// a lod build queued on the lod worker, result is valid once state is Done
+struct LodJob {
+    enum State { Queued, Running, Done, Dropped };
+    std::atomic<int> state{Queued};
+    std::atomic<bool> cancelled{false};  // set by the owner when it no longer wants the result
+    std::shared_ptr<zeno::PrimitiveObject const> prim;  // released once the build is over
+    bool points = false, tris = false;
+    PrimitiveLod result;
+};
+
+// queues a build on the single lod worker thread; the queue only holds weak
+// references, so jobs whose owner is gone are skipped, and when more than a
+// few are waiting the oldest are Dropped
+std::shared_ptr<LodJob> submitLodJob(std::shared_ptr<zeno::PrimitiveObject const> prim, bool points, bool tris);
+
+} // namespace zenovis
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <zeno/utils/vec.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace zenovis {
+
+// layout of the five vertex channels read by the bate shaders, a channel the
+// primitive doesn't have takes no space and is fed to the shader as a constant
+// attribute value instead, channels are either interleaved or planar (one
+// contiguous block per channel, so that each can be re-uploaded on its own)
+struct VertexLayout {
+    enum Format : unsigned char { Absent, Float3, Half3 };  // Half3 is padded to 8 bytes
+    enum Channel { Pos, Clr, Nrm, Uv, Tang, NumChannels };
+
+    Format format[NumChannels] = {Float3, Float3, Float3, Float3, Float3};
+    std::size_t offset[NumChannels] = {0, 12, 24, 36, 48};  // bytes, a channel block start when planar
+    zeno::vec3f constant[NumChannels]{};
+    unsigned stride = 60;  // bytes per vertex, summed over channels when planar
+    bool planar = false;
+
+    static unsigned formatSize(Format f) {
+        return f == Half3 ? 8 : f == Float3 ? 12 : 0;
+    }
+
+    unsigned channelStride(int c) const {
+        return planar ? formatSize(format[c]) : stride;
+    }
+
+    // whether a buffer packed with other can be partially overwritten by one packed with this
+    bool sameStorage(VertexLayout const &other) const {
+        return planar == other.planar && stride == other.stride &&
+               std::memcmp(format, other.format, sizeof(format)) == 0 &&
+               std::memcmp(offset, other.offset, sizeof(offset)) == 0;
+    }
+};
+
+struct VertexChannelSource {
+    zeno::vec3f const *data = nullptr;  // null to use the constant for every vertex
+    zeno::vec3f constant{0};
+    bool half = false;                  // store as half floats, halves the upload size
+};
+
+// CPU side of a vertex buffer, needs no GL context so it can be built off the GL thread
+struct PackedVertices {
+    VertexLayout layout;
+    std::size_t count = 0;
+    std::vector<std::uint32_t> words;
+    std::uint64_t hash[VertexLayout::NumChannels]{};  // content of each packed channel
+
+    std::size_t bytes() const {
+        return words.size() * sizeof(std::uint32_t);
+    }
+};
+
+std::uint16_t floatToHalf(float f);
+
+// order dependent hash of count records of width words, spaced stride words apart
+std::uint64_t hashWords(std::uint32_t const *words, std::size_t count, unsigned width = 1, unsigned stride = 1);
+
+// channels with data get a slot in the order of VertexLayout::Channel, the rest become constants
+VertexLayout makeVertexLayout(VertexChannelSource const (&src)[VertexLayout::NumChannels],
+                              bool planar = false, std::size_t count = 0);
+
+inline void fetchVertex(VertexChannelSource const (&src)[VertexLayout::NumChannels], std::size_t i,
+                        zeno::vec3f (&val)[VertexLayout::NumChannels]) {
+    for (int c = 0; c < VertexLayout::NumChannels; c++)
+        val[c] = src[c].data ? src[c].data[i] : src[c].constant;
+}
+
+// writes vertex i into the packed words
+inline void packVertex(std::uint32_t *words, std::size_t i, VertexLayout const &layout,
+                       zeno::vec3f const (&val)[VertexLayout::NumChannels]) {
+    for (int c = 0; c < VertexLayout::NumChannels; c++) {
+        if (layout.format[c] == VertexLayout::Absent)
+            continue;
+        auto *w = words + (layout.offset[c] + i * layout.channelStride(c)) / 4;
+        if (layout.format[c] == VertexLayout::Half3) {
+            w[0] = floatToHalf(val[c][0]) | ((std::uint32_t)floatToHalf(val[c][1]) << 16);
+            w[1] = floatToHalf(val[c][2]);
+        } else {
+            std::memcpy(w, &val[c], sizeof(float) * 3);
+        }
+    }
+}
+
+void hashVertexChannels(PackedVertices &vertices);
+PackedVertices packVertices(std::size_t count, VertexChannelSource const (&src)[VertexLayout::NumChannels],
+                            bool planar = false);
+
+} // namespace zenovis
@@ -9,6 +9,9 @@ struct Buffer : zeno::disable_copy {
     GLuint buf;
     GLuint target{GL_ARRAY_BUFFER};
 
+    // bytes sent through bind_data and bind_sub_data, reset by the render engine each frame
+    static inline size_t uploaded_bytes = 0;
+
     Buffer(GLuint target = GL_ARRAY_BUFFER) : target(target) {
         CHECK_GL(glGenBuffers(1, &buf));
     }
@@ -30,10 +33,12 @@ struct Buffer : zeno::disable_copy {
                    GLuint usage = GL_STATIC_DRAW) const {
         CHECK_GL(glBindBuffer(target, buf));
         CHECK_GL(glBufferData(target, size, data, usage));
+        uploaded_bytes += size;
     }
 
     void bind_sub_data(const void *data, size_t size, size_t offset) const {
         CHECK_GL(glBufferSubData(target, offset, size, data));
+        uploaded_bytes += size;
     }
 
     void attribute(GLuint index, size_t offset, size_t stride, GLuint type,
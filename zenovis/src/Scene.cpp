@@ -14,6 +14,7 @@
 #include <zenovis/opengl/scope.h>
 #include <cstdlib>
 #include <map>
+#include <utility>
 
 namespace zenovis {
 
@@ -145,7 +146,10 @@ std::vector<char> Scene::record_frame_offline(int hdrSize, int rgbComps) {
 
         {
             auto bindDrawBuf = opengl::scopeGLDrawBuffer(GL_COLOR_ATTACHMENT0);
+            // recorded frames are drawn in full detail
+            bool lodEnabled = std::exchange(drawOptions->lod.enable, false);
             draw();
+            drawOptions->lod.enable = lodEnabled;
         }
 
         if (glCheckFramebufferStatus(GL_DRAW_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE) {
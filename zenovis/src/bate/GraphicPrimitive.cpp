@@ -1,10 +1,13 @@
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <vector>
+#include <glm/glm.hpp>
 #include <zeno/types/PrimitiveObject.h>
 #include <zeno/types/InstancingObject.h>
 #include <zeno/types/PrimitiveTools.h>
 #include <zeno/types/UserData.h>
+#include <zeno/utils/envconfig.h>
 #include <zeno/utils/logger.h>
 #include <zeno/utils/orthonormal.h>
 #include <zeno/utils/ticktock.h>
@@ -13,6 +16,8 @@
 #include <zenovis/DrawOptions.h>
 #include <zenovis/Scene.h>
 #include <zenovis/bate/IGraphic.h>
+#include <zenovis/bate/LevelOfDetail.h>
+#include <zenovis/bate/VertexPacking.h>
 #include <zenovis/ShaderManager.h>
 #include <zenovis/opengl/buffer.h>
 #include <zenovis/opengl/shader.h>
@@ -28,73 +33,43 @@ struct ZhxxDrawObject {
     std::unique_ptr<Buffer> ebo;
     size_t count = 0;
     Program *prog{};
+    PackedVertices vertices;    // cpu side of vbo, words are released after upload
+    std::vector<int> elements;  // cpu side of ebo when it isn't taken from the primitive
+    std::uint64_t elementsHash = 0;
 };
 
-static void parsePointsDrawBuffer(zeno::PrimitiveObject *prim, ZhxxDrawObject &obj) {
-    auto const &pos = prim->attr<zeno::vec3f>("pos");
-    auto const &clr = prim->attr<zeno::vec3f>("clr");
-    auto const &nrm = prim->attr<zeno::vec3f>("nrm");
-    auto const &uv = prim->attr<zeno::vec3f>("uv");
-    auto const &tang = prim->attr<zeno::vec3f>("tang");
-    obj.count = prim->size();
+using VertexSources = VertexChannelSource[VertexLayout::NumChannels];
 
-    obj.vbo = std::make_unique<Buffer>(GL_ARRAY_BUFFER);
-    std::vector<zeno::vec3f> mem(obj.count * 5);
-    for (int i = 0; i < obj.count; i++) {
-        mem[5 * i + 0] = pos[i];
-        mem[5 * i + 1] = clr[i];
-        mem[5 * i + 2] = nrm[i];
-        mem[5 * i + 3] = uv[i];
-        mem[5 * i + 4] = tang[i];
-    }
-    obj.vbo->bind_data(mem.data(), mem.size() * sizeof(mem[0]));
-
-    size_t points_count = prim->points.size();
-    if (points_count) {
-        obj.ebo = std::make_unique<Buffer>(GL_ELEMENT_ARRAY_BUFFER);
-        obj.ebo->bind_data(prim->points.data(),
-                           points_count * sizeof(prim->points[0]));
-    }
-}
-
-static void parseLinesDrawBuffer(zeno::PrimitiveObject *prim, ZhxxDrawObject &obj) {
-    auto const &pos = prim->attr<zeno::vec3f>("pos");
-    auto const &clr = prim->attr<zeno::vec3f>("clr");
-    auto const &nrm = prim->attr<zeno::vec3f>("nrm");
-    auto const &tang = prim->attr<zeno::vec3f>("tang");
+static void parseLinesDrawBuffer(zeno::PrimitiveObject *prim, VertexSources const &src, ZhxxDrawObject &obj) {
     auto const &lines = prim->lines;
-    bool has_uv = lines.has_attr("uv0") && lines.has_attr("uv1");
+    auto const &uv0 = lines.attr<zeno::vec3f>("uv0");
+    auto const &uv1 = lines.attr<zeno::vec3f>("uv1");
+    VertexSources lsrc;
+    std::copy(std::begin(src), std::end(src), lsrc);
+    lsrc[VertexLayout::Uv].data = uv0.data();  // per line end, from uv0 and uv1
     obj.count = prim->lines.size();
-    obj.vbo = std::make_unique<Buffer>(GL_ARRAY_BUFFER);
-    std::vector<zeno::vec3f> mem(obj.count * 2 * 5);
-    std::vector<zeno::vec2i> linesdata(obj.count);
+    auto &vertices = obj.vertices;
+    vertices.layout = makeVertexLayout(lsrc);
+    vertices.count = obj.count * 2;
+    vertices.words.resize(vertices.count * (vertices.layout.stride / 4));
+    obj.elements.resize(obj.count * 2);
 #pragma omp parallel for
     for (int i = 0; i < obj.count; i++) {
-        mem[10 * i + 0] = pos[lines[i][0]];
-        mem[10 * i + 1] = clr[lines[i][0]];
-        mem[10 * i + 2] = nrm[lines[i][0]];
-        mem[10 * i + 3] =
-            has_uv ? lines.attr<zeno::vec3f>("uv0")[i] : zeno::vec3f(0, 0, 0);
-        mem[10 * i + 4] = tang[lines[i][0]];
-        mem[10 * i + 5] = pos[lines[i][1]];
-        mem[10 * i + 6] = clr[lines[i][1]];
-        mem[10 * i + 7] = nrm[lines[i][1]];
-        mem[10 * i + 8] =
-            has_uv ? lines.attr<zeno::vec3f>("uv1")[i] : zeno::vec3f(0, 0, 0);
-        mem[10 * i + 9] = tang[lines[i][1]];
-        linesdata[i] = zeno::vec2i(i * 2, i * 2 + 1);
-    }
-    obj.vbo->bind_data(mem.data(), mem.size() * sizeof(mem[0]));
-    if (obj.count) {
-        obj.ebo = std::make_unique<Buffer>(GL_ELEMENT_ARRAY_BUFFER);
-        obj.ebo->bind_data(&(linesdata[0]), obj.count * sizeof(linesdata[0]));
+        for (int j = 0; j < 2; j++) {
+            zeno::vec3f val[VertexLayout::NumChannels];
+            fetchVertex(src, lines[i][j], val);
+            val[VertexLayout::Uv] = j ? uv1[i] : uv0[i];
+            packVertex(vertices.words.data(), i * 2 + j, vertices.layout, val);
+            obj.elements[i * 2 + j] = i * 2 + j;
+        }
     }
+    hashVertexChannels(vertices);
+    obj.elementsHash = hashWords(reinterpret_cast<std::uint32_t const *>(obj.elements.data()), obj.elements.size());
 }
 
 static void computeTrianglesTangent(zeno::PrimitiveObject *prim) {
     const auto &tris = prim->tris;
     const auto &pos = prim->attr<zeno::vec3f>("pos");
-    auto const &nrm = prim->attr<zeno::vec3f>("nrm");
     auto &tang = prim->tris.add_attr<zeno::vec3f>("tang");
     bool has_uv =
         tris.has_attr("uv0") && tris.has_attr("uv1") && tris.has_attr("uv2");
@@ -139,143 +114,46 @@ static void computeTrianglesTangent(zeno::PrimitiveObject *prim) {
     }
 }
 
-static void parseTrianglesDrawBufferCompress(zeno::PrimitiveObject *prim, ZhxxDrawObject &obj) {
-    //TICK(parse);
-    auto const &pos = prim->attr<zeno::vec3f>("pos");
-    auto const &clr = prim->attr<zeno::vec3f>("clr");
-    auto const &nrm = prim->attr<zeno::vec3f>("nrm");
-    auto const &tris = prim->tris;
-    bool has_uv =
-        tris.has_attr("uv0") && tris.has_attr("uv1") && tris.has_attr("uv2");
-    auto &tang = prim->tris.attr<zeno::vec3f>("tang");
-    std::vector<zeno::vec3f> pos1(pos.size());
-    std::vector<zeno::vec3f> clr1(pos.size());
-    std::vector<zeno::vec3f> nrm1(pos.size());
-    std::vector<zeno::vec3f> uv1(pos.size());
-    std::vector<zeno::vec3f> tang1(pos.size());
-    std::vector<int> vertVisited(pos.size());
-    std::vector<zeno::vec3i> tris1(tris.size());
-    vertVisited.assign(pos.size(), 0);
-    for (int i = 0; i < tris.size(); i++) {
-        float area =
-            zeno::length(zeno::cross(pos[tris[i][1]] - pos[tris[i][0]],
-                                     pos[tris[i][2]] - pos[tris[i][0]]));
-        for (int j = 0; j < 3; j++) {
-            tang1[tris[i][j]] += area * tang[i];
-        }
-    }
-    /* std::cout << "1111111111111111\n"; */
-#pragma omp parallel for
-    for (int i = 0; i < tang1.size(); i++) {
-        tang1[i] = tang[i] / (zeno::length(tang[i]) + 0.000001);
-    }
-    /* std::cout << "2222222222222222\n"; */
-    std::vector<int> issueTris(0);
-    for (int i = 0; i < tris.size(); i++) {
-        //if all verts not visited
-        for (int j = 0; j < 3; j++) {
-            //just add verts id
-        }
-
-        //else
-        {
-            //if no uv confliction
-            //simply add verts id
-            //else
-            {
-                //add this tri to issueTris
-            }
-        }
-    }
-    //for issueTris
-    {
-        //emit new verts
-    }
-    /* std::cout << "3333333333333333333\n"; */
-
-    //end compressed tri assign
-    obj.count = tris1.size();
-    obj.vbo = std::make_unique<Buffer>(GL_ARRAY_BUFFER);
-    std::vector<zeno::vec3f> mem(pos1.size() * 5);
-    std::vector<zeno::vec3i> trisdata(obj.count);
-#pragma omp parallel for
-    for (int i = 0; i < pos1.size(); i++) {
-        mem[5 * i + 0] = pos1[i];
-        mem[5 * i + 1] = clr1[i];
-        mem[5 * i + 2] = nrm1[i];
-        mem[5 * i + 3] = uv1[i];
-        mem[5 * i + 4] = tang1[i];
-    }
-#pragma omp parallel for
-    for (int i = 0; i < tris1.size(); i++) {
-        trisdata[i] = tris1[i];
-    }
-
-    /* TICK(bindvbo); */
-    obj.vbo->bind_data(mem.data(), mem.size() * sizeof(mem[0]));
-    /* TOCK(bindvbo); */
-    /* TICK(bindebo); */
-    if (obj.count) {
-        obj.ebo = std::make_unique<Buffer>(GL_ELEMENT_ARRAY_BUFFER);
-        obj.ebo->bind_data(&(trisdata[0]), tris1.size() * sizeof(trisdata[0]));
-    }
-    /* TOCK(bindebo); */
-}
-
-static void parseTrianglesDrawBuffer(zeno::PrimitiveObject *prim, ZhxxDrawObject &obj) {
+static void parseTrianglesDrawBuffer(zeno::PrimitiveObject *prim, VertexSources const &src, ZhxxDrawObject &obj) {
     /* TICK(parse); */
-    auto const &pos = prim->attr<zeno::vec3f>("pos");
-    auto const &clr = prim->attr<zeno::vec3f>("clr");
-    auto const &nrm = prim->attr<zeno::vec3f>("nrm");
     auto const &tris = prim->tris;
-    bool has_uv =
-        tris.has_attr("uv0") && tris.has_attr("uv1") && tris.has_attr("uv2");
+    auto const &uv0 = tris.attr<zeno::vec3f>("uv0");
+    auto const &uv1 = tris.attr<zeno::vec3f>("uv1");
+    auto const &uv2 = tris.attr<zeno::vec3f>("uv2");
+    auto const &tang = tris.attr<zeno::vec3f>("tang");
+    VertexSources tsrc;
+    std::copy(std::begin(src), std::end(src), tsrc);
+    tsrc[VertexLayout::Uv].data = uv0.data();  // per corner, from uv0, uv1 and uv2
+    tsrc[VertexLayout::Tang].data = tang.data();  // per face
     obj.count = tris.size();
-    obj.vbo = std::make_unique<Buffer>(GL_ARRAY_BUFFER);
-    std::vector<zeno::vec3f> mem(obj.count * 3 * 5);
-    std::vector<zeno::vec3i> trisdata(obj.count);
-    auto &tang = prim->tris.attr<zeno::vec3f>("tang");
+    auto &vertices = obj.vertices;
+    vertices.layout = makeVertexLayout(tsrc);
+    vertices.count = obj.count * 3;
+    vertices.words.resize(vertices.count * (vertices.layout.stride / 4));
+    obj.elements.resize(obj.count * 3);
 #pragma omp parallel for
     for (int i = 0; i < obj.count; i++) {
-        mem[15 * i + 0] = pos[tris[i][0]];
-        mem[15 * i + 1] = clr[tris[i][0]];
-        mem[15 * i + 2] = nrm[tris[i][0]];
-        mem[15 * i + 3] = has_uv ? tris.attr<zeno::vec3f>("uv0")[i]
-                                 : zeno::vec3f(0.0f, 0.0f, 0.0f);
-        mem[15 * i + 4] = tang[i];
-        mem[15 * i + 5] = pos[tris[i][1]];
-        mem[15 * i + 6] = clr[tris[i][1]];
-        mem[15 * i + 7] = nrm[tris[i][1]];
-        mem[15 * i + 8] = has_uv ? tris.attr<zeno::vec3f>("uv1")[i]
-                                 : zeno::vec3f(0.0f, 0.0f, 0.0f);
-        mem[15 * i + 9] = tang[i];
-        mem[15 * i + 10] = pos[tris[i][2]];
-        mem[15 * i + 11] = clr[tris[i][2]];
-        mem[15 * i + 12] = nrm[tris[i][2]];
-        mem[15 * i + 13] = has_uv ? tris.attr<zeno::vec3f>("uv2")[i]
-                                  : zeno::vec3f(0.0f, 0.0f, 0.0f);
-        mem[15 * i + 14] = tang[i];
-        //std::cout<<tang[i][0]<<" "<<tang[i][1]<<" "<<tang[i][2]<<std::endl;
-        trisdata[i] = zeno::vec3i(i * 3, i * 3 + 1, i * 3 + 2);
+        for (int j = 0; j < 3; j++) {
+            zeno::vec3f val[VertexLayout::NumChannels];
+            fetchVertex(src, tris[i][j], val);
+            val[VertexLayout::Uv] = j == 0 ? uv0[i] : j == 1 ? uv1[i] : uv2[i];
+            val[VertexLayout::Tang] = tang[i];
+            packVertex(vertices.words.data(), i * 3 + j, vertices.layout, val);
+            obj.elements[i * 3 + j] = i * 3 + j;
+        }
     }
+    hashVertexChannels(vertices);
+    obj.elementsHash = hashWords(reinterpret_cast<std::uint32_t const *>(obj.elements.data()), obj.elements.size());
     /* TOCK(parse); */
-
-    /* TICK(bindvbo); */
-    obj.vbo->bind_data(mem.data(), mem.size() * sizeof(mem[0]));
-    /* TOCK(bindvbo); */
-    /* TICK(bindebo); */
-    if (obj.count) {
-        obj.ebo = std::make_unique<Buffer>(GL_ELEMENT_ARRAY_BUFFER);
-        obj.ebo->bind_data(&(trisdata[0]), obj.count * sizeof(trisdata[0]));
-    }
-    /* TOCK(bindebo); */
 }
 
 struct ZhxxGraphicPrimitive final : IGraphicDraw {
     Scene *scene;
     std::unique_ptr<Buffer> vbo;
+    PackedVertices vertices;
     size_t vertex_count;
     bool draw_all_points;
+    bool uploaded = false;
 
     //Program *points_prog;
     //std::unique_ptr<Buffer> points_ebo;
@@ -292,13 +170,35 @@ struct ZhxxGraphicPrimitive final : IGraphicDraw {
     ZhxxDrawObject pointObj;
     ZhxxDrawObject lineObj;
     ZhxxDrawObject triObj;
+
+    // gl objects taken over from the graphic of the previous frame, see recycle()
+    struct {
+        std::unique_ptr<Buffer> vbo;
+        PackedVertices vertices;
+        ZhxxDrawObject pointObj;
+        ZhxxDrawObject lineObj;
+        ZhxxDrawObject triObj;
+    } recycled;
+
+    // level of detail for huge objects, built by the lod worker on first draw
+    // unless recycle() took it over, the full object is drawn until it's ready
+    bool lodPoints = false, lodTris = false;
+    bool lodReady = false;
+    std::shared_ptr<LodJob> lodJob;
+    zeno::vec3f lodMin{0}, lodMax{0};
+    std::unique_ptr<Buffer> lodPointEbo;
+    std::vector<std::unique_ptr<Buffer>> lodTriEbos;
+    std::vector<size_t> lodTriCounts;
+
     std::vector<std::unique_ptr<Texture>> textures;
-    std::unique_ptr<zeno::PrimitiveObject> primUnique;
+    std::shared_ptr<zeno::PrimitiveObject> primShared;  // shared with the lod worker
     zeno::PrimitiveObject *prim;
 
+    // only prepares and packs the vertex data on cpu, the gl objects are
+    // created by upload() on first draw, so this may run off the gl thread
     explicit ZhxxGraphicPrimitive(Scene *scene_, zeno::PrimitiveObject *primArg)
-        : scene(scene_), primUnique(std::make_unique<zeno::PrimitiveObject>(*primArg)) {
-        prim = primUnique.get();
+        : scene(scene_), primShared(std::make_shared<zeno::PrimitiveObject>(*primArg)) {
+        prim = primShared.get();
         zeno::log_trace("rendering primitive size {}", prim->size());
 
         if (!prim->attr_is<zeno::vec3f>("pos")) {
@@ -307,19 +207,6 @@ struct ZhxxGraphicPrimitive final : IGraphicDraw {
                 pos[i] = zeno::vec3f(i * (1.0f / (pos.size() - 1)), 0, 0);
             }
         }
-        if (!prim->attr_is<zeno::vec3f>("clr")) {
-            auto &clr = prim->add_attr<zeno::vec3f>("clr");
-            zeno::vec3f clr0(1.0f);
-            if (!prim->tris.size() && !prim->quads.size() && !prim->polys.size()) {
-                if (prim->lines.size())
-                    clr0 = {1.0f, 0.6f, 0.2f};
-                else
-                    clr0 = {0.2f, 0.6f, 1.0f};
-            }
-            for (size_t i = 0; i < clr.size(); i++) {
-                clr[i] = clr0;
-            }
-        }
 #if 1
         bool primNormalCorrect =
             prim->attr_is<zeno::vec3f>("nrm") &&
@@ -341,117 +228,71 @@ struct ZhxxGraphicPrimitive final : IGraphicDraw {
 #else
         zeno::primSepTriangles(&*prim, true, true);//TODO: rm keepTriFaces
 #endif
-        /* BEGIN TODO */
-        //if (!prim->has_attr("nrm")) {
-        if (!thePrmHasFaces) {
-            if (prim->attr_is<float>("rad")) {
-                if (prim->attr_is<float>("opa")) {
-                    auto &rad = prim->attr<float>("rad");
-                    auto &opa = prim->attr<float>("opa");
-                    auto &radopa = prim->add_attr<zeno::vec3f>("nrm");
-                    for (size_t i = 0; i < radopa.size(); i++) {
-                        radopa[i] = zeno::vec3f(rad[i], opa[i], 0.0f);
-                    }
-                } else {
-                    auto &rad = prim->attr<float>("rad");
-                    auto &radopa = prim->add_attr<zeno::vec3f>("nrm");
-                    for (size_t i = 0; i < radopa.size(); i++) {
-                        radopa[i] = zeno::vec3f(rad[i], 0.0f, 0.0f);
-                    }
-                }
-            } else {
-                if (prim->attr_is<float>("opa")) {
-                    auto &opa = prim->attr<float>("opa");
-                    auto &radopa = prim->add_attr<zeno::vec3f>("nrm");
-                    for (size_t i = 0; i < radopa.size(); i++) {
-                        radopa[i] = zeno::vec3f(1.0f, opa[i], 0.0f);
-                    }
-                } else {
-                    auto &radopa = prim->add_attr<zeno::vec3f>("nrm");
-                    for (size_t i = 0; i < radopa.size(); i++) {
-                        radopa[i] = zeno::vec3f(1.0f, 0.0f, 0.0f);
-                    }
-                }
-            }
+        // attributes the primitive lacks are not filled in, they are drawn
+        // from a constant vertex attribute instead of taking space in the vbo
+        bool half = zeno::envconfig::getBool("HALF_VERTEX_ATTRS");
+        VertexSources src;
+        src[VertexLayout::Pos].data = prim->attr<zeno::vec3f>("pos").data();
+
+        src[VertexLayout::Clr].half = half;
+        if (prim->attr_is<zeno::vec3f>("clr")) {
+            src[VertexLayout::Clr].data = prim->attr<zeno::vec3f>("clr").data();
         } else {
-        }
-            //} else if (prim->tris.size()) {
-                //// for (size_t i = 0; i < radopa.size(); i++) {
-                ////     radopa[i] = zeno::vec3f(1 / zeno::sqrt(3.0f));
-                //// }
-                //for (size_t i = 0; i < radopa.size(); i++) {
-                    //radopa[i] = zeno::vec3f(0.0f);
-                //}
-
-            //} else {
-                //for (size_t i = 0; i < radopa.size(); i++) {
-                    //radopa[i] = zeno::vec3f(1.5f, 0.0f, 0.0f);
-                //}
-            //}
-        //}
-        /* END TODO */
-        if (!prim->attr_is<zeno::vec3f>("nrm")) {
-            auto &nrm = prim->add_attr<zeno::vec3f>("nrm");
-            for (size_t i = 0; i < nrm.size(); i++) {
-                nrm[i] = zeno::vec3f(1.0f, 0.0f, 0.0f);
-            }
-        }
-        if (!prim->attr_is<zeno::vec3f>("uv")) {
-            auto &uv = prim->add_attr<zeno::vec3f>("uv");
-            for (size_t i = 0; i < uv.size(); i++) {
-                uv[i] = zeno::vec3f(0.0f);
+            zeno::vec3f clr0(1.0f);
+            if (!thePrmHasFaces) {
+                if (prim->lines.size())
+                    clr0 = {1.0f, 0.6f, 0.2f};
+                else
+                    clr0 = {0.2f, 0.6f, 1.0f};
             }
+            src[VertexLayout::Clr].constant = clr0;
         }
-        if (!prim->attr_is<zeno::vec3f>("tang")) {
-            auto &tang = prim->add_attr<zeno::vec3f>("tang");
-            for (size_t i = 0; i < tang.size(); i++) {
-                tang[i] = zeno::vec3f(0.0f);
+
+        // for points and lines the normal slot carries radius and opacity
+        src[VertexLayout::Nrm].half = half;
+        src[VertexLayout::Nrm].constant = zeno::vec3f(1.0f, 0.0f, 0.0f);
+        if (!thePrmHasFaces) {
+            bool has_rad = prim->attr_is<float>("rad");
+            bool has_opa = prim->attr_is<float>("opa");
+            if (has_rad || has_opa) {
+                auto const *rad = has_rad ? prim->attr<float>("rad").data() : nullptr;
+                auto const *opa = has_opa ? prim->attr<float>("opa").data() : nullptr;
+                auto &radopa = prim->add_attr<zeno::vec3f>("nrm");
+#pragma omp parallel for
+                for (intptr_t i = 0; i < (intptr_t)radopa.size(); i++) {
+                    radopa[i] = zeno::vec3f(rad ? rad[i] : 1.0f, opa ? opa[i] : 0.0f, 0.0f);
+                }
+                src[VertexLayout::Nrm].data = radopa.data();
             }
+        } else if (prim->attr_is<zeno::vec3f>("nrm")) {
+            src[VertexLayout::Nrm].data = prim->attr<zeno::vec3f>("nrm").data();
         }
-        bool enable_uv = false;
 
-        auto const &pos = prim->attr<zeno::vec3f>("pos");
-        auto const &clr = prim->attr<zeno::vec3f>("clr");
-        auto const &nrm = prim->attr<zeno::vec3f>("nrm");
-        auto const &uv = prim->attr<zeno::vec3f>("uv");
-        auto const &tang = prim->attr<zeno::vec3f>("tang");
-        vertex_count = prim->size();
+        if (prim->attr_is<zeno::vec3f>("uv"))
+            src[VertexLayout::Uv].data = prim->attr<zeno::vec3f>("uv").data();
+        src[VertexLayout::Tang].half = half;
+        if (prim->attr_is<zeno::vec3f>("tang"))
+            src[VertexLayout::Tang].data = prim->attr<zeno::vec3f>("tang").data();
 
-        vbo = std::make_unique<Buffer>(GL_ARRAY_BUFFER);
-        std::vector<zeno::vec3f> mem(vertex_count * 5);
-        for (int i = 0; i < vertex_count; i++) {
-            mem[5 * i + 0] = pos[i];
-            mem[5 * i + 1] = clr[i];
-            mem[5 * i + 2] = nrm[i];
-            mem[5 * i + 3] = uv[i];
-            mem[5 * i + 4] = tang[i];
-        }
-        vbo->bind_data(mem.data(), mem.size() * sizeof(mem[0]));
+        vertex_count = prim->size();
+        vertices = packVertices(vertex_count, src, /*planar=*/true);
 
         points_count = prim->points.size();
         if (points_count) {
             pointObj.count = points_count;
-            pointObj.ebo = std::make_unique<Buffer>(GL_ELEMENT_ARRAY_BUFFER);
-            pointObj.ebo->bind_data(prim->points.data(),
-                                    points_count * sizeof(prim->points[0]));
-            pointObj.prog = get_points_program();
+            pointObj.elementsHash = hashWords(reinterpret_cast<std::uint32_t const *>(prim->points.data()),
+                                              points_count);
         }
 
         lines_count = prim->lines.size();
         if (lines_count) {
-            // lines_ebo = std::make_unique<Buffer>(GL_ELEMENT_ARRAY_BUFFER);
-            // lines_ebo->bind_data(prim->lines.data(), lines_count * sizeof(prim->lines[0]));
-            // lines_prog = get_lines_program();
             if (!(prim->lines.has_attr("uv0") && prim->lines.has_attr("uv1"))) {
                 lineObj.count = lines_count;
-                lineObj.ebo = std::make_unique<Buffer>(GL_ELEMENT_ARRAY_BUFFER);
-                lineObj.ebo->bind_data(prim->lines.data(),
-                                       lines_count * sizeof(prim->lines[0]));
-                lineObj.vbo = nullptr;
+                lineObj.elementsHash = hashWords(reinterpret_cast<std::uint32_t const *>(prim->lines.data()),
+                                                 lines_count * 2);
             } else {
-                parseLinesDrawBuffer(&*prim, lineObj);
+                parseLinesDrawBuffer(&*prim, src, lineObj);
             }
-            lineObj.prog = get_lines_program();
         }
 
         tris_count = prim->tris.size();
@@ -459,53 +300,199 @@ struct ZhxxGraphicPrimitive final : IGraphicDraw {
             if (!(prim->tris.has_attr("uv0") && prim->tris.has_attr("uv1") &&
                   prim->tris.has_attr("uv2"))) {
                 triObj.count = tris_count;
-                triObj.ebo = std::make_unique<Buffer>(GL_ELEMENT_ARRAY_BUFFER);
-                triObj.ebo->bind_data(prim->tris.data(),
-                                      tris_count * sizeof(prim->tris[0]));
-                triObj.vbo = nullptr;
+                triObj.elementsHash = hashWords(reinterpret_cast<std::uint32_t const *>(prim->tris.data()),
+                                                tris_count * 3);
             } else {
                 computeTrianglesTangent(&*prim);
-                parseTrianglesDrawBuffer(&*prim, triObj);
+                parseTrianglesDrawBuffer(&*prim, src, triObj);
             }
+        }
+
+        draw_all_points = !points_count && !lines_count && !tris_count;
+
+        // the uv-expanded triangles have their own vbo, those are drawn in full
+        auto const &lodctl = scene->drawOptions->lod;
+        lodPoints = lodctl.enable && draw_all_points && vertex_count >= lodctl.min_prims;
+        lodTris = lodctl.enable && tris_count >= lodctl.min_prims && !triObj.vertices.count;
+    }
 
-            bool findCamera = false;
+    ~ZhxxGraphicPrimitive() {
+        if (lodJob)
+            lodJob->cancelled = true;
+    }
+
+    void pollLod() {
+        if (lodReady || !(lodPoints || lodTris))
+            return;
+        if (!lodJob)
+            lodJob = submitLodJob(primShared, lodPoints, lodTris);
+        int state = lodJob->state;
+        if (state == LodJob::Dropped)  // pushed out of the queue, ask again next frame
+            lodJob = nullptr;
+        if (state != LodJob::Done)
+            return;
+        auto lod = std::move(lodJob->result);
+        lodJob = nullptr;
+        lodReady = true;
+        lodMin = lod.bmin;
+        lodMax = lod.bmax;
+        if (!lod.pointOrder.empty()) {
+            lodPointEbo = std::make_unique<Buffer>(GL_ELEMENT_ARRAY_BUFFER);
+            lodPointEbo->bind_data(lod.pointOrder);
+        }
+        for (auto const &level : lod.triLevels) {
+            lodTriEbos.push_back(std::make_unique<Buffer>(GL_ELEMENT_ARRAY_BUFFER));
+            lodTriEbos.back()->bind_data(level);
+            lodTriCounts.push_back(level.size());
+        }
+    }
+
+    // pixels covered by the bounding sphere of the object
+    float lodScreenPixels() const {
+        auto const &cam = *scene->camera;
+        glm::vec3 bmin(lodMin[0], lodMin[1], lodMin[2]), bmax(lodMax[0], lodMax[1], lodMax[2]);
+        float radius = glm::length(bmax - bmin) * 0.5f;
+        float dist = -(cam.m_view * glm::vec4((bmin + bmax) * 0.5f, 1.0f)).z;
+        float viewport = (float)cam.m_nx * cam.m_ny;
+        float r = radius * cam.m_proj[1][1] * cam.m_ny * 0.5f;
+        if (cam.m_proj[2][3] != 0) {  // perspective
+            if (dist <= radius)
+                return viewport;
+            r /= dist;
+        }
+        return std::min(3.1415926f * r * r, viewport);
+    }
+
+    void recycle(IGraphic &prevBase) override {
+        auto prev = dynamic_cast<ZhxxGraphicPrimitive *>(&prevBase);
+        if (!prev)
+            return;
+        // the lod only depends on the positions and triangles, so while those are
+        // the same it is taken over, ready or still being built
+        if ((lodPoints || lodTris) && lodPoints == prev->lodPoints && lodTris == prev->lodTris &&
+            vertex_count == prev->vertex_count &&
+            vertices.hash[VertexLayout::Pos] == prev->vertices.hash[VertexLayout::Pos] &&
+            (!lodTris || triObj.elementsHash == prev->triObj.elementsHash)) {
+            lodReady = prev->lodReady;
+            lodJob = std::move(prev->lodJob);
+            lodMin = prev->lodMin;
+            lodMax = prev->lodMax;
+            lodPointEbo = std::move(prev->lodPointEbo);
+            lodTriEbos = std::move(prev->lodTriEbos);
+            lodTriCounts = std::move(prev->lodTriCounts);
+        }
+        if (!prev->uploaded) {  // never drawn, pass on what it took over itself
+            recycled = std::move(prev->recycled);
+            return;
+        }
+        recycled.vbo = std::move(prev->vbo);
+        recycled.vertices = std::move(prev->vertices);
+        recycled.pointObj = std::move(prev->pointObj);
+        recycled.lineObj = std::move(prev->lineObj);
+        recycled.triObj = std::move(prev->triObj);
+    }
+
+    // sends the vertices to a new vbo, or, when the recycled one has the same
+    // storage, overwrites only the channels whose content changed
+    static void uploadVertices(std::unique_ptr<Buffer> &vbo, PackedVertices &vertices,
+                               std::unique_ptr<Buffer> &prevVbo, PackedVertices const &prev) {
+        auto const &layout = vertices.layout;
+        if (prevVbo && prev.count == vertices.count && prev.layout.sameStorage(layout)) {
+            vbo = std::move(prevVbo);
+            vbo->bind();
+            for (int c = 0; c < VertexLayout::NumChannels; c++) {
+                if (layout.format[c] == VertexLayout::Absent || prev.hash[c] == vertices.hash[c])
+                    continue;
+                if (!layout.planar) {
+                    vbo->bind_sub_data(vertices.words.data(), vertices.bytes(), 0);
+                    break;
+                }
+                vbo->bind_sub_data(vertices.words.data() + layout.offset[c] / 4,
+                                   vertices.count * VertexLayout::formatSize(layout.format[c]), layout.offset[c]);
+            }
+            vbo->unbind();
+        } else {
+            vbo = std::make_unique<Buffer>(GL_ARRAY_BUFFER);
+            vbo->bind_data(vertices.words.data(), vertices.bytes());
+        }
+        std::vector<std::uint32_t>().swap(vertices.words);
+    }
+
+    template <class T>
+    static void uploadElements(ZhxxDrawObject &obj, T const *data, size_t count, ZhxxDrawObject &prev) {
+        if (prev.ebo && prev.elementsHash == obj.elementsHash) {
+            obj.ebo = std::move(prev.ebo);
+            return;
+        }
+        obj.ebo = std::make_unique<Buffer>(GL_ELEMENT_ARRAY_BUFFER);
+        obj.ebo->bind_data(data, count * sizeof(T));
+    }
+
+    void upload() {
+        uploadVertices(vbo, vertices, recycled.vbo, recycled.vertices);
+
+        if (points_count) {
+            uploadElements(pointObj, prim->points.data(), points_count, recycled.pointObj);
+            pointObj.prog = get_points_program();
+        }
+
+        if (lines_count) {
+            if (lineObj.vertices.count) {
+                uploadVertices(lineObj.vbo, lineObj.vertices, recycled.lineObj.vbo, recycled.lineObj.vertices);
+                uploadElements(lineObj, lineObj.elements.data(), lineObj.elements.size(), recycled.lineObj);
+                std::vector<int>().swap(lineObj.elements);
+            } else {
+                uploadElements(lineObj, prim->lines.data(), lines_count, recycled.lineObj);
+            }
+            lineObj.prog = get_lines_program();
+        }
+
+        if (tris_count) {
+            if (triObj.vertices.count) {
+                uploadVertices(triObj.vbo, triObj.vertices, recycled.triObj.vbo, recycled.triObj.vertices);
+                uploadElements(triObj, triObj.elements.data(), triObj.elements.size(), recycled.triObj);
+                std::vector<int>().swap(triObj.elements);
+            } else {
+                uploadElements(triObj, prim->tris.data(), tris_count, recycled.triObj);
+            }
             triObj.prog = get_tris_program();
         }
 
-        draw_all_points = !points_count && !lines_count && !tris_count;
         if (draw_all_points) {
             pointObj.prog = get_points_program();
         }
+        recycled = {};
+        uploaded = true;
     }
 
     virtual void draw() override {
+        if (!uploaded)
+            upload();
+        pollLod();
+        auto &lodctl = scene->drawOptions->lod;
+        bool useLod = lodctl.enable && (lodPointEbo || !lodTriEbos.empty());
+        float lodPixels = useLod ? lodScreenPixels() : 0;
+
         int id = 0;
         for (id = 0; id < textures.size(); id++) {
             textures[id]->bind_to(id);
         }
 
-        auto vbobind = [&](auto &vbo) {
+        auto vbobind = [&](auto &vbo, VertexLayout const &layout) {
             vbo->bind();
-            vbo->attribute(/*index=*/0,
-                           /*offset=*/sizeof(float) * 0,
-                           /*stride=*/sizeof(float) * 15, GL_FLOAT,
-                           /*count=*/3);
-            vbo->attribute(/*index=*/1,
-                           /*offset=*/sizeof(float) * 3,
-                           /*stride=*/sizeof(float) * 15, GL_FLOAT,
-                           /*count=*/3);
-            vbo->attribute(/*index=*/2,
-                           /*offset=*/sizeof(float) * 6,
-                           /*stride=*/sizeof(float) * 15, GL_FLOAT,
-                           /*count=*/3);
-            vbo->attribute(/*index=*/3,
-                           /*offset=*/sizeof(float) * 9,
-                           /*stride=*/sizeof(float) * 15, GL_FLOAT,
-                           /*count=*/3);
-            vbo->attribute(/*index=*/4,
-                           /*offset=*/sizeof(float) * 12,
-                           /*stride=*/sizeof(float) * 15, GL_FLOAT,
-                           /*count=*/3);
+            for (int c = 0; c < VertexLayout::NumChannels; c++) {
+                if (layout.format[c] == VertexLayout::Absent) {
+                    vbo->disable_attribute(c);
+                    auto const &k = layout.constant[c];
+                    CHECK_GL(glVertexAttrib3f(c, k[0], k[1], k[2]));
+                } else {
+                    vbo->attribute(/*index=*/c,
+                                   /*offset=*/layout.offset[c],
+                                   /*stride=*/layout.channelStride(c),
+                                   layout.format[c] == VertexLayout::Half3 ? GL_HALF_FLOAT : GL_FLOAT,
+                                   /*count=*/3);
+                }
+            }
         };
         auto vbounbind = [&](auto &vbo) {
             vbo->disable_attribute(0);
@@ -517,15 +504,28 @@ struct ZhxxGraphicPrimitive final : IGraphicDraw {
         };
 
         if (draw_all_points || points_count)
-            vbobind(vbo);
+            vbobind(vbo, vertices.layout);
 
         if (draw_all_points) {
             //printf("ALLPOINTS\n");
+            size_t count = vertex_count;
+            if (useLod && lodPointEbo)
+                count = lodctl.target_count(vertex_count, lodPixels);
             pointObj.prog->use();
             float point_scale = 21.6f / std::tan(scene->camera->m_fov * 0.5f * 3.1415926f / 180.0f);
+            if (count < vertex_count)  // fewer but larger points keep the coverage
+                point_scale *= std::sqrt((float)vertex_count / count);
             pointObj.prog->set_uniform("mPointScale", point_scale);
             scene->camera->set_program_uniforms(pointObj.prog);
-            CHECK_GL(glDrawArrays(GL_POINTS, /*first=*/0, /*count=*/vertex_count));
+            if (count < vertex_count) {
+                lodPointEbo->bind();
+                CHECK_GL(glDrawElements(GL_POINTS, /*count=*/count, GL_UNSIGNED_INT, /*first=*/0));
+                lodPointEbo->unbind();
+            } else {
+                CHECK_GL(glDrawArrays(GL_POINTS, /*first=*/0, /*count=*/vertex_count));
+            }
+            lodctl.submitted_points += count;
+            lodctl.full_points += vertex_count;
         }
 
         if (points_count) {
@@ -544,9 +544,9 @@ struct ZhxxGraphicPrimitive final : IGraphicDraw {
         if (lines_count) {
             //printf("LINES\n");
             if (lineObj.vbo) {
-                vbobind(lineObj.vbo);
+                vbobind(lineObj.vbo, lineObj.vertices.layout);
             } else {
-                vbobind(vbo);
+                vbobind(vbo, vertices.layout);
             }
             lineObj.prog->use();
             scene->camera->set_program_uniforms(lineObj.prog);
@@ -564,9 +564,9 @@ struct ZhxxGraphicPrimitive final : IGraphicDraw {
         if (tris_count) {
             //printf("TRIS\n");
             if (triObj.vbo) {
-                vbobind(triObj.vbo);
+                vbobind(triObj.vbo, triObj.vertices.layout);
             } else {
-                vbobind(vbo);
+                vbobind(vbo, vertices.layout);
             }
 
             triObj.prog->use();
@@ -577,10 +577,26 @@ struct ZhxxGraphicPrimitive final : IGraphicDraw {
 
             triObj.prog->set_uniformi("mRenderWireframe", false);
 
-            triObj.ebo->bind();
+            // the finest proxy level within the target count, or the coarsest one
+            Buffer *ebo = triObj.ebo.get();
+            size_t count = triObj.count;
+            if (useLod && !lodTriEbos.empty()) {
+                size_t target = lodctl.target_count(triObj.count, lodPixels);
+                if (target < triObj.count) {
+                    size_t k = 0;
+                    while (k + 1 < lodTriCounts.size() && lodTriCounts[k] > target)
+                        k++;
+                    ebo = lodTriEbos[k].get();
+                    count = lodTriCounts[k];
+                }
+            }
+            lodctl.submitted_tris += count;
+            lodctl.full_tris += triObj.count;
+
+            ebo->bind();
 
             CHECK_GL(glDrawElements(GL_TRIANGLES,
-                                    /*count=*/triObj.count * 3,
+                                    /*count=*/count * 3,
                                     GL_UNSIGNED_INT, /*first=*/0));
             bool selected = scene->selected.count(nameid) > 0;
 
@@ -590,12 +606,12 @@ struct ZhxxGraphicPrimitive final : IGraphicDraw {
                 CHECK_GL(glPolygonMode(GL_FRONT_AND_BACK, GL_LINE));
                 triObj.prog->set_uniformi("mRenderWireframe", true);
                 CHECK_GL(glDrawElements(GL_TRIANGLES,
-                                        /*count=*/triObj.count * 3,
+                                        /*count=*/count * 3,
                                         GL_UNSIGNED_INT, /*first=*/0));
                 CHECK_GL(glPolygonMode(GL_FRONT_AND_BACK, GL_FILL));
                 CHECK_GL(glDisable(GL_POLYGON_OFFSET_LINE));
             }
-            triObj.ebo->unbind();
+            ebo->unbind();
             if (triObj.vbo) {
                 vbounbind(triObj.vbo);
             } else {
@@ -0,0 +1,265 @@
+#include <zenovis/bate/LevelOfDetail.h>
+#include <zeno/types/PrimitiveObject.h>
+#include <zeno/utils/vec.h>
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <tuple>
+
+namespace zenovis {
+
+static void boundingBox(zeno::vec3f const *pos, std::size_t n, zeno::vec3f &bmin, zeno::vec3f &bmax) {
+    bmin = zeno::vec3f(std::numeric_limits<float>::max());
+    bmax = zeno::vec3f(-std::numeric_limits<float>::max());
+#pragma omp parallel
+    {
+        auto lmin = bmin, lmax = bmax;
+#pragma omp for nowait
+        for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)n; i++) {
+            lmin = zeno::min(lmin, pos[i]);
+            lmax = zeno::max(lmax, pos[i]);
+        }
+#pragma omp critical
+        {
+            bmin = zeno::min(bmin, lmin);
+            bmax = zeno::max(bmax, lmax);
+        }
+    }
+    if (!n)
+        bmin = bmax = zeno::vec3f(0);
+}
+
+static float hashUnit(std::uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352d;
+    x ^= x >> 15;
+    x *= 0x846ca68b;
+    x ^= x >> 16;
+    return (x >> 8) * (1.0f / 16777216.0f);
+}
+
+std::vector<int> stratifiedPointOrder(zeno::vec3f const *pos, std::size_t n,
+                                      zeno::vec3f const &bmin, zeno::vec3f const &bmax) {
+    // bin the points into a grid of about 8 points per cell, then give the j-th
+    // of the m points of a cell the jittered key (j + u) / m, so that sorting by
+    // key takes from each cell in proportion to its count along the whole order
+    int g = std::clamp((int)std::cbrt(n / 8.0), 1, 256);
+    auto ext = bmax - bmin;
+    zeno::vec3f inv;
+    for (int k = 0; k < 3; k++)
+        inv[k] = ext[k] > 0 ? g / ext[k] : 0;
+
+    std::vector<int> cell(n);
+#pragma omp parallel for
+    for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)n; i++) {
+        auto c = (pos[i] - bmin) * inv;
+        int x = std::clamp((int)c[0], 0, g - 1);
+        int y = std::clamp((int)c[1], 0, g - 1);
+        int z = std::clamp((int)c[2], 0, g - 1);
+        cell[i] = (z * g + y) * g + x;
+    }
+
+    std::vector<int> start((std::size_t)g * g * g + 1);
+    for (std::size_t i = 0; i < n; i++)
+        start[cell[i] + 1]++;
+    for (std::size_t c = 1; c < start.size(); c++)
+        start[c] += start[c - 1];
+
+    constexpr int nkeys = 1 << 16;
+    std::vector<int> fill(start.begin(), start.end() - 1);
+    std::vector<std::uint16_t> key(n);
+    for (std::size_t i = 0; i < n; i++) {
+        int c = cell[i];
+        int m = start[c + 1] - start[c];
+        int j = fill[c]++ - start[c];
+        key[i] = (std::uint16_t)std::min(nkeys - 1, (int)((j + hashUnit((std::uint32_t)i)) / m * nkeys));
+    }
+
+    std::vector<std::size_t> kstart(nkeys + 1);
+    for (std::size_t i = 0; i < n; i++)
+        kstart[key[i] + 1]++;
+    for (int k = 1; k <= nkeys; k++)
+        kstart[k] += kstart[k - 1];
+    std::vector<int> order(n);
+    for (std::size_t i = 0; i < n; i++)
+        order[kstart[key[i]]++] = (int)i;
+    return order;
+}
+
+std::vector<zeno::vec3i> clusterTriangles(zeno::vec3f const *pos, std::size_t nverts,
+                                          zeno::vec3i const *tris, std::size_t ntris,
+                                          zeno::vec3f const &bmin, zeno::vec3f const &bmax, int res) {
+    auto ext = bmax - bmin;
+    float inv = res / std::max({ext[0], ext[1], ext[2], 1e-20f});
+
+    // open addressing table from grid cell to the first vertex seen in it
+    std::size_t cap = 16;
+    while (cap < 2 * std::min<std::size_t>(nverts, (std::size_t)res * res * res))
+        cap *= 2;
+    std::vector<std::uint64_t> cellKey(cap, ~std::uint64_t(0));
+    std::vector<int> cellRep(cap);
+    auto repOf = [&](int v) {
+        auto c = (pos[v] - bmin) * inv;
+        std::uint64_t x = std::clamp((int)c[0], 0, res - 1);
+        std::uint64_t y = std::clamp((int)c[1], 0, res - 1);
+        std::uint64_t z = std::clamp((int)c[2], 0, res - 1);
+        std::uint64_t k = (z << 42) | (y << 21) | x;
+        std::size_t h = (std::size_t)((k * 0x9e3779b97f4a7c15ull) >> 20) & (cap - 1);
+        while (cellKey[h] != k) {
+            if (cellKey[h] == ~std::uint64_t(0)) {
+                cellKey[h] = k;
+                cellRep[h] = v;
+                break;
+            }
+            h = (h + 1) & (cap - 1);
+        }
+        return cellRep[h];
+    };
+
+    std::vector<zeno::vec3i> out;
+    out.reserve(ntris / 2);
+    for (std::size_t i = 0; i < ntris; i++) {
+        int a = repOf(tris[i][0]), b = repOf(tris[i][1]), c = repOf(tris[i][2]);
+        if (a == b || b == c || c == a)
+            continue;
+        // rotate the smallest index first, keeping the winding, so duplicates compare equal
+        if (b < a && b < c)
+            std::tie(a, b, c) = std::make_tuple(b, c, a);
+        else if (c < a && c < b)
+            std::tie(a, b, c) = std::make_tuple(c, a, b);
+        out.emplace_back(a, b, c);
+    }
+    auto less = [](zeno::vec3i const &l, zeno::vec3i const &r) {
+        return std::tie(l[0], l[1], l[2]) < std::tie(r[0], r[1], r[2]);
+    };
+    std::sort(out.begin(), out.end(), less);
+    out.erase(std::unique(out.begin(), out.end(), [](zeno::vec3i const &l, zeno::vec3i const &r) {
+        return l[0] == r[0] && l[1] == r[1] && l[2] == r[2];
+    }), out.end());
+    return out;
+}
+
+PrimitiveLod buildPrimitiveLod(zeno::vec3f const *pos, std::size_t nverts, bool points,
+                               zeno::vec3i const *tris, std::size_t ntris,
+                               std::atomic<bool> const *cancelled) {
+    auto stop = [&] {
+        return cancelled && cancelled->load();
+    };
+    PrimitiveLod lod;
+    boundingBox(pos, nverts, lod.bmin, lod.bmax);
+    if (points && !stop())
+        lod.pointOrder = stratifiedPointOrder(pos, nverts, lod.bmin, lod.bmax);
+
+    // each level clusters the previous one on a grid four times coarser,
+    // levels that don't at least halve the count are skipped
+    std::vector<zeno::vec3i> const *prev = nullptr;
+    std::size_t count = ntris;
+    for (int res = 1024; res >= 4 && count > 1024 && !stop(); res /= 4) {
+        auto level = prev ? clusterTriangles(pos, nverts, prev->data(), prev->size(), lod.bmin, lod.bmax, res)
+                          : clusterTriangles(pos, nverts, tris, ntris, lod.bmin, lod.bmax, res);
+        if (level.size() * 2 > count)
+            continue;
+        count = level.size();
+        lod.triLevels.push_back(std::move(level));
+        prev = &lod.triLevels.back();
+    }
+    return lod;
+}
+
+namespace {
+
+// one thread builds the lods of every graphic, one job at a time, so objects
+// reloaded each frame queue up here instead of each starting a thread
+struct LodWorker {
+    static constexpr std::size_t kMaxQueued = 4;
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::deque<std::weak_ptr<LodJob>> queue;
+    std::shared_ptr<LodJob> running;
+    bool stopping = false;
+    std::thread thread;
+
+    LodWorker() : thread([this] { loop(); }) {}
+
+    ~LodWorker() {
+        {
+            std::lock_guard lck(mtx);
+            stopping = true;
+            if (running)
+                running->cancelled = true;
+        }
+        cv.notify_one();
+        thread.join();
+    }
+
+    void push(std::shared_ptr<LodJob> const &job) {
+        {
+            std::lock_guard lck(mtx);
+            queue.erase(std::remove_if(queue.begin(), queue.end(), [] (auto const &w) {
+                return w.expired();
+            }), queue.end());
+            queue.push_back(job);
+            while (queue.size() > kMaxQueued) {
+                if (auto old = queue.front().lock())
+                    old->state = LodJob::Dropped;
+                queue.pop_front();
+            }
+        }
+        cv.notify_one();
+    }
+
+    void loop() {
+        std::unique_lock lck(mtx);
+        while (true) {
+            cv.wait(lck, [this] { return stopping || !queue.empty(); });
+            if (stopping)
+                return;
+            auto job = queue.front().lock();
+            queue.pop_front();
+            if (!job)
+                continue;
+            if (job->cancelled) {
+                job->state = LodJob::Dropped;
+                continue;
+            }
+            job->state = LodJob::Running;
+            running = job;
+            lck.unlock();
+
+            auto const &prim = *job->prim;
+            auto lod = buildPrimitiveLod(prim.verts.data(), prim.verts.size(), job->points,
+                                         job->tris ? prim.tris.data() : nullptr, job->tris ? prim.tris.size() : 0,
+                                         &job->cancelled);
+            job->prim = nullptr;
+            if (job->cancelled) {
+                job->state = LodJob::Dropped;
+            } else {
+                job->result = std::move(lod);
+                job->state = LodJob::Done;
+            }
+
+            lck.lock();
+            running = nullptr;
+        }
+    }
+};
+
+}
+
+std::shared_ptr<LodJob> submitLodJob(std::shared_ptr<zeno::PrimitiveObject const> prim, bool points, bool tris) {
+    static LodWorker worker;
+    auto job = std::make_shared<LodJob>();
+    job->prim = std::move(prim);
+    job->points = points;
+    job->tris = tris;
+    worker.push(job);
+    return job;
+}
+
+} // namespace zenovis
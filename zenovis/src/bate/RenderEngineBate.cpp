@@ -6,6 +6,8 @@
 #include <zenovis/bate/IGraphic.h>
 #include <zenovis/opengl/vao.h>
 #include <zenovis/opengl/scope.h>
+#include <zenovis/opengl/buffer.h>
+#include <utility>
 
 namespace zenovis::bate {
 
@@ -15,6 +17,11 @@ struct RenderEngineBate : RenderEngine {
     std::vector<std::unique_ptr<IGraphicDraw>> hudGraphics;
     Scene *scene;
 
+    // gpu time of the last frames, feeds the level of detail budget
+    GLuint timerQueries[2]{};
+    bool timerPending[2]{};
+    int timerFrame = 0;  // picks the query of this frame
+
     auto setupState() {
         return std::tuple{
             opengl::scopeGLEnable(GL_BLEND), opengl::scopeGLEnable(GL_DEPTH_TEST),
@@ -32,6 +39,27 @@ struct RenderEngineBate : RenderEngine {
         hudGraphics.push_back(makeGraphicGrid(scene));
         hudGraphics.push_back(makeGraphicAxis(scene));
         hudGraphics.push_back(makeGraphicSelectBox(scene));
+
+        CHECK_GL(glGenQueries(2, timerQueries));
+    }
+
+    ~RenderEngineBate() override {
+        CHECK_GL(glDeleteQueries(2, timerQueries));
+    }
+
+    void pollFrameTime() {
+        for (int q = 0; q < 2; q++) {
+            if (!timerPending[q])
+                continue;
+            GLuint available = 0;
+            CHECK_GL(glGetQueryObjectuiv(timerQueries[q], GL_QUERY_RESULT_AVAILABLE, &available));
+            if (!available)
+                continue;
+            GLuint64 elapsed = 0;
+            CHECK_GL(glGetQueryObjectui64v(timerQueries[q], GL_QUERY_RESULT, &elapsed));
+            timerPending[q] = false;
+            scene->drawOptions->lod.update_budget(elapsed * 1e-6f);
+        }
     }
 
     void update() override {
@@ -45,10 +73,24 @@ struct RenderEngineBate : RenderEngine {
                               scene->drawOptions->bgcolor.b, 0.0f));
         CHECK_GL(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
 
+        pollFrameTime();
+        int cur = timerFrame % 2;
+        bool timing = !timerPending[cur];
+        if (timing)
+            CHECK_GL(glBeginQuery(GL_TIME_ELAPSED, timerQueries[cur]));
+
+        auto &lod = scene->drawOptions->lod;
+        lod.begin_frame();
         auto bindVao = opengl::scopeGLBindVertexArray(vao->vao);
         for (auto const &[key, gra] : graphicsMan->graphics.pairs<IGraphicDraw>()) {
             gra->draw();
         }
+        if (lod.submitted_points < lod.full_points || lod.submitted_tris < lod.full_tris)
+            zeno::log_debug("draw: lod submitted {}/{} points, {}/{} triangles, budget scale {}",
+                            lod.submitted_points, lod.full_points, lod.submitted_tris, lod.full_tris,
+                            lod.budget_scale);
+        if (auto bytes = std::exchange(opengl::Buffer::uploaded_bytes, 0))
+            zeno::log_debug("draw: uploaded {} bytes of buffer data", bytes);
         if (scene->drawOptions->show_grid) {
             for (auto const &hudgra : hudGraphics) {
                 hudgra->draw();
@@ -58,6 +100,12 @@ struct RenderEngineBate : RenderEngine {
             CHECK_GL(glClear(GL_DEPTH_BUFFER_BIT));
             scene->drawOptions->handler->draw();
         }
+
+        if (timing) {
+            CHECK_GL(glEndQuery(GL_TIME_ELAPSED));
+            timerPending[cur] = true;
+            timerFrame++;
+        }
     }
 };
 
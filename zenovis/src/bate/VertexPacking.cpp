@@ -0,0 +1,98 @@
+#include <zenovis/bate/VertexPacking.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace zenovis {
+
+// round to nearest even, overflow goes to infinity, nan stays nan
+std::uint16_t floatToHalf(float f) {
+    std::uint32_t x;
+    std::memcpy(&x, &f, sizeof(x));
+    std::uint32_t sign = (x >> 16) & 0x8000;
+    std::uint32_t absx = x & 0x7fffffff;
+    if (absx >= 0x47800000)  // 65536 and above, inf, nan
+        return sign | (absx > 0x7f800000 ? 0x7e00 : 0x7c00);
+    if (absx < 0x38800000) {  // below the smallest normal half, 2^-14
+        float af;
+        std::memcpy(&af, &absx, sizeof(af));
+        return sign | (std::uint16_t)std::lrint(af * 16777216.0f);
+    }
+    // rebias the exponent from 127 to 15, then round away the low 13 mantissa bits
+    return sign | ((absx - 0x38000000 + 0xfff + ((absx >> 13) & 1)) >> 13);
+}
+
+std::uint64_t hashWords(std::uint32_t const *words, std::size_t count, unsigned width, unsigned stride) {
+    // fnv-1a within chunks hashed in parallel, then the chunk hashes are folded in order
+    constexpr std::size_t chunk = 16384;
+    constexpr std::uint64_t prime = 0x100000001b3ull;
+    std::size_t nchunks = (count + chunk - 1) / chunk;
+    std::vector<std::uint64_t> partial(nchunks);
+#pragma omp parallel for
+    for (std::ptrdiff_t k = 0; k < (std::ptrdiff_t)nchunks; k++) {
+        std::uint64_t h = 0xcbf29ce484222325ull;
+        std::size_t end = std::min(count, (k + 1) * chunk);
+        for (std::size_t i = k * chunk; i < end; i++) {
+            for (unsigned j = 0; j < width; j++) {
+                h = (h ^ words[i * stride + j]) * prime;
+            }
+        }
+        partial[k] = h;
+    }
+    std::uint64_t h = (0xcbf29ce484222325ull ^ count) * prime;
+    for (auto p : partial)
+        h = (h ^ p) * prime;
+    return h;
+}
+
+VertexLayout makeVertexLayout(VertexChannelSource const (&src)[VertexLayout::NumChannels], bool planar,
+                              std::size_t count) {
+    VertexLayout layout;
+    layout.planar = planar;
+    unsigned stride = 0;
+    for (int c = 0; c < VertexLayout::NumChannels; c++) {
+        layout.constant[c] = src[c].constant;
+        if (!src[c].data) {
+            layout.format[c] = VertexLayout::Absent;
+            layout.offset[c] = 0;
+            continue;
+        }
+        layout.format[c] = src[c].half ? VertexLayout::Half3 : VertexLayout::Float3;
+        layout.offset[c] = planar ? stride * count : stride;
+        stride += VertexLayout::formatSize(layout.format[c]);
+    }
+    layout.stride = stride;
+    return layout;
+}
+
+void hashVertexChannels(PackedVertices &vertices) {
+    auto const &layout = vertices.layout;
+    for (int c = 0; c < VertexLayout::NumChannels; c++) {
+        if (layout.format[c] == VertexLayout::Absent) {
+            vertices.hash[c] = 0;
+            continue;
+        }
+        vertices.hash[c] = hashWords(vertices.words.data() + layout.offset[c] / 4, vertices.count,
+                                     VertexLayout::formatSize(layout.format[c]) / 4, layout.channelStride(c) / 4);
+    }
+}
+
+PackedVertices packVertices(std::size_t count, VertexChannelSource const (&src)[VertexLayout::NumChannels],
+                            bool planar) {
+    PackedVertices out;
+    out.layout = makeVertexLayout(src, planar, count);
+    out.count = count;
+    auto const &layout = out.layout;
+    out.words.resize(count * (layout.stride / 4));
+    auto *words = out.words.data();
+#pragma omp parallel for
+    for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)count; i++) {
+        zeno::vec3f val[VertexLayout::NumChannels];
+        fetchVertex(src, i, val);
+        packVertex(words, i, layout, val);
+    }
+    hashVertexChannels(out);
+    return out;
+}
+
+} // namespace zenovis